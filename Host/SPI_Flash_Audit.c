@@ -0,0 +1,381 @@
+/*
+ * Bus budget audit of SPI_Flash_Manager on the emulated chip.
+ *
+ *   make -C Host audit && Host/build/flashman_audit [-v]
+ *
+ *   -v           list the CS frames of every case, not only of the failing ones
+ *
+ * With CONFIG="-DFLASHMAN_PLATFORM=FLASHMAN_PLATFORM_LINUX_SPIDEV" the driver runs on the spidev stand-in
+ * (Host/SPI_Flash_Spidev.c) and the SPI_IOC_MESSAGE calls per case are checked as well.
+ *
+ * Each case runs one public API call and counts what reached the chip: CS frames, bytes clocked
+ * and status register polls. The counts are checked against the budgets in AUDIT_Cases[], so an
+ * extra WriteDisable, a split transfer or a poll loop gone too fast fails here long before it
+ * shows up as a slower benchmark. Exit status is 1 if any case goes over its budget.
+ *
+ * Budgets are the counts of the default configuration at 21 MHz. Builds that save frames (e.g.
+ * FLASHMAN_WRITEBACK_ENABLE) stay within them. When a change makes the driver cheaper, lower the
+ * budget in the same commit.
+ */
+
+#include "SPI_Flash_Emulator.h"
+#include "SPI_Flash_Manager_Counter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AUDIT_GPIO_PIN                            (1 << 0)
+#define AUDIT_BASE                                (1024 * 1024)
+#define AUDIT_COUNTER                             (AUDIT_BASE + 2 * FLASHMAN_BLOCK_SIZE)
+#define AUDIT_LOG                                 4096
+#define AUDIT_SPIDEV                              "/dev/spidev0.0"
+
+typedef struct
+{
+  SPI_HandleTypeDef      Spi;
+  GPIO_TypeDef           Gpio;
+  FLASHEMU_DeviceTypeDef Device;
+  FLASHMAN_HandleTypeDef Handle;
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+  FLASHMAN_SpidevTypeDef Bus;
+#endif
+  uint8_t                Buffer[FLASHMAN_BLOCK_SIZE];
+  uint8_t                Data[FLASHMAN_BLOCK_SIZE];
+  FLASHMAN_DescriptorTypeDef Descriptor;
+  FLASHMAN_CounterTypeDef Counter;
+  FLASHEMU_FrameTypeDef  Log[AUDIT_LOG];
+
+} AUDIT_TypeDef;
+
+typedef struct
+{
+  const char             *Name;
+  bool                   (*Prepare)(AUDIT_TypeDef *Audit);    /* not counted, can be NULL */
+  bool                   (*Run)(AUDIT_TypeDef *Audit);
+  uint32_t               Frames;
+  uint32_t               Bytes;
+  uint32_t               Polls;
+  uint32_t               Messages;         /* spidev builds only */
+
+} AUDIT_CaseTypeDef;
+
+static bool AUDIT_Erase(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_EraseBlock(&Audit->Handle, FLASHMAN_AddressToBlock(AUDIT_BASE));
+}
+
+static bool AUDIT_Program(AUDIT_TypeDef *Audit)
+{
+  return AUDIT_Erase(Audit) && FLASHMAN_WriteAddress(&Audit->Handle, AUDIT_BASE, Audit->Data, FLASHMAN_SECTOR_SIZE);
+}
+
+static bool AUDIT_EraseSectorAsync(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_EraseSectorAsync(&Audit->Handle, FLASHMAN_AddressToSector(AUDIT_BASE));
+}
+
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_DISABLE
+/* calibration builds probe the bus in init, so init has no budget there */
+static bool AUDIT_Uninit(AUDIT_TypeDef *Audit)
+{
+  Audit->Handle.Inited = 0;
+  return true;
+}
+#endif
+
+static bool AUDIT_Init(AUDIT_TypeDef *Audit)
+{
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+  return FLASHMAN_Init(&Audit->Handle, &Audit->Bus, NULL, 0);
+#else
+  return FLASHMAN_Init(&Audit->Handle, &Audit->Spi, &Audit->Gpio, AUDIT_GPIO_PIN);
+#endif
+}
+
+static bool AUDIT_Describe(AUDIT_TypeDef *Audit)
+{
+  bool retVal = FLASHMAN_GetDescriptor(&Audit->Handle, &Audit->Descriptor);
+  Audit->Handle.Inited = 0;
+  return retVal;
+}
+
+static bool AUDIT_InitWarm(AUDIT_TypeDef *Audit)
+{
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+  return FLASHMAN_InitWarm(&Audit->Handle, &Audit->Bus, NULL, 0, &Audit->Descriptor);
+#else
+  return FLASHMAN_InitWarm(&Audit->Handle, &Audit->Spi, &Audit->Gpio, AUDIT_GPIO_PIN, &Audit->Descriptor);
+#endif
+}
+
+static bool AUDIT_ReadAddress16(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_ReadAddress(&Audit->Handle, AUDIT_BASE + 100, Audit->Buffer, 16);
+}
+
+static bool AUDIT_ReadAddress4096(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_ReadAddress(&Audit->Handle, AUDIT_BASE + 100, Audit->Buffer, 4096);
+}
+
+static bool AUDIT_ReadPage(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_ReadPage(&Audit->Handle, FLASHMAN_AddressToPage(AUDIT_BASE), Audit->Buffer, FLASHMAN_PAGE_SIZE, 0);
+}
+
+static bool AUDIT_ReadSector(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_ReadSector(&Audit->Handle, FLASHMAN_AddressToSector(AUDIT_BASE), Audit->Buffer, FLASHMAN_SECTOR_SIZE, 0);
+}
+
+static bool AUDIT_ReadBlock(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_ReadBlock(&Audit->Handle, FLASHMAN_AddressToBlock(AUDIT_BASE), Audit->Buffer, FLASHMAN_BLOCK_SIZE, 0);
+}
+
+static bool AUDIT_Compare(AUDIT_TypeDef *Audit)
+{
+  uint32_t mismatch;
+  return FLASHMAN_Compare(&Audit->Handle, AUDIT_BASE, Audit->Data, FLASHMAN_SECTOR_SIZE, &mismatch) &&
+         (mismatch == FLASHMAN_SECTOR_SIZE);
+}
+
+static bool AUDIT_Checksum(AUDIT_TypeDef *Audit)
+{
+  uint8_t digest[FLASHMAN_SHA256_SIZE];
+  return FLASHMAN_Checksum(&Audit->Handle, AUDIT_BASE, FLASHMAN_SECTOR_SIZE, FLASHMAN_CHECKSUM_CRC32, digest);
+}
+
+static bool AUDIT_WritePage(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_WritePage(&Audit->Handle, FLASHMAN_AddressToPage(AUDIT_BASE), Audit->Data, FLASHMAN_PAGE_SIZE, 0);
+}
+
+static bool AUDIT_WriteAddress(AUDIT_TypeDef *Audit)
+{
+  /* 5 pages, partial ones at both ends */
+  return FLASHMAN_WriteAddress(&Audit->Handle, AUDIT_BASE + 100, Audit->Data, 1000);
+}
+
+static bool AUDIT_WriteAddressAsync(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_WriteAddressAsync(&Audit->Handle, AUDIT_BASE, Audit->Data, FLASHMAN_PAGE_SIZE);
+}
+
+static bool AUDIT_WriteAddressVerified(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_WriteAddressVerified(&Audit->Handle, AUDIT_BASE, Audit->Data, FLASHMAN_SECTOR_SIZE, NULL);
+}
+
+static bool AUDIT_WriteSector(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_WriteSector(&Audit->Handle, FLASHMAN_AddressToSector(AUDIT_BASE), Audit->Data, FLASHMAN_SECTOR_SIZE, 0);
+}
+
+static bool AUDIT_WriteBlock(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_WriteBlock(&Audit->Handle, FLASHMAN_AddressToBlock(AUDIT_BASE), Audit->Data, FLASHMAN_BLOCK_SIZE, 0);
+}
+
+static bool AUDIT_Copy(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_Copy(&Audit->Handle, AUDIT_BASE, &Audit->Handle, AUDIT_BASE + FLASHMAN_SECTOR_SIZE, FLASHMAN_SECTOR_SIZE, NULL);
+}
+
+static bool AUDIT_WriteImage(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_WriteImage(&Audit->Handle, AUDIT_BASE, Audit->Data, FLASHMAN_SECTOR_SIZE, NULL);
+}
+
+static bool AUDIT_EraseSector(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_EraseSector(&Audit->Handle, FLASHMAN_AddressToSector(AUDIT_BASE));
+}
+
+static bool AUDIT_EraseBlock(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_EraseBlock(&Audit->Handle, FLASHMAN_AddressToBlock(AUDIT_BASE));
+}
+
+static bool AUDIT_EraseBlockAsync(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_EraseBlockAsync(&Audit->Handle, FLASHMAN_AddressToBlock(AUDIT_BASE));
+}
+
+static bool AUDIT_CounterOpen(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_CounterOpen(&Audit->Counter, &Audit->Handle, FLASHMAN_AddressToSector(AUDIT_COUNTER));
+}
+
+static bool AUDIT_CounterIncrement(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_CounterIncrement(&Audit->Counter);
+}
+
+static bool AUDIT_EraseChip(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_EraseChip(&Audit->Handle);
+}
+
+static bool AUDIT_IsBusy(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_IsBusy(&Audit->Handle);
+}
+
+static bool AUDIT_Sync(AUDIT_TypeDef *Audit)
+{
+  return FLASHMAN_Sync(&Audit->Handle);
+}
+
+static bool AUDIT_Idle(AUDIT_TypeDef *Audit)
+{
+  return (FLASHMAN_IsBusy(&Audit->Handle) == false) && (FLASHMAN_IsBusy(&Audit->Handle) == false);
+}
+
+static const AUDIT_CaseTypeDef AUDIT_Cases[] =
+{
+  /* name                      prepare             run                         frames   bytes   polls   msgs */
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_DISABLE
+  {"init",                     AUDIT_Uninit,       AUDIT_Init,                        2,      5,      0,     2},
+#endif
+  {"init_warm",                AUDIT_Describe,     AUDIT_InitWarm,                    1,      4,      0,     1},
+  {"read_address_16",          AUDIT_Program,      AUDIT_ReadAddress16,               1,     20,      0,     1},
+  {"read_address_4096",        NULL,               AUDIT_ReadAddress4096,             1,   4100,      0,     2},
+  {"read_page",                NULL,               AUDIT_ReadPage,                    1,    260,      0,     1},
+  {"read_sector",              NULL,               AUDIT_ReadSector,                  1,   4100,      0,     2},
+  {"read_block",               NULL,               AUDIT_ReadBlock,                   1,  65540,      0,    17},
+  {"compare_4096",             NULL,               AUDIT_Compare,                     1,   4100,      0,     2},
+  {"checksum_crc32_4096",      NULL,               AUDIT_Checksum,                    1,   4100,      0,     2},
+  {"write_page",               AUDIT_Erase,        AUDIT_WritePage,                   4,    265,      2,     3},
+  {"write_address_1000",       AUDIT_Erase,        AUDIT_WriteAddress,               20,   1045,     10,    15},
+  {"write_address_async",      AUDIT_Erase,        AUDIT_WriteAddressAsync,           2,    261,      0,     1},
+  {"sync_after_program",       NULL,               AUDIT_Sync,                        2,      4,      2,     2},
+  {"write_address_verified",   AUDIT_Erase,        AUDIT_WriteAddressVerified,       80,   8400,     32,    64},
+  {"write_sector",             AUDIT_Erase,        AUDIT_WriteSector,                64,   4240,     32,    48},
+  {"write_block",              AUDIT_Erase,        AUDIT_WriteBlock,               1024,  67840,    512,   768},
+  {"copy_sector",              AUDIT_Program,      AUDIT_Copy,                      108,   8973,     56,    77},
+  {"copy_sector_unchanged",    NULL,               AUDIT_Copy,                       32,   8320,      0,     6},
+  {"write_image_erased",       AUDIT_Erase,        AUDIT_WriteImage,                 65,   8340,     32,    50},
+  {"write_image_unchanged",    NULL,               AUDIT_WriteImage,                  1,   4100,      0,     2},
+  {"counter_increment",        AUDIT_CounterOpen,  AUDIT_CounterIncrement,            2,      6,      0,     1},
+  {"counter_open",             AUDIT_Sync,         AUDIT_CounterOpen,                 8,    316,      0,     8},
+  {"erase_sector",             NULL,               AUDIT_EraseSector,                26,     53,     24,    25},
+  {"erase_block",              NULL,               AUDIT_EraseBlock,                 79,    159,     77,    78},
+  {"erase_sector_async",       NULL,               AUDIT_EraseSectorAsync,            2,      5,      0,     1},
+  {"is_busy",                  NULL,               AUDIT_IsBusy,                      1,      2,      1,     1},
+  {"sync_after_erase",         NULL,               AUDIT_Sync,                       24,     48,     24,    24},
+  {"is_busy_idle",             NULL,               AUDIT_Idle,                        0,      0,      0,     0},
+  {"erase_block_async",        NULL,               AUDIT_EraseBlockAsync,             2,      5,      0,     1},
+  {"erase_chip",               AUDIT_Sync,         AUDIT_EraseChip,               19204,  38406,  19202, 19203},
+};
+
+static void AUDIT_Frames(AUDIT_TypeDef *Audit)
+{
+  uint32_t n = (Audit->Device.LogCnt < AUDIT_LOG) ? Audit->Device.LogCnt : AUDIT_LOG;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    FLASHEMU_FrameTypeDef *frame = &Audit->Log[i];
+    /* collapse poll runs */
+    uint32_t run = 1;
+    while ((i + run < n) && (frame->Cmd == FLASHMAN_CMD_READSTATUS1) && (Audit->Log[i + run].Cmd == FLASHMAN_CMD_READSTATUS1))
+    {
+      run++;
+    }
+    printf("    %10.3f us  cmd 0x%02X  addr 0x%08X  %5u bytes", (double)(frame->StartNs) / 1000.0, frame->Cmd, frame->Address, frame->Bytes);
+    if (run > 1)
+    {
+      printf("  x%u", run);
+    }
+    printf("\n");
+    i += run - 1;
+  }
+  if (Audit->Device.LogCnt > AUDIT_LOG)
+  {
+    printf("    ... %u more\n", Audit->Device.LogCnt - AUDIT_LOG);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  static AUDIT_TypeDef audit;
+  bool verbose = (argc > 1) && (strcmp(argv[1], "-v") == 0);
+  uint32_t failed = 0;
+  uint64_t start;
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+  uint64_t messages;
+#endif
+
+  FLASHEMU_SpiInit(&audit.Spi, FLASHEMU_PCLK_HZ, SPI_BAUDRATEPRESCALER_4);
+  if ((FLASHEMU_Open(&audit.Device, NULL, FLASHMAN_MANUF_WINBOND, 0x40, FLASHMAN_SIZE_128MBIT) == false) ||
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+      (FLASHEMU_SpidevAdd(AUDIT_SPIDEV, &audit.Device) == false) ||
+      (FLASHMAN_SpidevOpen(&audit.Bus, AUDIT_SPIDEV, FLASHEMU_SpiHz(&audit.Spi), SPI_MODE_0) == false) ||
+#else
+      (FLASHEMU_Attach(&audit.Device, &audit.Spi, &audit.Gpio, AUDIT_GPIO_PIN) == false) ||
+#endif
+      (AUDIT_Init(&audit) == false))
+  {
+    fprintf(stderr, "emulated chip setup failed\n");
+    return 1;
+  }
+  for (uint32_t i = 0; i < FLASHMAN_BLOCK_SIZE; i++)
+  {
+    audit.Data[i] = (uint8_t)(i * 7 + (i >> 8));
+  }
+
+  printf("%-26s %8s %8s %8s %8s %8s %8s", "case", "frames", "budget", "bytes", "budget", "polls", "budget");
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+  printf(" %8s %8s", "msgs", "budget");
+#endif
+  printf("\n");
+  for (size_t i = 0; i < sizeof(AUDIT_Cases) / sizeof(AUDIT_Cases[0]); i++)
+  {
+    const AUDIT_CaseTypeDef *c = &AUDIT_Cases[i];
+    FLASHEMU_StatsTypeDef before;
+    bool ok, over;
+
+    if ((c->Prepare != NULL) && (c->Prepare(&audit) == false))
+    {
+      printf("%-26s prepare failed\n", c->Name);
+      failed++;
+      continue;
+    }
+    before = audit.Device.Stats;
+    start = FLASHEMU_GetTimeNs();
+    audit.Device.Log = audit.Log;
+    audit.Device.LogSize = AUDIT_LOG;
+    audit.Device.LogCnt = 0;
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+    messages = audit.Bus.Messages;
+#endif
+    ok = c->Run(&audit);
+    audit.Device.Log = NULL;
+    audit.Device.LogSize = 0;
+
+    uint64_t frames = audit.Device.Stats.Frames - before.Frames;
+    uint64_t bytes = audit.Device.Stats.Bytes - before.Bytes;
+    uint64_t polls = audit.Device.Stats.StatusPolls - before.StatusPolls;
+    over = (frames > c->Frames) || (bytes > c->Bytes) || (polls > c->Polls);
+    printf("%-26s %8llu %8u %8llu %8u %8llu %8u", c->Name, (unsigned long long)frames, c->Frames,
+           (unsigned long long)bytes, c->Bytes, (unsigned long long)polls, c->Polls);
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+    messages = audit.Bus.Messages - messages;
+    over = over || (messages > c->Messages);
+    printf(" %8llu %8u", (unsigned long long)messages, c->Messages);
+#endif
+    printf("  %s\n", (ok == false) ? "CALL FAILED" : (over ? "OVER BUDGET" : "ok"));
+    if ((ok == false) || over)
+    {
+      failed++;
+    }
+    if (verbose || (ok == false) || over)
+    {
+      printf("    %.3f us\n", (double)(FLASHEMU_GetTimeNs() - start) / 1000.0);
+      AUDIT_Frames(&audit);
+    }
+  }
+  FLASHEMU_Close(&audit.Device);
+  printf("%u of %u cases failed\n", failed, (uint32_t)(sizeof(AUDIT_Cases) / sizeof(AUDIT_Cases[0])));
+  return (failed != 0) ? 1 : 0;
+}
@@ -0,0 +1,1091 @@
+/*
+ * Throughput/latency benchmark of SPI_Flash_Manager on the emulated chip.
+ *
+ *   make -C Host bench && Host/build/flashman_bench [options] > result.json
+ *
+ *   -s <code>    JEDEC size code of the chip (default 0x18, 128 Mbit)
+ *   -p <div>     SPI prescaler divider 2..256 (default 4)
+ *   -c <hz>      SPI peripheral clock (default FLASHEMU_PCLK_HZ)
+ *   -o <ns>      HAL call overhead in ns (default 2000)
+ *   -n <ops>     operations per workload (default 1000)
+ *   -r <seed>    random seed (default 1)
+ *   -t <file>    save the driver trace ring at the end (FLASHMAN_TRACE_ENABLE builds), see SPI_Flash_Trace.c
+ *
+ * All times are virtual (emulator clock), so results are repeatable and independent of the host.
+ * Output is one JSON document on stdout.
+ */
+
+#include "SPI_Flash_Emulator.h"
+#include "SPI_Flash_Manager_Stripe.h"
+#include "SPI_Flash_Manager_Mirror.h"
+#include "SPI_Flash_Manager_Lz.h"
+#include "SPI_Flash_Manager_Stream.h"
+#include "SPI_Flash_Manager_Pool.h"
+#include "SPI_Flash_Manager_Counter.h"
+#if FLASHMAN_FS == FLASHMAN_FS_LITTLEFS
+#include "SPI_Flash_Manager_FS.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+/* bus time, DMA completion and the reset of the boot workload are read and set on the emulated SPI handle */
+#error "flashman_bench drives the emulated SPI handle, build it without FLASHMAN_PLATFORM_LINUX_SPIDEV"
+#endif
+
+#define BENCH_GPIO_PIN                            (1 << 0)
+#define BENCH_REGION                              (1024 * 1024)
+#define BENCH_LOG_RING                            16        /* sectors of the record log */
+#define BENCH_POOL_TARGET                         4
+#define BENCH_COUNTER_MS                          10        /* application time between counter updates */
+#define BENCH_IMAGE                               (1024 * 1024)
+#define BENCH_OTA_RATE                            46080     /* bytes/s, a 460800 baud UART */
+#define BENCH_OTA_PIECE                           256
+#define BENCH_DECODE_NS                           250       /* consumer CPU time per byte */
+#define BENCH_DECODE_CHUNK                        4096
+
+typedef enum
+{
+  BENCH_READ_SEQ = 0,
+  BENCH_READ_RANDOM,
+  BENCH_WRITE_PAGE,
+  BENCH_WRITE_SECTOR,
+  BENCH_WRITE_BLOCK,
+  BENCH_ERASE_SECTOR,
+  BENCH_ERASE_BLOCK,
+  BENCH_ERASE_CHIP,
+  BENCH_WRITE_RECORD,
+  BENCH_COMPARE,
+  BENCH_CHECKSUM,
+  BENCH_MIXED,
+
+} BENCH_KindTypeDef;
+
+typedef struct
+{
+  SPI_HandleTypeDef      Spi;
+  GPIO_TypeDef           Gpio;
+  FLASHEMU_DeviceTypeDef Device;
+  FLASHMAN_HandleTypeDef Handle;
+  /* second chip on its own bus for the stripe and mirror workloads */
+  SPI_HandleTypeDef      Spi2;
+  GPIO_TypeDef           Gpio2;
+  FLASHEMU_DeviceTypeDef Device2;
+  FLASHMAN_HandleTypeDef Handle2;
+  uint32_t               Ops;
+  uint64_t               *Latency;
+  uint8_t                *Buffer;
+  bool                   First;
+  uint32_t               LzRaw;
+  uint32_t               LzStored;
+  FLASHMAN_PoolTypeDef   Pool[2];          /* after the steady and the burst log */
+
+} BENCH_TypeDef;
+
+typedef struct
+{
+  uint64_t               Start;
+  uint64_t               BusStart;
+  uint64_t               Bytes;
+  uint32_t               Ops;
+  uint32_t               Errors;
+
+} BENCH_RunTypeDef;
+
+static int BENCH_CompareU64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static uint32_t BENCH_Random(uint32_t Limit)
+{
+  return (uint32_t)(((uint64_t)rand() * RAND_MAX + rand()) % Limit);
+}
+
+static void BENCH_Begin(BENCH_TypeDef *Bench, BENCH_RunTypeDef *Run)
+{
+  memset(Run, 0, sizeof(BENCH_RunTypeDef));
+  Run->Start = FLASHEMU_GetTimeNs();
+  Run->BusStart = Bench->Spi.BusNs;
+}
+
+static void BENCH_Op(BENCH_TypeDef *Bench, BENCH_RunTypeDef *Run, uint64_t OpStart, uint32_t Bytes, bool Ok)
+{
+  Bench->Latency[Run->Ops++] = FLASHEMU_GetTimeNs() - OpStart;
+  Run->Bytes += Bytes;
+  if (Ok == false)
+  {
+    Run->Errors++;
+  }
+}
+
+static void BENCH_Report(BENCH_TypeDef *Bench, BENCH_RunTypeDef *Run, const char *Name, uint32_t Size)
+{
+  uint64_t elapsed = FLASHEMU_GetTimeNs() - Run->Start;
+  uint64_t bus = Bench->Spi.BusNs - Run->BusStart;
+  double seconds = (elapsed > 0) ? elapsed / 1e9 : 1e-9;
+  printf("%s    {\"name\": \"%s\", \"size\": %u, \"ops\": %u, \"errors\": %u, \"bytes\": %llu, \"elapsed_us\": %.1f, "
+         "\"mb_s\": %.3f, \"ops_s\": %.1f, ",
+         Bench->First ? "" : ",\n", Name, Size, Run->Ops, Run->Errors, (unsigned long long)Run->Bytes, elapsed / 1e3,
+         Run->Bytes / seconds / 1e6, Run->Ops / seconds);
+  if (Run->Ops == 0)
+  {
+    /* no latency to sort */
+    printf("\"p50_us\": null, \"p99_us\": null, \"max_us\": null, ");
+  }
+  else
+  {
+    qsort(Bench->Latency, Run->Ops, sizeof(uint64_t), BENCH_CompareU64);
+    printf("\"p50_us\": %.1f, \"p99_us\": %.1f, \"max_us\": %.1f, ",
+           Bench->Latency[Run->Ops / 2] / 1e3, Bench->Latency[(Run->Ops * 99) / 100] / 1e3, Bench->Latency[Run->Ops - 1] / 1e3);
+  }
+  printf("\"bus_util\": %.4f}", (elapsed > 0) ? (double)bus / elapsed : 0.0);
+  Bench->First = false;
+}
+
+static void BENCH_Blank(BENCH_TypeDef *Bench)
+{
+  /* back door, preparation is not part of the measurement */
+  memset(Bench->Device.Array, 0xFF, Bench->Device.Size);
+  memset(Bench->Device2.Array, 0xFF, Bench->Device2.Size);
+}
+
+static void BENCH_Run(BENCH_TypeDef *Bench, BENCH_KindTypeDef Kind, uint32_t Size)
+{
+  FLASHMAN_HandleTypeDef *h = &Bench->Handle;
+  BENCH_RunTypeDef run;
+  char name[32];
+  uint32_t ops = Bench->Ops, address = 0, region = BENCH_REGION;
+  uint64_t t;
+  bool ok;
+
+  if (region > Bench->Device.Size)
+  {
+    region = (uint32_t)Bench->Device.Size;
+  }
+  switch (Kind)
+  {
+  case BENCH_READ_SEQ:
+  case BENCH_READ_RANDOM:
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      address = (Kind == BENCH_READ_SEQ) ? (i * Size) % region : BENCH_Random(region - Size + 1);
+      t = FLASHEMU_GetTimeNs();
+      ok = FLASHMAN_ReadAddress(h, address, Bench->Buffer, Size);
+      BENCH_Op(Bench, &run, t, Size, ok);
+    }
+    snprintf(name, sizeof(name), "%s_%u", (Kind == BENCH_READ_SEQ) ? "read_seq" : "read_random", Size);
+    break;
+  case BENCH_WRITE_PAGE:
+  case BENCH_WRITE_SECTOR:
+  case BENCH_WRITE_BLOCK:
+    BENCH_Blank(Bench);
+    if (ops > region / Size)
+    {
+      ops = region / Size;
+    }
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      t = FLASHEMU_GetTimeNs();
+      if (Kind == BENCH_WRITE_PAGE)
+      {
+        ok = FLASHMAN_WritePage(h, i, Bench->Buffer, Size, 0);
+      }
+      else if (Kind == BENCH_WRITE_SECTOR)
+      {
+        ok = FLASHMAN_WriteSector(h, i, Bench->Buffer, Size, 0);
+      }
+      else
+      {
+        ok = FLASHMAN_WriteBlock(h, i, Bench->Buffer, Size, 0);
+      }
+      BENCH_Op(Bench, &run, t, Size, ok);
+    }
+    snprintf(name, sizeof(name), "%s", (Kind == BENCH_WRITE_PAGE) ? "write_page" : (Kind == BENCH_WRITE_SECTOR) ? "write_sector" : "write_block");
+    break;
+  case BENCH_ERASE_SECTOR:
+  case BENCH_ERASE_BLOCK:
+    if (ops > region / Size)
+    {
+      ops = region / Size;
+    }
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      t = FLASHEMU_GetTimeNs();
+      ok = (Kind == BENCH_ERASE_SECTOR) ? FLASHMAN_EraseSector(h, i) : FLASHMAN_EraseBlock(h, i);
+      BENCH_Op(Bench, &run, t, Size, ok);
+    }
+    snprintf(name, sizeof(name), "%s", (Kind == BENCH_ERASE_SECTOR) ? "erase_sector" : "erase_block");
+    break;
+  case BENCH_ERASE_CHIP:
+    BENCH_Begin(Bench, &run);
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_EraseChip(h);
+    BENCH_Op(Bench, &run, t, Size, ok);
+    snprintf(name, sizeof(name), "erase_chip");
+    break;
+  case BENCH_WRITE_RECORD:
+    /* back to back small appends, the final sync is part of the elapsed time */
+    BENCH_Blank(Bench);
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      t = FLASHEMU_GetTimeNs();
+      ok = FLASHMAN_WriteAddress(h, i * Size, Bench->Buffer, Size);
+      BENCH_Op(Bench, &run, t, Size, ok);
+    }
+    if (FLASHMAN_Sync(h) == false)
+    {
+      run.Errors++;
+    }
+    snprintf(name, sizeof(name), "write_record_%u", Size);
+    break;
+  case BENCH_COMPARE:
+    /* matching data, so every compare streams the whole range */
+    for (uint32_t i = 0; i + Size <= region; i += Size)
+    {
+      memcpy(&Bench->Device.Array[i], Bench->Buffer, Size);
+    }
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      uint32_t mismatch;
+      t = FLASHEMU_GetTimeNs();
+      ok = FLASHMAN_Compare(h, (i * Size) % region, Bench->Buffer, Size, &mismatch) && (mismatch == Size);
+      BENCH_Op(Bench, &run, t, Size, ok);
+    }
+    snprintf(name, sizeof(name), "compare_%u", Size);
+    break;
+  case BENCH_CHECKSUM:
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      uint8_t digest[FLASHMAN_SHA256_SIZE];
+      t = FLASHEMU_GetTimeNs();
+      ok = FLASHMAN_Checksum(h, (i * Size) % region, Size, FLASHMAN_CHECKSUM_SHA256, digest);
+      BENCH_Op(Bench, &run, t, Size, ok);
+    }
+    snprintf(name, sizeof(name), "sha256_%u", Size);
+    break;
+  case BENCH_MIXED:
+  default:
+    /* 70 % random reads, 30 % appends of Size bytes into erased space */
+    BENCH_Blank(Bench);
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      t = FLASHEMU_GetTimeNs();
+      if ((BENCH_Random(10) < 3) && (address + Size <= region))
+      {
+        ok = FLASHMAN_WriteAddress(h, address, Bench->Buffer, Size);
+        address += Size;
+      }
+      else
+      {
+        ok = FLASHMAN_ReadAddress(h, BENCH_Random(region - Size + 1), Bench->Buffer, Size);
+      }
+      BENCH_Op(Bench, &run, t, Size, ok);
+    }
+    snprintf(name, sizeof(name), "mixed_70r30w_%u", Size);
+    break;
+  }
+  BENCH_Report(Bench, &run, name, Size);
+}
+
+/* both bench chips striped by page */
+static void BENCH_Stripe(BENCH_TypeDef *Bench)
+{
+  static FLASHMAN_StripeTypeDef stripe;
+  FLASHMAN_HandleTypeDef *members[2] = {&Bench->Handle, &Bench->Handle2};
+  BENCH_RunTypeDef run;
+  uint32_t ops, size = FLASHMAN_SECTOR_SIZE * 2;
+  uint64_t t;
+  bool ok;
+
+  if (FLASHMAN_StripeInit(&stripe, members, 2, FLASHMAN_PAGE_SIZE) == false)
+  {
+    return;
+  }
+  ops = (BENCH_REGION * 2) / size;
+  if (ops > Bench->Ops)
+  {
+    ops = Bench->Ops;
+  }
+  BENCH_Blank(Bench);
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_StripeWrite(&stripe, i * size, Bench->Buffer, size);
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  BENCH_Report(Bench, &run, "stripe2_write", size);
+
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_StripeRead(&stripe, i * size, Bench->Buffer, size);
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  BENCH_Report(Bench, &run, "stripe2_read", size);
+
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_StripeEraseSector(&stripe, i);
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  BENCH_Report(Bench, &run, "stripe2_erase_sector", size);
+}
+
+/* read latency while sectors are being erased: one chip with async erases against a staggered mirror */
+static void BENCH_Mirror(BENCH_TypeDef *Bench)
+{
+  static FLASHMAN_MirrorTypeDef mirror;
+  BENCH_RunTypeDef run;
+  uint32_t size = FLASHMAN_PAGE_SIZE, region = BENCH_REGION / 2, sector = FLASHMAN_AddressToSector(region);
+  uint64_t t;
+  bool ok;
+
+  if (FLASHMAN_MirrorInit(&mirror, &Bench->Handle, &Bench->Handle2) == false)
+  {
+    return;
+  }
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < Bench->Ops; i++)
+  {
+    if ((i % 32) == 0)
+    {
+      FLASHMAN_EraseSectorAsync(&Bench->Handle, sector + (i / 32) % 64);
+    }
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_ReadAddress(&Bench->Handle, BENCH_Random(region - size + 1), Bench->Buffer, size);
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  FLASHMAN_Sync(&Bench->Handle);
+  BENCH_Report(Bench, &run, "single_read_erasing", size);
+
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < Bench->Ops; i++)
+  {
+    if ((i % 32) == 0)
+    {
+      FLASHMAN_MirrorEraseSector(&mirror, sector + (i / 32) % 64);
+    }
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_MirrorRead(&mirror, BENCH_Random(region - size + 1), Bench->Buffer, size);
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  FLASHMAN_MirrorSync(&mirror);
+  BENCH_Report(Bench, &run, "mirror_read_erasing", size);
+
+  BENCH_Blank(Bench);
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; (i < Bench->Ops) && ((i + 1) * FLASHMAN_SECTOR_SIZE <= region); i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_MirrorWrite(&mirror, i * FLASHMAN_SECTOR_SIZE, Bench->Buffer, FLASHMAN_SECTOR_SIZE, NULL);
+    BENCH_Op(Bench, &run, t, FLASHMAN_SECTOR_SIZE, ok);
+  }
+  BENCH_Report(Bench, &run, "mirror_write", FLASHMAN_SECTOR_SIZE);
+}
+
+/* log text stored raw (erase + program) against the same text through a compressed region */
+static void BENCH_Lz(BENCH_TypeDef *Bench)
+{
+  static FLASHMAN_LzTypeDef region;
+  BENCH_RunTypeDef run;
+  uint32_t ops = BENCH_REGION / FLASHMAN_SECTOR_SIZE, size = FLASHMAN_SECTOR_SIZE, length = 0, line = 0;
+  uint8_t *text;
+  uint64_t t;
+  bool ok;
+
+  if (ops > Bench->Ops)
+  {
+    ops = Bench->Ops;
+  }
+  text = malloc((size_t)ops * size + 128);
+  if (text == NULL)
+  {
+    return;
+  }
+  while (length < ops * size)
+  {
+    length += (uint32_t)sprintf((char *)&text[length], "[%10u] sensor %u temp=%d.%u C vbat=%u mV state=%s\n",
+                                line * 137, line % 7, 20 + (int)BENCH_Random(5), BENCH_Random(10), 3600 + BENCH_Random(200),
+                                ((line % 50) != 0) ? "OK" : "WARN");
+    line++;
+  }
+  BENCH_Blank(Bench);
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_EraseSector(&Bench->Handle, i) && FLASHMAN_WriteAddress(&Bench->Handle, i * size, &text[i * size], size);
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  BENCH_Report(Bench, &run, "raw_log_write", size);
+
+  BENCH_Blank(Bench);
+  if (FLASHMAN_LzInit(&region, &Bench->Handle, 0, BENCH_REGION / FLASHMAN_SECTOR_SIZE) && FLASHMAN_LzFormat(&region))
+  {
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      t = FLASHEMU_GetTimeNs();
+      ok = FLASHMAN_LzAppend(&region, &text[i * size], size) && ((i + 1 < ops) || FLASHMAN_LzClose(&region));
+      BENCH_Op(Bench, &run, t, size, ok);
+    }
+    BENCH_Report(Bench, &run, "lz_log_write", size);
+    Bench->LzRaw = region.Size;
+    Bench->LzStored = region.Stored;
+
+    size = FLASHMAN_PAGE_SIZE;
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < Bench->Ops; i++)
+    {
+      t = FLASHEMU_GetTimeNs();
+      ok = FLASHMAN_LzRead(&region, BENCH_Random(region.Size - size + 1), Bench->Buffer, size);
+      BENCH_Op(Bench, &run, t, size, ok);
+    }
+    BENCH_Report(Bench, &run, "lz_log_read_random", size);
+  }
+  free(text);
+}
+
+/* staging a 64 KB image from chip 1 into chip 2 or within chip 1: read + erase + write sector by sector
+   against FLASHMAN_Copy(), then the same copy again onto an up to date destination */
+static void BENCH_Copy(BENCH_TypeDef *Bench)
+{
+  BENCH_RunTypeDef run;
+  uint32_t size = FLASHMAN_BLOCK_SIZE, ops = (Bench->Ops < 8) ? Bench->Ops : 8, skipped;
+  uint64_t t;
+  bool ok;
+
+  BENCH_Blank(Bench);
+  for (uint32_t i = 0; i < ops * size; i++)
+  {
+    Bench->Device.Array[i] = (uint8_t)rand();
+  }
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = true;
+    for (uint32_t offset = 0; (offset < size) && ok; offset += FLASHMAN_SECTOR_SIZE)
+    {
+      ok = FLASHMAN_ReadAddress(&Bench->Handle, i * size + offset, Bench->Buffer, FLASHMAN_SECTOR_SIZE) &&
+           FLASHMAN_EraseSector(&Bench->Handle2, FLASHMAN_AddressToSector(i * size + offset)) &&
+           FLASHMAN_WriteAddress(&Bench->Handle2, i * size + offset, Bench->Buffer, FLASHMAN_SECTOR_SIZE);
+    }
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  BENCH_Report(Bench, &run, "copy_serial", size);
+
+  for (uint32_t pass = 0; pass < 2; pass++)
+  {
+    if (pass == 0)
+    {
+      memset(Bench->Device2.Array, 0x00, (size_t)ops * size);
+    }
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      t = FLASHEMU_GetTimeNs();
+      ok = FLASHMAN_Copy(&Bench->Handle, i * size, &Bench->Handle2, i * size, size, &skipped) &&
+           (memcmp(&Bench->Device2.Array[i * size], &Bench->Device.Array[i * size], size) == 0);
+      BENCH_Op(Bench, &run, t, size, ok);
+    }
+    BENCH_Report(Bench, &run, (pass == 0) ? "copy" : "copy_unchanged", size);
+  }
+
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_Copy(&Bench->Handle, i * size, &Bench->Handle, BENCH_REGION + i * size, size, &skipped);
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  BENCH_Report(Bench, &run, "copy_within", size);
+}
+
+/* field update of a 1 MB image: full erase + program against FLASHMAN_WriteImage() with one
+   sector patched per update, a patch that only clears bits, and no change */
+static void BENCH_Image(BENCH_TypeDef *Bench)
+{
+  static uint8_t image[BENCH_IMAGE];
+  BENCH_RunTypeDef run;
+  FLASHMAN_ImageReportTypeDef report;
+  uint32_t ops = (Bench->Ops < 4) ? Bench->Ops : 4, sector;
+  uint64_t t;
+  bool ok;
+
+  for (uint32_t i = 0; i < BENCH_IMAGE; i++)
+  {
+    image[i] = (uint8_t)rand();
+  }
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = true;
+    for (uint32_t offset = 0; (offset < BENCH_IMAGE) && ok; offset += FLASHMAN_BLOCK_SIZE)
+    {
+      ok = FLASHMAN_EraseBlock(&Bench->Handle, FLASHMAN_AddressToBlock(BENCH_REGION + offset));
+    }
+    ok = ok && FLASHMAN_WriteAddress(&Bench->Handle, BENCH_REGION, image, BENCH_IMAGE);
+    BENCH_Op(Bench, &run, t, BENCH_IMAGE, ok);
+  }
+  BENCH_Report(Bench, &run, "image_full", BENCH_IMAGE);
+
+  for (uint32_t pass = 0; pass < 3; pass++)
+  {
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      sector = (uint32_t)rand() % (BENCH_IMAGE / FLASHMAN_SECTOR_SIZE);
+      for (uint32_t j = 0; (pass < 2) && (j < FLASHMAN_SECTOR_SIZE); j++)
+      {
+        image[sector * FLASHMAN_SECTOR_SIZE + j] = (pass == 0) ? (uint8_t)rand() : image[sector * FLASHMAN_SECTOR_SIZE + j] & 0xF0;
+      }
+      t = FLASHEMU_GetTimeNs();
+      ok = FLASHMAN_WriteImage(&Bench->Handle, BENCH_REGION, image, BENCH_IMAGE, &report) &&
+           (memcmp(&Bench->Device.Array[BENCH_REGION], image, BENCH_IMAGE) == 0);
+      BENCH_Op(Bench, &run, t, BENCH_IMAGE, ok);
+    }
+    BENCH_Report(Bench, &run, (pass == 0) ? "image_diff_sector" : (pass == 1) ? "image_diff_clear" : "image_diff_unchanged", BENCH_IMAGE);
+  }
+}
+
+/* a log writing a sector per record into a ring of sectors, the application runs between records. Each record
+   erases its sector inline, or takes one the pool erased from the idle loop. Latency is take/erase + write */
+static void BENCH_Pool(BENCH_TypeDef *Bench)
+{
+  static const uint32_t periodMs[] = {100, 100, 10};
+  static const char *names[] = {"log_erase_inline", "log_pool", "log_pool_burst"};
+  BENCH_RunTypeDef run;
+  uint32_t ops = (Bench->Ops < 64) ? Bench->Ops : 64, first = FLASHMAN_AddressToSector(BENCH_REGION), sector;
+  uint64_t t, arrival;
+  bool ok;
+
+  for (uint32_t pass = 0; pass < 3; pass++)
+  {
+    /* back door, a ring full of old records */
+    memset(&Bench->Device.Array[BENCH_REGION], 0x00, BENCH_LOG_RING * FLASHMAN_SECTOR_SIZE);
+    FLASHMAN_Sync(&Bench->Handle);
+    BENCH_Begin(Bench, &run);
+    ok = (pass == 0) || FLASHMAN_PoolInit(&Bench->Pool[pass - 1], &Bench->Handle, BENCH_POOL_TARGET);
+    for (uint32_t i = 0; (i < BENCH_LOG_RING) && ok && (pass > 0); i++)
+    {
+      ok = FLASHMAN_PoolRelease(&Bench->Pool[pass - 1], first + i);
+    }
+    arrival = FLASHEMU_GetTimeNs();
+    for (uint32_t i = 0; (i < ops) && ok; i++)
+    {
+      arrival += periodMs[pass] * 1000000ULL;
+      while ((t = FLASHEMU_GetTimeNs()) < arrival)
+      {
+        if (pass > 0)
+        {
+          FLASHMAN_PoolProcess(&Bench->Pool[pass - 1]);
+        }
+        FLASHEMU_Advance(((arrival - t) < 100000) ? (arrival - t) : 100000);
+      }
+      t = FLASHEMU_GetTimeNs();
+      if (pass == 0)
+      {
+        sector = first + i % BENCH_LOG_RING;
+        ok = FLASHMAN_EraseSector(&Bench->Handle, sector);
+      }
+      else
+      {
+        ok = FLASHMAN_PoolTake(&Bench->Pool[pass - 1], &sector);
+      }
+      ok = ok && FLASHMAN_WriteSector(&Bench->Handle, sector, Bench->Buffer, FLASHMAN_SECTOR_SIZE, 0) &&
+           (memcmp(&Bench->Device.Array[FLASHMAN_SectorToAddress(sector)], Bench->Buffer, FLASHMAN_SECTOR_SIZE) == 0);
+      /* the record is dropped again right away, so the ring keeps turning */
+      ok = ok && ((pass == 0) || FLASHMAN_PoolRelease(&Bench->Pool[pass - 1], sector));
+      BENCH_Op(Bench, &run, t, FLASHMAN_SECTOR_SIZE, ok);
+    }
+    BENCH_Report(Bench, &run, names[pass], FLASHMAN_SECTOR_SIZE);
+  }
+}
+
+/* a sequence number kept in flash: erase and rewrite of a 4 byte value per update, against a bit-clearing
+   counter updated every BENCH_COUNTER_MS whose run crosses into its other sector, and the scan that finds
+   the value at boot */
+static void BENCH_Counter(BENCH_TypeDef *Bench)
+{
+  FLASHMAN_CounterTypeDef counter;
+  BENCH_RunTypeDef run;
+  uint32_t ops = (Bench->Ops < 64) ? Bench->Ops : 64, sector = FLASHMAN_AddressToSector(BENCH_REGION), value;
+  uint32_t header[3] = {FLASHMAN_COUNTER_MAGIC, 0, 0xFFFFFFFF}, fill, check;
+  uint64_t t;
+  bool ok;
+
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    value = i + 1;
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_EraseSector(&Bench->Handle, sector) &&
+         FLASHMAN_WriteAddress(&Bench->Handle, BENCH_REGION, (uint8_t *)&value, sizeof(value)) &&
+         FLASHMAN_ReadAddress(&Bench->Handle, BENCH_REGION, (uint8_t *)&check, sizeof(check)) && (check == value);
+    BENCH_Op(Bench, &run, t, sizeof(value), ok);
+  }
+  BENCH_Report(Bench, &run, "counter_rewrite", sizeof(value));
+
+  /* back door, a counter half a run short of a full sector */
+  FLASHMAN_Sync(&Bench->Handle);
+  fill = (FLASHMAN_COUNTER_BITS - Bench->Ops / 2) / 8;
+  memset(&Bench->Device.Array[BENCH_REGION], 0xFF, 2 * FLASHMAN_SECTOR_SIZE);
+  memcpy(&Bench->Device.Array[BENCH_REGION], header, sizeof(header));
+  memset(&Bench->Device.Array[BENCH_REGION + FLASHMAN_COUNTER_HEADER], 0x00, fill);
+  ok = FLASHMAN_CounterOpen(&counter, &Bench->Handle, sector) && (counter.Value == fill * 8);
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < Bench->Ops; i++)
+  {
+    FLASHEMU_Advance(BENCH_COUNTER_MS * 1000000ULL);
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_CounterIncrement(&counter) && (counter.Value == fill * 8 + i + 1);
+    BENCH_Op(Bench, &run, t, sizeof(value), ok);
+  }
+  BENCH_Report(Bench, &run, "counter_bits", sizeof(value));
+
+  value = counter.Value;
+  ops = (Bench->Ops < 32) ? Bench->Ops : 32;
+  FLASHMAN_Sync(&Bench->Handle);
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_CounterOpen(&counter, &Bench->Handle, sector) && (counter.Value == value);
+    BENCH_Op(Bench, &run, t, sizeof(value), ok);
+  }
+  BENCH_Report(Bench, &run, "counter_open", sizeof(value));
+}
+
+/* boot to the first read after an MCU reset: probe and power-up wait against a descriptor saved by the
+   previous boot, with the chip idle and in deep power-down. The emulator clock restarts at 0 every op */
+static void BENCH_Boot(BENCH_TypeDef *Bench)
+{
+  static const char *names[] = {"init_cold", "init_warm", "init_warm_dpd"};
+  FLASHMAN_DescriptorTypeDef descriptor;
+  BENCH_RunTypeDef run;
+  uint32_t ops = (Bench->Ops < 32) ? Bench->Ops : 32;
+  uint64_t t, now;
+  bool ok;
+
+  FLASHMAN_Sync(&Bench->Handle);
+  ok = FLASHMAN_GetDescriptor(&Bench->Handle, &descriptor);
+  for (uint32_t pass = 0; pass < 3; pass++)
+  {
+    BENCH_Begin(Bench, &run);
+    for (uint32_t i = 0; i < ops; i++)
+    {
+      now = FLASHEMU_GetTimeNs();
+      FLASHEMU_SetTimeNs(0);
+      Bench->Device.BusyUntil = 0;
+      Bench->Spi.DmaUntil = 0;
+      Bench->Device.PowerDown = (pass == 2);
+      Bench->Handle.Inited = 0;
+      if (pass == 0)
+      {
+        ok = FLASHMAN_Init(&Bench->Handle, &Bench->Spi, &Bench->Gpio, BENCH_GPIO_PIN);
+      }
+      else
+      {
+        ok = FLASHMAN_InitWarm(&Bench->Handle, &Bench->Spi, &Bench->Gpio, BENCH_GPIO_PIN, &descriptor);
+      }
+      ok = ok && FLASHMAN_ReadAddress(&Bench->Handle, 0, Bench->Buffer, 16) &&
+           (memcmp(Bench->Buffer, Bench->Device.Array, 16) == 0);
+      t = FLASHEMU_GetTimeNs();
+      FLASHEMU_SetTimeNs(now + t);
+      BENCH_Op(Bench, &run, now, 16, ok);
+    }
+    BENCH_Report(Bench, &run, names[pass], 16);
+  }
+}
+
+/*
+ * A 256 KB image arriving at BENCH_OTA_RATE in BENCH_OTA_PIECE pieces. Latency is the time the receiver
+ * spends in the write call, throughput includes waiting for the transport (ideal: BENCH_OTA_RATE).
+ * Blocking block erase + page writes against the streaming writer serviced from the idle loop.
+ */
+static bool BENCH_DecodeChunk(void *Context, const uint8_t *Data, uint32_t Offset, uint32_t Size)
+{
+  (void)Offset;
+  *(uint32_t *)Context += Data[0];
+  FLASHEMU_Advance((uint64_t)Size * BENCH_DECODE_NS);
+  return true;
+}
+
+/* asset decode: read a chunk then process it, against FLASHMAN_ReadStream() (overlapped on FLASHMAN_PLATFORM_HAL_DMA builds) */
+static void BENCH_Decode(BENCH_TypeDef *Bench)
+{
+  static uint8_t chunk[2][BENCH_DECODE_CHUNK];
+  uint8_t *buffers[2] = {chunk[0], chunk[1]};
+  BENCH_RunTypeDef run;
+  uint32_t size = FLASHMAN_BLOCK_SIZE, ops = (Bench->Ops < 64) ? Bench->Ops : 64, sum = 0;
+  uint64_t t;
+  bool ok;
+
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = true;
+    for (uint32_t offset = 0; (offset < size) && ok; offset += BENCH_DECODE_CHUNK)
+    {
+      ok = FLASHMAN_ReadAddress(&Bench->Handle, (i % 16) * size + offset, chunk[0], BENCH_DECODE_CHUNK) &&
+           BENCH_DecodeChunk(&sum, chunk[0], offset, BENCH_DECODE_CHUNK);
+    }
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  BENCH_Report(Bench, &run, "read_decode", size);
+
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < ops; i++)
+  {
+    t = FLASHEMU_GetTimeNs();
+    ok = FLASHMAN_ReadStream(&Bench->Handle, (i % 16) * size, size, buffers, 2, BENCH_DECODE_CHUNK, BENCH_DecodeChunk, &sum);
+    BENCH_Op(Bench, &run, t, size, ok);
+  }
+  BENCH_Report(Bench, &run, "stream_decode", size);
+}
+
+static void BENCH_Ota(BENCH_TypeDef *Bench)
+{
+  static FLASHMAN_StreamTypeDef stream;
+  static uint8_t page[FLASHMAN_PAGE_SIZE];
+  BENCH_RunTypeDef run;
+  uint32_t size = 256 * 1024, fill = 0, ops = size / BENCH_OTA_PIECE;
+  uint64_t t, arrival, period = (1000000000ULL * BENCH_OTA_PIECE) / BENCH_OTA_RATE;
+  bool ok;
+
+  if (ops > Bench->Ops)
+  {
+    ops = Bench->Ops;
+    size = ops * BENCH_OTA_PIECE;
+  }
+  for (uint32_t pass = 0; pass < 2; pass++)
+  {
+    BENCH_Blank(Bench);
+    memset(Bench->Device.Array, 0x00, size);
+    BENCH_Begin(Bench, &run);
+    arrival = FLASHEMU_GetTimeNs();
+    ok = (pass == 0) || FLASHMAN_StreamOpen(&stream, &Bench->Handle, 0, size);
+    for (uint32_t i = 0; (i < ops) && ok; i++)
+    {
+      arrival += period;
+      /* receiver idle loop until the next piece is in, the stream is serviced every 100 us */
+      while ((t = FLASHEMU_GetTimeNs()) < arrival)
+      {
+        if (pass == 1)
+        {
+          FLASHMAN_StreamProcess(&stream);
+        }
+        FLASHEMU_Advance(((arrival - t) < 100000) ? (arrival - t) : 100000);
+      }
+      t = FLASHEMU_GetTimeNs();
+      if (pass == 0)
+      {
+        if ((i * BENCH_OTA_PIECE) % FLASHMAN_BLOCK_SIZE == 0)
+        {
+          ok = FLASHMAN_EraseBlock(&Bench->Handle, FLASHMAN_AddressToBlock(i * BENCH_OTA_PIECE));
+        }
+        memcpy(&page[fill], &Bench->Buffer[(i * BENCH_OTA_PIECE) % FLASHMAN_BLOCK_SIZE], BENCH_OTA_PIECE);
+        fill += BENCH_OTA_PIECE;
+        if (fill == FLASHMAN_PAGE_SIZE)
+        {
+          ok = ok && FLASHMAN_WriteAddress(&Bench->Handle, (i + 1) * BENCH_OTA_PIECE - fill, page, fill);
+          fill = 0;
+        }
+      }
+      else
+      {
+        ok = FLASHMAN_StreamAppend(&stream, &Bench->Buffer[(i * BENCH_OTA_PIECE) % FLASHMAN_BLOCK_SIZE], BENCH_OTA_PIECE) &&
+             ((i + 1 < ops) || FLASHMAN_StreamFinish(&stream));
+      }
+      BENCH_Op(Bench, &run, t, BENCH_OTA_PIECE, ok);
+    }
+    for (uint32_t i = 0; (i < size) && ok; i += FLASHMAN_BLOCK_SIZE)
+    {
+      if (memcmp(&Bench->Device.Array[i], Bench->Buffer, FLASHMAN_BLOCK_SIZE) != 0)
+      {
+        run.Errors++;
+        break;
+      }
+    }
+    BENCH_Report(Bench, &run, (pass == 0) ? "ota_blocking" : "ota_stream", BENCH_OTA_PIECE);
+  }
+}
+
+#if FLASHMAN_FS == FLASHMAN_FS_LITTLEFS
+static void BENCH_Lfs(BENCH_TypeDef *Bench)
+{
+  static FLASHMAN_LfsTypeDef lfsDev;
+  lfs_t lfs;
+  lfs_file_t file;
+  BENCH_RunTypeDef run;
+  char path[16];
+  uint32_t files = 32, appends = 16, record = 64;
+  uint64_t t;
+  bool ok;
+
+  BENCH_Blank(Bench);
+  if ((FLASHMAN_LfsConfig(&lfsDev, &Bench->Handle, 0, BENCH_REGION / FLASHMAN_SECTOR_SIZE, 500) == false) ||
+      (lfs_format(&lfs, &lfsDev.Config) != 0) || (lfs_mount(&lfs, &lfsDev.Config) != 0))
+  {
+    return;
+  }
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < files; i++)
+  {
+    snprintf(path, sizeof(path), "f%03u", i);
+    t = FLASHEMU_GetTimeNs();
+    ok = (lfs_file_open(&lfs, &file, path, LFS_O_WRONLY | LFS_O_CREAT) == 0) && (lfs_file_close(&lfs, &file) == 0);
+    BENCH_Op(Bench, &run, t, 0, ok);
+  }
+  BENCH_Report(Bench, &run, "lfs_create", 0);
+
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < files * appends; i++)
+  {
+    snprintf(path, sizeof(path), "f%03u", i % files);
+    t = FLASHEMU_GetTimeNs();
+    ok = (lfs_file_open(&lfs, &file, path, LFS_O_WRONLY | LFS_O_APPEND) == 0) &&
+         (lfs_file_write(&lfs, &file, Bench->Buffer, record) == (lfs_ssize_t)record) && (lfs_file_close(&lfs, &file) == 0);
+    BENCH_Op(Bench, &run, t, record, ok);
+  }
+  BENCH_Report(Bench, &run, "lfs_append", record);
+
+  BENCH_Begin(Bench, &run);
+  for (uint32_t i = 0; i < files; i++)
+  {
+    snprintf(path, sizeof(path), "f%03u", i);
+    t = FLASHEMU_GetTimeNs();
+    ok = (lfs_file_open(&lfs, &file, path, LFS_O_RDONLY) == 0) &&
+         (lfs_file_read(&lfs, &file, Bench->Buffer, record * appends) == (lfs_ssize_t)(record * appends)) && (lfs_file_close(&lfs, &file) == 0);
+    BENCH_Op(Bench, &run, t, record * appends, ok);
+  }
+  BENCH_Report(Bench, &run, "lfs_read", record * appends);
+  lfs_unmount(&lfs);
+}
+#endif
+
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+static void BENCH_Hist(const char *Name, const uint32_t *Hist)
+{
+  printf(",\n    \"%s\": [", Name);
+  for (uint32_t i = 0; i < FLASHMAN_STATS_BUCKETS; i++)
+  {
+    printf("%s%u", (i == 0) ? "" : ", ", Hist[i]);
+  }
+  printf("]");
+}
+
+/* the driver's own counters over the whole run, histogram bucket n holds latencies < 2^n us */
+static void BENCH_Stats(BENCH_TypeDef *Bench)
+{
+  static const char *apiNames[FLASHMAN_STAT_API_CNT] = {"read", "write", "erase_sector", "erase_block", "erase_chip"};
+  FLASHMAN_StatsTypeDef stats;
+  if (FLASHMAN_GetStats(&Bench->Handle, &stats) == false)
+  {
+    return;
+  }
+  printf(",\n  \"driver_stats\": {\n    \"api\": {");
+  for (uint32_t i = 0; i < FLASHMAN_STAT_API_CNT; i++)
+  {
+    printf("%s\"%s\": {\"ops\": %u, \"errors\": %u, \"bytes\": %llu}", (i == 0) ? "" : ", ", apiNames[i],
+           stats.Ops[i], stats.Errors[i], (unsigned long long)stats.Bytes[i]);
+  }
+  printf("},\n    \"page_programs\": %u, \"busy_polls\": %u, \"busy_timeouts\": %u, \"lock_waits\": %u, \"lock_wait_us\": %u",
+         stats.PagePrograms, stats.BusyPolls, stats.BusyTimeouts, stats.LockWaits, stats.LockWaitUs);
+  BENCH_Hist("read_hist", stats.ReadHist);
+  BENCH_Hist("program_hist", stats.ProgramHist);
+  BENCH_Hist("erase_hist", stats.EraseHist);
+  printf("\n  }");
+}
+#endif
+
+static void BENCH_Trace(BENCH_TypeDef *Bench, const char *Path)
+{
+#if FLASHMAN_TRACE == FLASHMAN_TRACE_ENABLE
+  static FLASHMAN_TraceTypeDef trace;
+  FILE *f = fopen(Path, "wb");
+  if ((f == NULL) || (FLASHMAN_GetTrace(&Bench->Handle, &trace) == false) || (fwrite(&trace, sizeof(trace), 1, f) != 1))
+  {
+    fprintf(stderr, "cannot save trace to %s\n", Path);
+  }
+  if (f != NULL)
+  {
+    fclose(f);
+  }
+#else
+  (void)Bench;
+  fprintf(stderr, "trace not saved to %s, build with CONFIG=-DFLASHMAN_TRACE=FLASHMAN_TRACE_ENABLE\n", Path);
+#endif
+}
+
+int main(int argc, char **argv)
+{
+  static BENCH_TypeDef bench;
+  static const uint32_t readSizes[] = {16, 64, 256, 1024, 4096, 32768, 65536};
+  uint32_t sizeCode = FLASHMAN_SIZE_128MBIT, divider = 4, pclk = FLASHEMU_PCLK_HZ, overhead = 2000, seed = 1, prescaler = 0;
+  const char *tracePath = NULL;
+  int opt;
+
+  bench.Ops = 1000;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    opt = argv[i][1];
+    uint32_t value = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+    switch (opt)
+    {
+    case 's': sizeCode = value; break;
+    case 'p': divider = value; break;
+    case 'c': pclk = value; break;
+    case 'o': overhead = value; break;
+    case 'n': bench.Ops = (argv[i + 1][0] == '-') ? 0 : value; break;
+    case 'r': seed = value; break;
+    case 't': tracePath = argv[i + 1]; break;
+    default:
+      fprintf(stderr, "unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+  if (bench.Ops == 0)
+  {
+    fprintf(stderr, "bad option\n");
+    return 2;
+  }
+  while ((2U << (prescaler >> 3)) < divider)
+  {
+    prescaler += SPI_BAUDRATEPRESCALER_4 - SPI_BAUDRATEPRESCALER_2;
+  }
+  srand(seed);
+  FLASHEMU_SpiInit(&bench.Spi, pclk, prescaler);
+  bench.Spi.CallOverheadNs = overhead;
+  if ((FLASHEMU_Open(&bench.Device, NULL, FLASHMAN_MANUF_WINBOND, 0x40, (uint8_t)sizeCode) == false) ||
+      (FLASHEMU_Attach(&bench.Device, &bench.Spi, &bench.Gpio, BENCH_GPIO_PIN) == false))
+  {
+    fprintf(stderr, "emulated chip setup failed\n");
+    return 1;
+  }
+  /* an image header for the clock calibration to read back */
+  for (uint32_t i = 0; i < FLASHMAN_PAGE_SIZE; i++)
+  {
+    bench.Device.Array[i] = (uint8_t)(i * 37 + (i >> 3));
+  }
+  if (FLASHMAN_Init(&bench.Handle, &bench.Spi, &bench.Gpio, BENCH_GPIO_PIN) == false)
+  {
+    fprintf(stderr, "emulated chip setup failed\n");
+    return 1;
+  }
+  FLASHEMU_SpiInit(&bench.Spi2, pclk, prescaler);
+  bench.Spi2.CallOverheadNs = overhead;
+  if ((FLASHEMU_Open(&bench.Device2, NULL, FLASHMAN_MANUF_WINBOND, 0x40, (uint8_t)sizeCode) == false) ||
+      (FLASHEMU_Attach(&bench.Device2, &bench.Spi2, &bench.Gpio2, BENCH_GPIO_PIN) == false) ||
+      (FLASHMAN_Init(&bench.Handle2, &bench.Spi2, &bench.Gpio2, BENCH_GPIO_PIN) == false))
+  {
+    fprintf(stderr, "emulated chip setup failed\n");
+    return 1;
+  }
+  bench.Latency = calloc((size_t)bench.Ops + 1, sizeof(uint64_t));
+  bench.Buffer = malloc(FLASHMAN_BLOCK_SIZE);
+  if ((bench.Latency == NULL) || (bench.Buffer == NULL))
+  {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  for (uint32_t i = 0; i < FLASHMAN_BLOCK_SIZE; i++)
+  {
+    bench.Buffer[i] = (uint8_t)rand();
+  }
+  bench.First = true;
+
+  printf("{\n  \"tool\": \"flashman_bench\",\n  \"format\": 1,\n");
+  printf("  \"config\": {\"size_code\": %u, \"spi_hz\": %u, \"call_overhead_ns\": %u, \"ops\": %u, \"seed\": %u, "
+         "\"page_program_us\": %u, \"sector_erase_us\": %u, \"block_erase_us\": %u},\n",
+         sizeCode, FLASHEMU_SpiHz(&bench.Spi), overhead, bench.Ops, seed,
+         bench.Device.Timing.PageProgramUs, bench.Device.Timing.SectorEraseUs, bench.Device.Timing.BlockEraseUs);
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_ENABLE
+  printf("  \"calibration\": {\"read_spi_hz\": %u, \"cmd_spi_hz\": %u, \"read_max_hz\": %u, \"cmd_max_hz\": %u},\n",
+         pclk >> (1 + (bench.Handle.ReadPrescaler >> 3)), pclk >> (1 + (bench.Handle.CmdPrescaler >> 3)),
+         bench.Device.Timing.ReadMaxHz, bench.Device.Timing.MaxHz);
+#endif
+  printf("  \"results\": [\n");
+  for (size_t i = 0; i < sizeof(readSizes) / sizeof(readSizes[0]); i++)
+  {
+    BENCH_Run(&bench, BENCH_READ_SEQ, readSizes[i]);
+  }
+  for (size_t i = 0; i < sizeof(readSizes) / sizeof(readSizes[0]); i++)
+  {
+    BENCH_Run(&bench, BENCH_READ_RANDOM, readSizes[i]);
+  }
+  BENCH_Run(&bench, BENCH_WRITE_PAGE, FLASHMAN_PAGE_SIZE);
+  BENCH_Run(&bench, BENCH_WRITE_SECTOR, FLASHMAN_SECTOR_SIZE);
+  BENCH_Run(&bench, BENCH_WRITE_BLOCK, FLASHMAN_BLOCK_SIZE);
+  BENCH_Run(&bench, BENCH_ERASE_SECTOR, FLASHMAN_SECTOR_SIZE);
+  BENCH_Run(&bench, BENCH_ERASE_BLOCK, FLASHMAN_BLOCK_SIZE);
+  BENCH_Run(&bench, BENCH_ERASE_CHIP, (uint32_t)bench.Device.Size);
+  BENCH_Run(&bench, BENCH_WRITE_RECORD, 16);
+  BENCH_Run(&bench, BENCH_WRITE_RECORD, 32);
+  BENCH_Run(&bench, BENCH_COMPARE, FLASHMAN_SECTOR_SIZE);
+  BENCH_Run(&bench, BENCH_COMPARE, FLASHMAN_BLOCK_SIZE);
+  BENCH_Run(&bench, BENCH_CHECKSUM, FLASHMAN_BLOCK_SIZE);
+  BENCH_Run(&bench, BENCH_MIXED, 32);
+  BENCH_Run(&bench, BENCH_MIXED, FLASHMAN_PAGE_SIZE);
+  BENCH_Stripe(&bench);
+  BENCH_Mirror(&bench);
+  BENCH_Lz(&bench);
+  BENCH_Ota(&bench);
+  BENCH_Decode(&bench);
+  BENCH_Copy(&bench);
+  BENCH_Image(&bench);
+  BENCH_Pool(&bench);
+  BENCH_Boot(&bench);
+  BENCH_Counter(&bench);
+#if FLASHMAN_FS == FLASHMAN_FS_LITTLEFS
+  BENCH_Lfs(&bench);
+#endif
+  printf("\n  ]");
+  if (bench.LzStored != 0)
+  {
+    printf(",\n  \"lz\": {\"raw_bytes\": %u, \"flash_bytes\": %u, \"ratio\": %.2f}",
+           bench.LzRaw, bench.LzStored, (double)bench.LzRaw / bench.LzStored);
+  }
+  if (bench.Pool[0].Takes != 0)
+  {
+    printf(",\n  \"pool\": [");
+    for (uint32_t i = 0; i < 2; i++)
+    {
+      printf("%s{\"name\": \"%s\", \"target\": %u, \"takes\": %u, \"starved\": %u, \"empty\": %u, \"low_water\": %u, \"erases\": %u}",
+             (i > 0) ? ", " : "", (i == 0) ? "log_pool" : "log_pool_burst", bench.Pool[i].Target, bench.Pool[i].Takes,
+             bench.Pool[i].Starved, bench.Pool[i].Empty, bench.Pool[i].LowWater, bench.Pool[i].Erases);
+    }
+    printf("]");
+  }
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+  BENCH_Stats(&bench);
+#endif
+  printf("\n}\n");
+  if (tracePath != NULL)
+  {
+    BENCH_Trace(&bench, tracePath);
+  }
+
+  free(bench.Latency);
+  free(bench.Buffer);
+  FLASHEMU_Close(&bench.Device);
+  FLASHEMU_Close(&bench.Device2);
+  return 0;
+}
@@ -0,0 +1,738 @@
+#include "SPI_Flash_Emulator.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static _Thread_local uint64_t FLASHEMU_Now;
+static uint32_t FLASHEMU_Serial;
+
+static uint64_t FLASHEMU_SizeFromCode(uint8_t SizeCode);
+static uint8_t  FLASHEMU_AddressLength(FLASHEMU_DeviceTypeDef *Device, uint8_t Cmd);
+static uint8_t  FLASHEMU_Status1(FLASHEMU_DeviceTypeDef *Device);
+static uint8_t  FLASHEMU_Sfdp(FLASHEMU_DeviceTypeDef *Device, uint32_t Address);
+static void     FLASHEMU_Busy(FLASHEMU_DeviceTypeDef *Device, uint64_t Us);
+static void     FLASHEMU_Begin(FLASHEMU_DeviceTypeDef *Device);
+static uint8_t  FLASHEMU_Byte(FLASHEMU_DeviceTypeDef *Device, uint8_t Mosi);
+static void     FLASHEMU_End(FLASHEMU_DeviceTypeDef *Device);
+static void     FLASHEMU_Erase(FLASHEMU_DeviceTypeDef *Device, uint32_t Size, uint64_t Us);
+static void     FLASHEMU_Program(FLASHEMU_DeviceTypeDef *Device);
+static HAL_StatusTypeDef FLASHEMU_Transfer(SPI_HandleTypeDef *hspi, uint8_t *Tx, uint8_t *Rx, uint16_t Size, bool Dma);
+static void     FLASHEMU_DmaDone(SPI_HandleTypeDef *hspi);
+
+static uint64_t FLASHEMU_SizeFromCode(uint8_t SizeCode)
+{
+  if ((SizeCode >= FLASHMAN_SIZE_1MBIT) && (SizeCode <= FLASHMAN_SIZE_256MBIT))
+  {
+    return 1ULL << SizeCode;
+  }
+  if (SizeCode == FLASHMAN_SIZE_512MBIT)
+  {
+    return 1ULL << 26;
+  }
+  return 0;
+}
+
+static uint8_t FLASHEMU_AddressLength(FLASHEMU_DeviceTypeDef *Device, uint8_t Cmd)
+{
+  switch (Cmd)
+  {
+  case FLASHMAN_CMD_PAGEPROG4ADD:
+  case FLASHMAN_CMD_READDATA4ADD:
+  case FLASHMAN_CMD_FASTREAD4ADD:
+  case FLASHMAN_CMD_SECTORERASE4ADD:
+  case FLASHMAN_CMD_BLOCKERASE4ADD:
+    return 4;
+  case FLASHMAN_CMD_PAGEPROG3ADD:
+  case FLASHMAN_CMD_READDATA3ADD:
+  case FLASHMAN_CMD_FASTREAD3ADD:
+  case FLASHMAN_CMD_SECTORERASE3ADD:
+  case FLASHMAN_CMD_BLOCKERASE3ADD:
+    return Device->Addr4Byte ? 4 : 3;
+  case FLASHMAN_CMD_READSFDP:
+    return 3;
+  default:
+    return 0;
+  }
+}
+
+static uint8_t FLASHEMU_Status1(FLASHEMU_DeviceTypeDef *Device)
+{
+  uint8_t status = Device->Status[0];
+  if (FLASHEMU_Now < Device->BusyUntil)
+  {
+    /* WEL stays set until the operation completes */
+    status |= FLASHMAN_STATUS1_BUSY | FLASHMAN_STATUS1_WEL;
+  }
+  return status;
+}
+
+/* minimal JESD216 table: signature, one basic parameter header, 16 dword basic table */
+static uint8_t FLASHEMU_Sfdp(FLASHEMU_DeviceTypeDef *Device, uint32_t Address)
+{
+  static const uint8_t header[16] = {'S', 'F', 'D', 'P', 0x06, 0x01, 0x00, 0xFF,
+                                     0x00, 0x06, 0x01, 0x10, 0x30, 0x00, 0x00, 0xFF};
+  uint32_t dword = 0xFFFFFFFF;
+  if (Address < sizeof(header))
+  {
+    return header[Address];
+  }
+  if ((Address < 0x30) || (Address >= 0x70))
+  {
+    return 0xFF;
+  }
+  switch ((Address - 0x30) / 4)
+  {
+  case 0:
+    dword = 0xFF0000E5 | (FLASHMAN_CMD_SECTORERASE3ADD << 8) | ((Device->Size > (1 << 24)) ? (1 << 17) : 0);
+    break;
+  case 1:
+    dword = (uint32_t)(Device->Size * 8 - 1);
+    break;
+  case 7:
+    dword = 0x0C | (FLASHMAN_CMD_SECTORERASE3ADD << 8) | (0x10 << 16) | ((uint32_t)FLASHMAN_CMD_BLOCKERASE3ADD << 24);
+    break;
+  case 8:
+    dword = 0x00000000;
+    break;
+  case 10:
+    dword = 0xFFFFFF8F;
+    break;
+  default:
+    break;
+  }
+  return (dword >> (8 * ((Address - 0x30) % 4))) & 0xFF;
+}
+
+static void FLASHEMU_Busy(FLASHEMU_DeviceTypeDef *Device, uint64_t Us)
+{
+  Device->BusyUntil = FLASHEMU_Now + Us * 1000;
+  Device->Status[0] &= ~FLASHMAN_STATUS1_WEL;
+}
+
+static void FLASHEMU_Begin(FLASHEMU_DeviceTypeDef *Device)
+{
+  Device->Selected = true;
+  Device->Ignore = false;
+  Device->FrameStart = FLASHEMU_Now;
+  Device->Pos = 0;
+  Device->Address = 0;
+  Device->Count = 0;
+}
+
+static uint8_t FLASHEMU_Byte(FLASHEMU_DeviceTypeDef *Device, uint8_t Mosi)
+{
+  uint32_t pos = Device->Pos++;
+  uint8_t addressLength;
+  uint8_t miso = 0xFF;
+
+  Device->Stats.Bytes++;
+  if (pos == 0)
+  {
+    Device->Cmd = Mosi;
+    Device->Stats.Frames++;
+    if (Device->PowerDown && (Mosi != FLASHMAN_CMD_RELEASE))
+    {
+      Device->Ignore = true;
+    }
+    else if ((FLASHEMU_Now < Device->BusyUntil) && (Mosi != FLASHMAN_CMD_READSTATUS1) && (Mosi != FLASHMAN_CMD_READSTATUS2) &&
+             (Mosi != FLASHMAN_CMD_READSTATUS3) && (Mosi != FLASHMAN_CMD_SUSPEND))
+    {
+      Device->Ignore = true;
+      Device->Stats.IgnoredBusy++;
+    }
+    if (Mosi == FLASHMAN_CMD_READSTATUS1)
+    {
+      Device->Stats.StatusPolls++;
+    }
+    return miso;
+  }
+  if (Device->Ignore)
+  {
+    return miso;
+  }
+  addressLength = FLASHEMU_AddressLength(Device, Device->Cmd);
+  if (pos <= addressLength)
+  {
+    Device->Address = (Device->Address << 8) | Mosi;
+    return miso;
+  }
+  switch (Device->Cmd)
+  {
+  case FLASHMAN_CMD_READSTATUS1:
+    miso = FLASHEMU_Status1(Device);
+    break;
+  case FLASHMAN_CMD_READSTATUS2:
+    miso = Device->Status[1];
+    break;
+  case FLASHMAN_CMD_READSTATUS3:
+    miso = Device->Status[2];
+    break;
+  case FLASHMAN_CMD_JEDECID:
+    miso = Device->Id[(pos - 1) % 3];
+    break;
+  case FLASHMAN_CMD_ID:
+    if (pos > 3)
+    {
+      miso = ((pos - 4) % 2 == 0) ? Device->Id[0] : (uint8_t)(Device->Id[2] - 1);
+    }
+    break;
+  case FLASHMAN_CMD_RELEASE:
+    if (pos > 3)
+    {
+      miso = (uint8_t)(Device->Id[2] - 1);
+    }
+    break;
+  case FLASHMAN_CMD_UNIQUEID:
+    if (pos > 4)
+    {
+      miso = Device->UniqueId[(pos - 5) % 8];
+    }
+    break;
+  case FLASHMAN_CMD_FRAMSERNO:
+    miso = Device->UniqueId[(pos - 1) % 8];
+    break;
+  case FLASHMAN_CMD_READSFDP:
+    if (pos > (uint32_t)addressLength + 1)
+    {
+      miso = FLASHEMU_Sfdp(Device, Device->Address + Device->Count++);
+    }
+    break;
+  case FLASHMAN_CMD_READDATA3ADD:
+  case FLASHMAN_CMD_READDATA4ADD:
+    miso = Device->Array[(Device->Address + Device->Count++) % Device->Size];
+    break;
+  case FLASHMAN_CMD_FASTREAD3ADD:
+  case FLASHMAN_CMD_FASTREAD4ADD:
+    if (pos > (uint32_t)addressLength + 1)
+    {
+      miso = Device->Array[(Device->Address + Device->Count++) % Device->Size];
+    }
+    break;
+  case FLASHMAN_CMD_PAGEPROG3ADD:
+  case FLASHMAN_CMD_PAGEPROG4ADD:
+  {
+    /* the page buffer wraps, only the last FLASHMAN_PAGE_SIZE bytes are kept */
+    uint32_t offset = (Device->Address + Device->Count++) % FLASHMAN_PAGE_SIZE;
+    Device->Page[offset] = Mosi;
+    Device->Mask[offset] = 1;
+    break;
+  }
+  case FLASHMAN_CMD_WRITESTATUS1:
+  case FLASHMAN_CMD_WRITESTATUS2:
+  case FLASHMAN_CMD_WRITESTATUS3:
+    if (pos == 1)
+    {
+      Device->Page[0] = Mosi;
+      Device->Count = 1;
+    }
+    break;
+  default:
+    break;
+  }
+  return miso;
+}
+
+static void FLASHEMU_Erase(FLASHEMU_DeviceTypeDef *Device, uint32_t Size, uint64_t Us)
+{
+  uint64_t address = (Device->Address % Device->Size) & ~(uint64_t)(Size - 1);
+  memset(&Device->Array[address], 0xFF, Size);
+  FLASHEMU_Busy(Device, Us);
+}
+
+static void FLASHEMU_Program(FLASHEMU_DeviceTypeDef *Device)
+{
+  uint64_t base = (Device->Address % Device->Size) & ~(uint64_t)(FLASHMAN_PAGE_SIZE - 1);
+  for (uint32_t i = 0; i < FLASHMAN_PAGE_SIZE; i++)
+  {
+    if (Device->Mask[i])
+    {
+      uint8_t old = Device->Array[base + i];
+      if (Device->Page[i] & ~old)
+      {
+        Device->Stats.ProgramViolations++;
+      }
+      /* NOR only clears bits */
+      Device->Array[base + i] = old & Device->Page[i];
+      Device->Stats.ProgramBytes++;
+    }
+  }
+  Device->Stats.Programs++;
+  FLASHEMU_Busy(Device, Device->Timing.PageProgramUs);
+}
+
+static void FLASHEMU_End(FLASHEMU_DeviceTypeDef *Device)
+{
+  bool wel = (Device->Status[0] & FLASHMAN_STATUS1_WEL) != 0;
+  uint8_t addressLength = FLASHEMU_AddressLength(Device, Device->Cmd);
+
+  Device->Selected = false;
+  if (Device->Pos != 0)
+  {
+    if (Device->LogCnt < Device->LogSize)
+    {
+      FLASHEMU_FrameTypeDef *frame = &Device->Log[Device->LogCnt];
+      frame->StartNs = Device->FrameStart;
+      frame->Address = (addressLength != 0) && (Device->Pos > addressLength) ? Device->Address : 0;
+      frame->Bytes = Device->Pos;
+      frame->Cmd = Device->Cmd;
+    }
+    Device->LogCnt++;
+  }
+  if (Device->Ignore || (Device->Pos == 0))
+  {
+    return;
+  }
+  switch (Device->Cmd)
+  {
+  case FLASHMAN_CMD_WRITEENABLE:
+    Device->Status[0] |= FLASHMAN_STATUS1_WEL;
+    break;
+  case FLASHMAN_CMD_WRITEDISABLE:
+    Device->Status[0] &= ~FLASHMAN_STATUS1_WEL;
+    Device->VolatileWrite = false;
+    break;
+  case FLASHMAN_CMD_WRITESTATUSEN:
+    Device->VolatileWrite = true;
+    break;
+  case FLASHMAN_CMD_WRITESTATUS1:
+  case FLASHMAN_CMD_WRITESTATUS2:
+  case FLASHMAN_CMD_WRITESTATUS3:
+    if ((Device->Count == 0) || ((wel == false) && (Device->VolatileWrite == false)))
+    {
+      Device->Stats.WelErrors++;
+      break;
+    }
+    if (Device->Cmd == FLASHMAN_CMD_WRITESTATUS1)
+    {
+      Device->Status[0] = (Device->Status[0] & (FLASHMAN_STATUS1_BUSY | FLASHMAN_STATUS1_WEL)) |
+                          (Device->Page[0] & ~(FLASHMAN_STATUS1_BUSY | FLASHMAN_STATUS1_WEL));
+    }
+    else if (Device->Cmd == FLASHMAN_CMD_WRITESTATUS2)
+    {
+      Device->Status[1] = (Device->Status[1] & FLASHMAN_STATUS2_SUS) | (Device->Page[0] & ~FLASHMAN_STATUS2_SUS);
+    }
+    else
+    {
+      Device->Status[2] = Device->Page[0];
+    }
+    if (Device->VolatileWrite)
+    {
+      Device->VolatileWrite = false;
+    }
+    else
+    {
+      FLASHEMU_Busy(Device, Device->Timing.StatusWriteUs);
+    }
+    break;
+  case FLASHMAN_CMD_PAGEPROG3ADD:
+  case FLASHMAN_CMD_PAGEPROG4ADD:
+    if (wel == false)
+    {
+      Device->Stats.WelErrors++;
+    }
+    else if (Device->Count > 0)
+    {
+      FLASHEMU_Program(Device);
+    }
+    memset(Device->Mask, 0, sizeof(Device->Mask));
+    break;
+  case FLASHMAN_CMD_SECTORERASE3ADD:
+  case FLASHMAN_CMD_SECTORERASE4ADD:
+  case FLASHMAN_CMD_BLOCKERASE3ADD:
+  case FLASHMAN_CMD_BLOCKERASE4ADD:
+    if (Device->Pos < (uint32_t)addressLength + 1)
+    {
+      break;
+    }
+    if (wel == false)
+    {
+      Device->Stats.WelErrors++;
+    }
+    else if ((Device->Cmd == FLASHMAN_CMD_SECTORERASE3ADD) || (Device->Cmd == FLASHMAN_CMD_SECTORERASE4ADD))
+    {
+      Device->Stats.SectorErases++;
+      FLASHEMU_Erase(Device, FLASHMAN_SECTOR_SIZE, Device->Timing.SectorEraseUs);
+    }
+    else
+    {
+      Device->Stats.BlockErases++;
+      FLASHEMU_Erase(Device, FLASHMAN_BLOCK_SIZE, Device->Timing.BlockEraseUs);
+    }
+    break;
+  case FLASHMAN_CMD_CHIPERASE1:
+  case FLASHMAN_CMD_CHIPERASE2:
+    if (wel == false)
+    {
+      Device->Stats.WelErrors++;
+      break;
+    }
+    Device->Stats.ChipErases++;
+    memset(Device->Array, 0xFF, Device->Size);
+    if (Device->Timing.ChipEraseUs)
+    {
+      FLASHEMU_Busy(Device, Device->Timing.ChipEraseUs);
+    }
+    else
+    {
+      FLASHEMU_Busy(Device, (Device->Size / FLASHMAN_BLOCK_SIZE) * Device->Timing.BlockEraseUs);
+    }
+    break;
+  case FLASHMAN_CMD_ADDR4BYTE_EN:
+    Device->Addr4Byte = true;
+    break;
+  case FLASHMAN_CMD_ADDR4BYTE_DIS:
+    Device->Addr4Byte = false;
+    break;
+  case FLASHMAN_CMD_SUSPEND:
+    if (FLASHEMU_Now < Device->BusyUntil)
+    {
+      Device->SuspendLeft = Device->BusyUntil - FLASHEMU_Now;
+      Device->BusyUntil = FLASHEMU_Now + (uint64_t)Device->Timing.SuspendUs * 1000;
+      Device->Status[1] |= FLASHMAN_STATUS2_SUS;
+    }
+    break;
+  case FLASHMAN_CMD_RESUME:
+    if (Device->Status[1] & FLASHMAN_STATUS2_SUS)
+    {
+      Device->BusyUntil = FLASHEMU_Now + Device->SuspendLeft;
+      Device->Status[1] &= ~FLASHMAN_STATUS2_SUS;
+    }
+    break;
+  case FLASHMAN_CMD_POWERDOWN:
+    Device->PowerDown = true;
+    break;
+  case FLASHMAN_CMD_RELEASE:
+    Device->PowerDown = false;
+    Device->BusyUntil = FLASHEMU_Now + (uint64_t)Device->Timing.ReleaseUs * 1000;
+    break;
+  default:
+    break;
+  }
+}
+
+/* the bytes move at once, only the clock sees a DMA transfer running in the background */
+static HAL_StatusTypeDef FLASHEMU_Transfer(SPI_HandleTypeDef *hspi, uint8_t *Tx, uint8_t *Rx, uint16_t Size, bool Dma)
+{
+  uint64_t ns;
+  uint32_t hz, limit;
+  uint8_t out;
+  if ((hspi == NULL) || (Size == 0))
+  {
+    return HAL_ERROR;
+  }
+  hz = FLASHEMU_SpiHz(hspi);
+  FLASHEMU_DmaDone(hspi);
+  for (uint16_t i = 0; i < Size; i++)
+  {
+    uint8_t mosi = (Tx != NULL) ? Tx[i] : 0xFF;
+    uint8_t miso = 0xFF;
+    for (FLASHEMU_DeviceTypeDef *device = hspi->Devices; device != NULL; device = device->Next)
+    {
+      if (device->Selected)
+      {
+        out = FLASHEMU_Byte(device, mosi);
+        limit = ((device->Cmd == FLASHMAN_CMD_READDATA3ADD) || (device->Cmd == FLASHMAN_CMD_READDATA4ADD)) ?
+                device->Timing.ReadMaxHz : device->Timing.MaxHz;
+        /* too fast for the part, every bit arrives one clock late */
+        if ((limit != 0) && (hz > limit))
+        {
+          out = (uint8_t)((out >> 1) | 0x80);
+        }
+        miso &= out;
+      }
+    }
+    if (Rx != NULL)
+    {
+      Rx[i] = miso;
+    }
+  }
+  ns = ((uint64_t)Size * 8000000000ULL) / hz;
+  hspi->Calls++;
+  hspi->Bytes += Size;
+  hspi->BusNs += ns;
+  FLASHEMU_Now += hspi->CallOverheadNs;
+  if (Dma)
+  {
+    hspi->DmaUntil = FLASHEMU_Now + ns;
+  }
+  else
+  {
+    FLASHEMU_Now += ns;
+  }
+  return HAL_OK;
+}
+
+/* the CPU waits for a running DMA transfer */
+static void FLASHEMU_DmaDone(SPI_HandleTypeDef *hspi)
+{
+  if (FLASHEMU_Now < hspi->DmaUntil)
+  {
+    FLASHEMU_Now = hspi->DmaUntil;
+  }
+}
+
+/**
+  * @brief  Fill a timing model with typical values of a 3.3 V W25Q-class part
+  *
+  * @param  *Timing: Pointer to FLASHEMU_TimingTypeDef structure
+  */
+void FLASHEMU_Timing(FLASHEMU_TimingTypeDef *Timing)
+{
+  Timing->PageProgramUs = 400;
+  Timing->SectorEraseUs = 45000;
+  Timing->BlockEraseUs = 150000;
+  Timing->ChipEraseUs = 0;
+  Timing->StatusWriteUs = 10000;
+  Timing->SuspendUs = 20;
+  Timing->ReleaseUs = 3;
+  Timing->MaxHz = 133000000;
+  Timing->ReadMaxHz = 50000000;
+}
+
+/**
+  * @brief  Create an emulated chip.
+  * @note   The array is an mmap'ed file, so existing images load without copying.
+  *         A new or short file is extended and the new part filled with 0xFF.
+  *
+  * @param  *Device: Pointer to FLASHEMU_DeviceTypeDef structure
+  * @param  *Path: Image file, NULL for an anonymous (RAM only) chip
+  * @param  Manuf, MemType, SizeCode: JEDEC ID returned by the chip
+  *
+  * @retval bool: true or false
+  */
+bool FLASHEMU_Open(FLASHEMU_DeviceTypeDef *Device, const char *Path, uint8_t Manuf, uint8_t MemType, uint8_t SizeCode)
+{
+  uint64_t size = FLASHEMU_SizeFromCode(SizeCode);
+  uint64_t filled = 0;
+  struct stat st;
+  void *map;
+
+  if ((Device == NULL) || (size == 0))
+  {
+    return false;
+  }
+  memset(Device, 0, sizeof(FLASHEMU_DeviceTypeDef));
+  Device->Fd = -1;
+  if (Path != NULL)
+  {
+    Device->Fd = open(Path, O_RDWR | O_CREAT, 0644);
+    if ((Device->Fd < 0) || (fstat(Device->Fd, &st) != 0))
+    {
+      FLASHEMU_Close(Device);
+      return false;
+    }
+    filled = ((uint64_t)st.st_size < size) ? (uint64_t)st.st_size : size;
+    if (((uint64_t)st.st_size < size) && (ftruncate(Device->Fd, (off_t)size) != 0))
+    {
+      FLASHEMU_Close(Device);
+      return false;
+    }
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, Device->Fd, 0);
+  }
+  else
+  {
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (map == MAP_FAILED)
+  {
+    FLASHEMU_Close(Device);
+    return false;
+  }
+  Device->Array = map;
+  Device->Size = size;
+  if (filled < size)
+  {
+    memset(&Device->Array[filled], 0xFF, size - filled);
+  }
+  Device->Id[0] = Manuf;
+  Device->Id[1] = MemType;
+  Device->Id[2] = SizeCode;
+  FLASHEMU_Serial++;
+  for (int i = 0; i < 8; i++)
+  {
+    Device->UniqueId[i] = (uint8_t)((FLASHEMU_Serial * 0x9E3779B1U) >> (i * 4));
+  }
+  FLASHEMU_Timing(&Device->Timing);
+  return true;
+}
+
+/**
+  * @brief  Unmap the array and close the image file
+  *
+  * @param  *Device: Pointer to FLASHEMU_DeviceTypeDef structure
+  */
+void FLASHEMU_Close(FLASHEMU_DeviceTypeDef *Device)
+{
+  if (Device->Array != NULL)
+  {
+    munmap(Device->Array, Device->Size);
+    Device->Array = NULL;
+  }
+  if (Device->Fd >= 0)
+  {
+    close(Device->Fd);
+    Device->Fd = -1;
+  }
+}
+
+/**
+  * @brief  Set up an emulated SPI bus
+  * @note   SCK = PclkHz / prescaler, CallOverheadNs models the HAL/DMA setup of each call
+  *
+  * @param  *hspi: Pointer to SPI_HandleTypeDef structure
+  * @param  PclkHz: Peripheral clock
+  * @param  Prescaler: SPI_BAUDRATEPRESCALER_x
+  */
+void FLASHEMU_SpiInit(SPI_HandleTypeDef *hspi, uint32_t PclkHz, uint32_t Prescaler)
+{
+  memset(hspi, 0, sizeof(SPI_HandleTypeDef));
+  hspi->PclkHz = PclkHz;
+  hspi->Init.BaudRatePrescaler = Prescaler;
+  hspi->CallOverheadNs = 2000;
+}
+
+/**
+  * @brief  Connect an emulated chip to a bus and a CS pin
+  *
+  * @param  *Device: Pointer to an opened FLASHEMU_DeviceTypeDef structure
+  * @param  *hspi: Bus
+  * @param  *gpio: CS port
+  * @param  Pin: CS pin (a single GPIO_PIN_x bit)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHEMU_Attach(FLASHEMU_DeviceTypeDef *Device, SPI_HandleTypeDef *hspi, GPIO_TypeDef *gpio, uint16_t Pin)
+{
+  if ((Device == NULL) || (hspi == NULL) || (gpio == NULL) || (Pin == 0) || (Pin & (Pin - 1)))
+  {
+    return false;
+  }
+  Device->hspi = hspi;
+  Device->Next = hspi->Devices;
+  hspi->Devices = Device;
+  gpio->Pins[__builtin_ctz(Pin)] = Device;
+  return true;
+}
+
+uint32_t FLASHEMU_SpiHz(SPI_HandleTypeDef *hspi)
+{
+  return hspi->PclkHz >> (1 + (hspi->Init.BaudRatePrescaler >> 3));
+}
+
+uint64_t FLASHEMU_GetTimeNs(void)
+{
+  return FLASHEMU_Now;
+}
+
+void FLASHEMU_SetTimeNs(uint64_t Now)
+{
+  FLASHEMU_Now = Now;
+}
+
+void FLASHEMU_Advance(uint64_t Ns)
+{
+  FLASHEMU_Now += Ns;
+}
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi)
+{
+  if (hspi == NULL)
+  {
+    return HAL_ERROR;
+  }
+  /* the new prescaler is picked up by the next transfer */
+  FLASHEMU_DmaDone(hspi);
+  FLASHEMU_Now += hspi->CallOverheadNs;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+  (void)Timeout;
+  return FLASHEMU_Transfer(hspi, pData, NULL, Size, false);
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+  (void)Timeout;
+  return FLASHEMU_Transfer(hspi, NULL, pData, Size, false);
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size, uint32_t Timeout)
+{
+  (void)Timeout;
+  return FLASHEMU_Transfer(hspi, pTxData, pRxData, Size, false);
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size)
+{
+  return FLASHEMU_Transfer(hspi, pData, NULL, Size, true);
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size)
+{
+  return FLASHEMU_Transfer(hspi, NULL, pData, Size, true);
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size)
+{
+  return FLASHEMU_Transfer(hspi, pTxData, pRxData, Size, true);
+}
+
+HAL_StatusTypeDef HAL_SPI_DMAStop(SPI_HandleTypeDef *hspi)
+{
+  hspi->DmaUntil = FLASHEMU_Now;
+  return HAL_OK;
+}
+
+HAL_SPI_StateTypeDef HAL_SPI_GetState(SPI_HandleTypeDef *hspi)
+{
+  /* polled in a loop by the driver, so it can as well return once the transfer is over */
+  FLASHEMU_DmaDone(hspi);
+  return HAL_SPI_STATE_READY;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+  for (int i = 0; i < FLASHEMU_PINS; i++)
+  {
+    if ((GPIO_Pin & (1 << i)) && (GPIOx->Pins[i] != NULL))
+    {
+      FLASHEMU_DmaDone(GPIOx->Pins[i]->hspi);
+    }
+  }
+  for (int i = 0; i < FLASHEMU_PINS; i++)
+  {
+    FLASHEMU_DeviceTypeDef *device = GPIOx->Pins[i];
+    if (((GPIO_Pin & (1 << i)) == 0) || (device == NULL))
+    {
+      continue;
+    }
+    if ((PinState == GPIO_PIN_RESET) && (device->Selected == false))
+    {
+      FLASHEMU_Begin(device);
+    }
+    else if ((PinState == GPIO_PIN_SET) && device->Selected)
+    {
+      FLASHEMU_End(device);
+    }
+  }
+  FLASHEMU_Now += 50;
+}
+
+uint32_t HAL_GetTick(void)
+{
+  return (uint32_t)(FLASHEMU_Now / 1000000);
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+  /* same rounding as the STM32 HAL: at least one full tick more than asked */
+  uint64_t wait = (uint64_t)HAL_GetTick() + Delay + 1;
+  if (FLASHEMU_Now < wait * 1000000)
+  {
+    FLASHEMU_Now = wait * 1000000;
+  }
+}
@@ -0,0 +1,118 @@
+#ifndef _FLASHEMU_H_
+#define _FLASHEMU_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+/*
+ * Software SPI NOR flash for host builds of SPI_Flash_Manager.
+ *
+ *   cc -IHost -I. SPI_Flash_Manager.c Host/SPI_Flash_Emulator.c app.c
+ *
+ * Time is virtual and per thread: SPI bytes advance it by the bus clock, HAL_Delay() by the
+ * requested ticks, and program/erase commands keep the chip BUSY for the configured time.
+ */
+
+#include <stdbool.h>
+#include "spi.h"
+#include "SPI_Flash_Manager.h"
+
+#define FLASHEMU_PCLK_HZ                          84000000
+
+typedef struct
+{
+  uint32_t               PageProgramUs;
+  uint32_t               SectorEraseUs;
+  uint32_t               BlockEraseUs;
+  uint32_t               ChipEraseUs;      /* 0: BlockEraseUs per block */
+  uint32_t               StatusWriteUs;
+  uint32_t               SuspendUs;
+  uint32_t               ReleaseUs;
+  uint32_t               MaxHz;            /* highest SCK, above it MISO is sampled a bit late. 0: no limit */
+  uint32_t               ReadMaxHz;        /* same for READ (0x03/0x13) data */
+
+} FLASHEMU_TimingTypeDef;
+
+typedef struct
+{
+  uint64_t               Frames;
+  uint64_t               Bytes;
+  uint64_t               StatusPolls;
+  uint64_t               Programs;
+  uint64_t               ProgramBytes;
+  uint64_t               SectorErases;
+  uint64_t               BlockErases;
+  uint64_t               ChipErases;
+  uint64_t               ProgramViolations; /* bits asked to go 0 -> 1 by a program */
+  uint64_t               WelErrors;         /* program/erase without write enable */
+  uint64_t               IgnoredBusy;       /* commands dropped while busy */
+
+} FLASHEMU_StatsTypeDef;
+
+/* one CS frame, see FLASHEMU_DeviceTypeDef.Log */
+typedef struct
+{
+  uint64_t               StartNs;
+  uint32_t               Address;          /* 0 for commands without one */
+  uint32_t               Bytes;            /* command, address, dummy and data */
+  uint8_t                Cmd;
+
+} FLASHEMU_FrameTypeDef;
+
+struct FLASHEMU_DeviceTypeDef
+{
+  uint8_t                *Array;
+  uint64_t               Size;
+  int                    Fd;
+  uint8_t                Id[3];
+  uint8_t                UniqueId[8];
+  FLASHEMU_TimingTypeDef Timing;
+  FLASHEMU_StatsTypeDef  Stats;
+  uint8_t                Status[3];
+  bool                   Addr4Byte;
+  bool                   PowerDown;
+  bool                   VolatileWrite;
+  uint64_t               BusyUntil;
+  uint64_t               SuspendLeft;
+  /* current CS frame */
+  bool                   Selected;
+  bool                   Ignore;
+  uint8_t                Cmd;
+  uint32_t               Pos;
+  uint32_t               Address;
+  uint32_t               Count;
+  uint8_t                Page[FLASHMAN_PAGE_SIZE];
+  uint8_t                Mask[FLASHMAN_PAGE_SIZE];
+  uint64_t               FrameStart;
+  /* frame log, set Log/LogSize to record. LogCnt keeps counting once the array is full */
+  FLASHEMU_FrameTypeDef  *Log;
+  uint32_t               LogSize;
+  uint32_t               LogCnt;
+  /* wiring */
+  SPI_HandleTypeDef      *hspi;
+  FLASHEMU_DeviceTypeDef *Next;
+};
+
+void     FLASHEMU_Timing(FLASHEMU_TimingTypeDef *Timing);
+bool     FLASHEMU_Open(FLASHEMU_DeviceTypeDef *Device, const char *Path, uint8_t Manuf, uint8_t MemType, uint8_t SizeCode);
+void     FLASHEMU_Close(FLASHEMU_DeviceTypeDef *Device);
+void     FLASHEMU_SpiInit(SPI_HandleTypeDef *hspi, uint32_t PclkHz, uint32_t Prescaler);
+bool     FLASHEMU_Attach(FLASHEMU_DeviceTypeDef *Device, SPI_HandleTypeDef *hspi, GPIO_TypeDef *gpio, uint16_t Pin);
+uint32_t FLASHEMU_SpiHz(SPI_HandleTypeDef *hspi);
+
+uint64_t FLASHEMU_GetTimeNs(void);
+void     FLASHEMU_SetTimeNs(uint64_t Now);
+void     FLASHEMU_Advance(uint64_t Ns);
+
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+/* spidev stand-in, Host/SPI_Flash_Spidev.c. A SPI_IOC_MESSAGE system call costs this much */
+#define FLASHEMU_SPIDEV_CALL_NS                   20000
+bool     FLASHEMU_SpidevAdd(const char *Path, FLASHEMU_DeviceTypeDef *Device);
+#endif
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHEMU_H_
@@ -0,0 +1,272 @@
+#include "SPI_Flash_Gang.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct
+{
+  FLASHGANG_TypeDef      *Gang;
+  uint32_t               Index;
+  pthread_t              Thread;
+
+} FLASHGANG_WorkerTypeDef;
+
+static uint64_t FLASHGANG_Monotonic(void);
+static void     FLASHGANG_Enter(FLASHGANG_TypeDef *Gang, FLASHGANG_DeviceTypeDef *Device, FLASHGANG_StateTypeDef State, uint64_t *Start);
+static bool     FLASHGANG_Erase(FLASHGANG_TypeDef *Gang, FLASHGANG_DeviceTypeDef *Device);
+static void     FLASHGANG_Device(FLASHGANG_TypeDef *Gang, FLASHGANG_DeviceTypeDef *Device);
+static void    *FLASHGANG_Worker(void *Arg);
+
+static uint64_t FLASHGANG_Monotonic(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* close the running step of the chip and start the next one */
+static void FLASHGANG_Enter(FLASHGANG_TypeDef *Gang, FLASHGANG_DeviceTypeDef *Device, FLASHGANG_StateTypeDef State, uint64_t *Start)
+{
+  uint64_t now = Gang->Clock();
+  if ((Device->State >= FLASHGANG_INIT) && (Device->State <= FLASHGANG_VERIFY))
+  {
+    Device->StepNs[Device->State - FLASHGANG_INIT] = now - *Start;
+  }
+  *Start = now;
+  Device->Done = 0;
+  Device->State = State;
+}
+
+static bool FLASHGANG_Erase(FLASHGANG_TypeDef *Gang, FLASHGANG_DeviceTypeDef *Device)
+{
+  bool retVal = true;
+  uint32_t address = FLASHMAN_SectorToAddress(FLASHMAN_AddressToSector(Gang->Address)), end = Gang->Address + Gang->Size;
+  switch (Gang->Erase)
+  {
+  case FLASHGANG_ERASE_CHIP:
+    retVal = FLASHMAN_EraseChip(&Device->Handle);
+    Device->Done = Gang->Size;
+    break;
+  case FLASHGANG_ERASE_RANGE:
+    while (retVal && (address < end))
+    {
+      if (((address % FLASHMAN_BLOCK_SIZE) == 0) && (end - address >= FLASHMAN_BLOCK_SIZE))
+      {
+        retVal = FLASHMAN_EraseBlock(&Device->Handle, FLASHMAN_AddressToBlock(address));
+        address += FLASHMAN_BLOCK_SIZE;
+      }
+      else
+      {
+        retVal = FLASHMAN_EraseSector(&Device->Handle, FLASHMAN_AddressToSector(address));
+        address += FLASHMAN_SECTOR_SIZE;
+      }
+      Device->Done = (address < end) ? address - Gang->Address : Gang->Size;
+    }
+    break;
+  default:
+    break;
+  }
+  return retVal;
+}
+
+/* init, erase, program and verify one chip on the calling worker */
+static void FLASHGANG_Device(FLASHGANG_TypeDef *Gang, FLASHGANG_DeviceTypeDef *Device)
+{
+  bool ok;
+  uint32_t length, mismatch;
+  uint64_t start = Gang->Clock();
+
+  Device->StartNs = start;
+  memset(Device->StepNs, 0, sizeof(Device->StepNs));
+  Device->Mismatch = 0;
+  FLASHGANG_Enter(Gang, Device, FLASHGANG_INIT, &start);
+  ok = (Device->Handle.Inited != 0) || FLASHMAN_Init(&Device->Handle, Device->Spi, Device->Gpio, Device->Pin);
+  if (ok && (Gang->Erase != FLASHGANG_ERASE_NONE))
+  {
+    FLASHGANG_Enter(Gang, Device, FLASHGANG_ERASE, &start);
+    ok = FLASHGANG_Erase(Gang, Device);
+  }
+  if (ok)
+  {
+    FLASHGANG_Enter(Gang, Device, FLASHGANG_PROGRAM, &start);
+    for (uint32_t done = 0; ok && (done < Gang->Size); done += length)
+    {
+      length = (Gang->Size - done > FLASHGANG_CHUNK) ? FLASHGANG_CHUNK : Gang->Size - done;
+      ok = FLASHMAN_WriteAddress(&Device->Handle, Gang->Address + done, (uint8_t *)&Gang->Image[done], length);
+      Device->Done = done + length;
+    }
+  }
+  if (ok && Gang->Verify)
+  {
+    FLASHGANG_Enter(Gang, Device, FLASHGANG_VERIFY, &start);
+    for (uint32_t done = 0; ok && (done < Gang->Size); done += length)
+    {
+      length = (Gang->Size - done > FLASHGANG_CHUNK) ? FLASHGANG_CHUNK : Gang->Size - done;
+      ok = FLASHMAN_Compare(&Device->Handle, Gang->Address + done, &Gang->Image[done], length, &mismatch) && (mismatch == length);
+      if (mismatch < length)
+      {
+        Device->Mismatch = done + mismatch;
+      }
+      Device->Done = done + length;
+    }
+  }
+  Device->FailedIn = ok ? FLASHGANG_WAITING : Device->State;
+  FLASHGANG_Enter(Gang, Device, ok ? FLASHGANG_PASSED : FLASHGANG_FAILED, &start);
+  Device->EndNs = start;
+}
+
+static void *FLASHGANG_Worker(void *Arg)
+{
+  FLASHGANG_WorkerTypeDef *worker = (FLASHGANG_WorkerTypeDef *)Arg;
+  FLASHGANG_TypeDef *gang = worker->Gang;
+  for (uint32_t i = worker->Index; i < gang->Cnt; i += gang->Workers)
+  {
+    gang->Devices[i].Worker = worker->Index;
+    FLASHGANG_Device(gang, &gang->Devices[i]);
+    pthread_mutex_lock(&gang->Mutex);
+    gang->Finished++;
+    pthread_cond_signal(&gang->Cond);
+    pthread_mutex_unlock(&gang->Mutex);
+  }
+  return NULL;
+}
+
+/**
+  * @brief  Program the image into every chip and wait for all of them
+  * @note   Worker w handles chips w, w + Workers, .. one after the other, each from init to verify, so
+  *         the run is the same every time. The handles must not be used by anyone else meanwhile.
+  * @note   Progress is called right away, then every ProgressMs of wall time and once at the end.
+  *
+  * @param  *Gang: Pointer to FLASHGANG_TypeDef structure, image and options set, results written
+  * @param  *Devices: Chips, Name, Spi, Gpio and Pin set
+  * @param  Cnt: Number of chips
+  *
+  * @retval bool: true if every chip passed
+  */
+bool FLASHGANG_Run(FLASHGANG_TypeDef *Gang, FLASHGANG_DeviceTypeDef *Devices, uint32_t Cnt)
+{
+  bool retVal = false;
+  uint32_t workers, started = 0;
+  FLASHGANG_WorkerTypeDef *worker = NULL;
+  struct timespec deadline;
+  uint64_t first = UINT64_MAX, last = 0;
+  do
+  {
+    if ((Gang == NULL) || (Devices == NULL) || (Cnt == 0) || (Gang->Image == NULL))
+    {
+      break;
+    }
+    if ((Gang->Workers == 0) || (Gang->Workers > Cnt))
+    {
+      Gang->Workers = Cnt;
+    }
+    workers = Gang->Workers;
+    worker = calloc(workers, sizeof(FLASHGANG_WorkerTypeDef));
+    if (worker == NULL)
+    {
+      break;
+    }
+    if (Gang->Clock == NULL)
+    {
+      Gang->Clock = FLASHGANG_Monotonic;
+    }
+    Gang->Devices = Devices;
+    Gang->Cnt = Cnt;
+    Gang->Finished = 0;
+    for (uint32_t i = 0; i < Cnt; i++)
+    {
+      Devices[i].State = FLASHGANG_WAITING;
+      Devices[i].Done = 0;
+    }
+    pthread_mutex_init(&Gang->Mutex, NULL);
+    pthread_cond_init(&Gang->Cond, NULL);
+    for (; started < workers; started++)
+    {
+      worker[started].Gang = Gang;
+      worker[started].Index = started;
+      if (pthread_create(&worker[started].Thread, NULL, FLASHGANG_Worker, &worker[started]) != 0)
+      {
+        break;
+      }
+    }
+    /* the chips of a worker that did not start stay waiting */
+    pthread_mutex_lock(&Gang->Mutex);
+    for (uint32_t i = started; i < workers; i++)
+    {
+      for (uint32_t j = i; j < Cnt; j += workers)
+      {
+        Gang->Finished++;
+      }
+    }
+    pthread_mutex_unlock(&Gang->Mutex);
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    pthread_mutex_lock(&Gang->Mutex);
+    while (Gang->Finished < Cnt)
+    {
+      if (Gang->Progress == NULL)
+      {
+        pthread_cond_wait(&Gang->Cond, &Gang->Mutex);
+        continue;
+      }
+      if (pthread_cond_timedwait(&Gang->Cond, &Gang->Mutex, &deadline) == ETIMEDOUT)
+      {
+        pthread_mutex_unlock(&Gang->Mutex);
+        Gang->Progress(Gang->Context, Devices, Cnt);
+        pthread_mutex_lock(&Gang->Mutex);
+        deadline.tv_sec += Gang->ProgressMs / 1000;
+        deadline.tv_nsec += (long)(Gang->ProgressMs % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+          deadline.tv_sec++;
+          deadline.tv_nsec -= 1000000000L;
+        }
+      }
+    }
+    pthread_mutex_unlock(&Gang->Mutex);
+    for (uint32_t i = 0; i < started; i++)
+    {
+      pthread_join(worker[i].Thread, NULL);
+    }
+    pthread_cond_destroy(&Gang->Cond);
+    pthread_mutex_destroy(&Gang->Mutex);
+
+    Gang->Passed = 0;
+    Gang->Failed = 0;
+    Gang->SerialNs = 0;
+    for (uint32_t i = 0; i < Cnt; i++)
+    {
+      if (Devices[i].State == FLASHGANG_PASSED)
+      {
+        Gang->Passed++;
+      }
+      else
+      {
+        Gang->Failed++;
+      }
+      /* a chip never taken by a worker has no times */
+      if (Devices[i].State != FLASHGANG_WAITING)
+      {
+        Gang->SerialNs += Devices[i].EndNs - Devices[i].StartNs;
+        first = (Devices[i].StartNs < first) ? Devices[i].StartNs : first;
+        last = (Devices[i].EndNs > last) ? Devices[i].EndNs : last;
+      }
+    }
+    Gang->ElapsedNs = (last > first) ? last - first : 0;
+    if (Gang->Progress != NULL)
+    {
+      Gang->Progress(Gang->Context, Devices, Cnt);
+    }
+    retVal = (Gang->Failed == 0);
+
+  } while (0);
+
+  free(worker);
+  return retVal;
+}
+
+const char *FLASHGANG_StateName(FLASHGANG_StateTypeDef State)
+{
+  static const char *names[] = {"waiting", "init", "erase", "program", "verify", "passed", "failed"};
+  return ((uint32_t)State < sizeof(names) / sizeof(names[0])) ? names[State] : "?";
+}
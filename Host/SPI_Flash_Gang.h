@@ -0,0 +1,105 @@
+#ifndef _FLASHGANG_H_
+#define _FLASHGANG_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+/*
+ * Gang programmer: one image into many chips, each on its own bus and FLASHMAN handle. A pool of
+ * worker threads shares the chips out and runs init, erase, program and verify on each, so a
+ * fixture takes about as long as its slowest chip instead of the sum of all of them.
+ *
+ *   FLASHGANG_DeviceTypeDef socket[2] = {{.Name = "socket0", .Spi = &spi0}, {.Name = "socket1", .Spi = &spi1}};
+ *   FLASHGANG_TypeDef gang = {.Image = image, .Size = size, .Erase = FLASHGANG_ERASE_RANGE, .Verify = true};
+ *   FLASHGANG_Run(&gang, socket, 2);
+ *
+ * On Linux the chips run on FLASHMAN_PLATFORM_LINUX_SPIDEV, Spi opened by FLASHMAN_SpidevOpen() and
+ * Gpio NULL. Host/SPI_Flash_GangTool.c drives emulated chips, whose time is per thread.
+ */
+
+#include <pthread.h>
+#include "SPI_Flash_Manager.h"
+
+/* program and verify go in pieces of this size, the granularity of Done */
+#define FLASHGANG_CHUNK                           4096
+
+typedef enum
+{
+  FLASHGANG_WAITING = 0,
+  FLASHGANG_INIT,
+  FLASHGANG_ERASE,
+  FLASHGANG_PROGRAM,
+  FLASHGANG_VERIFY,
+  FLASHGANG_PASSED,
+  FLASHGANG_FAILED,
+
+} FLASHGANG_StateTypeDef;
+
+#define FLASHGANG_STEPS                           (FLASHGANG_VERIFY - FLASHGANG_INIT + 1)
+
+typedef enum
+{
+  FLASHGANG_ERASE_NONE = 0,
+  FLASHGANG_ERASE_RANGE,                   /* the sectors the image touches, blocks where they fit */
+  FLASHGANG_ERASE_CHIP,
+
+} FLASHGANG_EraseTypeDef;
+
+typedef struct
+{
+  /* set by the caller, a chip that is already initialized is not initialized again */
+  const char             *Name;
+  FLASHMAN_SpiTypeDef    *Spi;
+  FLASHMAN_GpioTypeDef   *Gpio;
+  uint16_t               Pin;
+  FLASHMAN_HandleTypeDef Handle;
+  /* written by the worker that owns the chip */
+  volatile FLASHGANG_StateTypeDef State;
+  volatile uint32_t      Done;             /* bytes of the current step */
+  FLASHGANG_StateTypeDef FailedIn;
+  uint32_t               Mismatch;         /* offset of the first wrong byte if the verify failed */
+  uint32_t               Worker;
+  uint64_t               StartNs;
+  uint64_t               StepNs[FLASHGANG_STEPS];
+  uint64_t               EndNs;
+
+} FLASHGANG_DeviceTypeDef;
+
+/* snapshot of a running gang, State and Done of a chip may be a step behind */
+typedef void (*FLASHGANG_ProgressTypeDef)(void *Context, const FLASHGANG_DeviceTypeDef *Devices, uint32_t Cnt);
+
+typedef struct
+{
+  const uint8_t          *Image;
+  uint32_t               Size;
+  uint32_t               Address;
+  FLASHGANG_EraseTypeDef Erase;
+  bool                   Verify;
+  uint32_t               Workers;          /* 0 or more than the chips: one per chip, set by FLASHGANG_Run() */
+  uint64_t               (*Clock)(void);   /* ns, called by the workers. NULL: CLOCK_MONOTONIC */
+  FLASHGANG_ProgressTypeDef Progress;      /* called from the thread of FLASHGANG_Run(), can be NULL */
+  void                   *Context;
+  uint32_t               ProgressMs;
+  /* results */
+  uint32_t               Passed;
+  uint32_t               Failed;
+  uint64_t               ElapsedNs;        /* first start to last end */
+  uint64_t               SerialNs;         /* sum over the chips, what one chip after the other takes */
+  /* internal */
+  pthread_mutex_t        Mutex;
+  pthread_cond_t         Cond;
+  FLASHGANG_DeviceTypeDef *Devices;
+  uint32_t               Cnt;
+  uint32_t               Finished;
+
+} FLASHGANG_TypeDef;
+
+bool        FLASHGANG_Run(FLASHGANG_TypeDef *Gang, FLASHGANG_DeviceTypeDef *Devices, uint32_t Cnt);
+const char *FLASHGANG_StateName(FLASHGANG_StateTypeDef State);
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHGANG_H_
@@ -0,0 +1,193 @@
+/*
+ * Gang programming of emulated chips, see SPI_Flash_Gang.h.
+ *
+ *   make -C Host gang && Host/build/flashman_gang [options] > result.json
+ *
+ *   -n <chips>   chips in the fixture (default 8)
+ *   -w <workers> worker threads, 0 one per chip (default 0)
+ *   -i <bytes>   image size (default 256 KB)
+ *   -e <mode>    0 no erase, 1 erase the image range, 2 chip erase (default 1)
+ *   -s <code>    JEDEC size code of the chips (default 0x18, 128 Mbit)
+ *   -b 1         scaling run instead: 1, 2, 4 .. n chips, one worker against one per chip
+ *   -v 1         progress on stderr
+ *
+ * Every worker thread has its own emulator clock, so a chip takes the same virtual time whatever the
+ * host does meanwhile and the makespan is the one of a fixture with a bus per chip.
+ */
+
+#include "SPI_Flash_Emulator.h"
+#include "SPI_Flash_Gang.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+/* the chips sit on emulated SPI handles of their own, the spidev stand-in has FLASHEMU_SPIDEVS buses */
+#error "flashman_gang drives emulated SPI handles, build it without FLASHMAN_PLATFORM_LINUX_SPIDEV"
+#endif
+
+#define GANGTOOL_GPIO_PIN                         (1 << 0)
+#define GANGTOOL_NAME                             16
+
+typedef struct
+{
+  SPI_HandleTypeDef      Spi;
+  GPIO_TypeDef           Gpio;
+  FLASHEMU_DeviceTypeDef Device;
+  char                   Name[GANGTOOL_NAME];
+
+} GANGTOOL_ChipTypeDef;
+
+static void GANGTOOL_Progress(void *Context, const FLASHGANG_DeviceTypeDef *Devices, uint32_t Cnt);
+static bool GANGTOOL_Run(FLASHGANG_TypeDef *Gang, uint32_t Cnt, uint8_t SizeCode, bool Report);
+
+static void GANGTOOL_Progress(void *Context, const FLASHGANG_DeviceTypeDef *Devices, uint32_t Cnt)
+{
+  (void)Context;
+  for (uint32_t i = 0; i < Cnt; i++)
+  {
+    fprintf(stderr, "%s %s %u%s", Devices[i].Name, FLASHGANG_StateName(Devices[i].State), Devices[i].Done,
+            (i + 1 < Cnt) ? " | " : "\n");
+  }
+}
+
+/* fresh chips for every run, a chip keeps the busy time of the thread clock that last used it */
+static bool GANGTOOL_Run(FLASHGANG_TypeDef *Gang, uint32_t Cnt, uint8_t SizeCode, bool Report)
+{
+  GANGTOOL_ChipTypeDef *chip = calloc(Cnt, sizeof(GANGTOOL_ChipTypeDef));
+  FLASHGANG_DeviceTypeDef *device = calloc(Cnt, sizeof(FLASHGANG_DeviceTypeDef));
+  bool ok = (chip != NULL) && (device != NULL), ran = false;
+  uint32_t opened = 0;
+
+  for (; ok && (opened < Cnt); opened++)
+  {
+    FLASHEMU_SpiInit(&chip[opened].Spi, FLASHEMU_PCLK_HZ, SPI_BAUDRATEPRESCALER_2);
+    if ((FLASHEMU_Open(&chip[opened].Device, NULL, FLASHMAN_MANUF_WINBOND, 0x40, SizeCode) == false) ||
+        (FLASHEMU_Attach(&chip[opened].Device, &chip[opened].Spi, &chip[opened].Gpio, GANGTOOL_GPIO_PIN) == false))
+    {
+      ok = false;
+      break;
+    }
+    snprintf(chip[opened].Name, GANGTOOL_NAME, "chip%u", opened);
+    device[opened].Name = chip[opened].Name;
+    device[opened].Spi = &chip[opened].Spi;
+    device[opened].Gpio = &chip[opened].Gpio;
+    device[opened].Pin = GANGTOOL_GPIO_PIN;
+  }
+  if (ok == false)
+  {
+    fprintf(stderr, "emulated chip setup failed\n");
+  }
+  else
+  {
+    ok = FLASHGANG_Run(Gang, device, Cnt);
+    ran = true;
+  }
+  if (ran && Report)
+  {
+    printf("  \"devices\": [\n");
+    for (uint32_t i = 0; i < Cnt; i++)
+    {
+      FLASHGANG_DeviceTypeDef *d = &device[i];
+      printf("    {\"name\": \"%s\", \"worker\": %u, \"result\": \"%s\", \"failed_in\": \"%s\", \"mismatch\": %u, "
+             "\"init_ms\": %.3f, \"erase_ms\": %.3f, \"program_ms\": %.3f, \"verify_ms\": %.3f, \"total_ms\": %.3f}%s\n",
+             d->Name, d->Worker, FLASHGANG_StateName(d->State),
+             (d->State == FLASHGANG_FAILED) ? FLASHGANG_StateName(d->FailedIn) : "", d->Mismatch,
+             d->StepNs[FLASHGANG_INIT - FLASHGANG_INIT] / 1e6, d->StepNs[FLASHGANG_ERASE - FLASHGANG_INIT] / 1e6,
+             d->StepNs[FLASHGANG_PROGRAM - FLASHGANG_INIT] / 1e6, d->StepNs[FLASHGANG_VERIFY - FLASHGANG_INIT] / 1e6,
+             (d->EndNs - d->StartNs) / 1e6, (i + 1 < Cnt) ? "," : "");
+    }
+    printf("  ],\n");
+  }
+  for (uint32_t i = 0; i < opened; i++)
+  {
+    FLASHEMU_Close(&chip[i].Device);
+  }
+  free(device);
+  free(chip);
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  FLASHGANG_TypeDef gang = {0};
+  uint32_t chips = 8, workers = 0, size = 256 * 1024, erase = FLASHGANG_ERASE_RANGE, sizeCode = FLASHMAN_SIZE_128MBIT;
+  bool scaling = false, verbose = false, ok = true;
+  uint8_t *image;
+  int opt;
+
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    opt = argv[i][1];
+    uint32_t value = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+    switch (opt)
+    {
+    case 'n': chips = value; break;
+    case 'w': workers = value; break;
+    case 'i': size = value; break;
+    case 'e': erase = value; break;
+    case 's': sizeCode = value; break;
+    case 'b': scaling = (value != 0); break;
+    case 'v': verbose = (value != 0); break;
+    default:
+      fprintf(stderr, "unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+  if ((chips == 0) || (size == 0) || (erase > FLASHGANG_ERASE_CHIP))
+  {
+    fprintf(stderr, "bad option\n");
+    return 2;
+  }
+  image = malloc(size);
+  if (image == NULL)
+  {
+    return 1;
+  }
+  srand(1);
+  for (uint32_t i = 0; i < size; i++)
+  {
+    image[i] = (uint8_t)rand();
+  }
+  gang.Image = image;
+  gang.Size = size;
+  gang.Erase = (FLASHGANG_EraseTypeDef)erase;
+  gang.Verify = true;
+  gang.Clock = FLASHEMU_GetTimeNs;
+  gang.Progress = verbose ? GANGTOOL_Progress : NULL;
+  gang.ProgressMs = 200;
+
+  printf("{\n  \"tool\": \"flashman_gang\",\n  \"format\": 1,\n");
+  printf("  \"config\": {\"chips\": %u, \"workers\": %u, \"image\": %u, \"erase\": %u, \"size_code\": %u},\n",
+         chips, workers, size, erase, sizeCode);
+  if (scaling)
+  {
+    printf("  \"scaling\": [\n");
+    for (uint32_t n = 1; ok && (n <= chips); n = (n * 2 > chips && n < chips) ? chips : n * 2)
+    {
+      uint64_t serial;
+      gang.Workers = 1;
+      ok = GANGTOOL_Run(&gang, n, (uint8_t)sizeCode, false);
+      serial = gang.ElapsedNs;
+      gang.Workers = 0;
+      ok = ok && GANGTOOL_Run(&gang, n, (uint8_t)sizeCode, false);
+      if (ok)
+      {
+        double speedup = (gang.ElapsedNs != 0) ? (double)serial / (double)gang.ElapsedNs : 0.0;
+        printf("    {\"chips\": %u, \"serial_ms\": %.3f, \"gang_ms\": %.3f, \"speedup\": %.2f, \"efficiency\": %.3f}%s\n",
+               n, serial / 1e6, gang.ElapsedNs / 1e6, speedup, speedup / n, (n < chips) ? "," : "");
+      }
+    }
+    printf("  ]\n}\n");
+  }
+  else
+  {
+    gang.Workers = workers;
+    ok = GANGTOOL_Run(&gang, chips, (uint8_t)sizeCode, true);
+    printf("  \"summary\": {\"passed\": %u, \"failed\": %u, \"elapsed_ms\": %.3f, \"serial_ms\": %.3f, \"speedup\": %.2f}\n}\n",
+           gang.Passed, gang.Failed, gang.ElapsedNs / 1e6, gang.SerialNs / 1e6,
+           (gang.ElapsedNs != 0) ? (double)gang.SerialNs / (double)gang.ElapsedNs : 0.0);
+  }
+  free(image);
+  return ok ? 0 : 1;
+}
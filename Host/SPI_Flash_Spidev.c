@@ -0,0 +1,156 @@
+/*
+ * User-space stand-in for spidev, the FLASHMAN_PLATFORM_LINUX_SPIDEV port of SPI_Flash_Manager_Spidev.c
+ * on the emulator. Link it instead of that file:
+ *
+ *   make -C Host audit CONFIG="-DFLASHMAN_PLATFORM=FLASHMAN_PLATFORM_LINUX_SPIDEV"
+ *
+ * A message is checked like the spidev driver does, then its transfers are clocked through an
+ * emulated bus with CS handled per cs_change. Every message costs FLASHEMU_SPIDEV_CALL_NS of
+ * virtual time for the system call. HAL_GetTick()/HAL_Delay() are the emulator's.
+ */
+
+#include "SPI_Flash_Emulator.h"
+
+#define FLASHEMU_SPIDEVS                          4
+
+typedef struct
+{
+  const char             *Path;
+  FLASHEMU_DeviceTypeDef *Device;
+  SPI_HandleTypeDef      Spi;
+  GPIO_TypeDef           Gpio;
+  bool                   Selected;
+
+} FLASHEMU_SpidevTypeDef;
+
+static FLASHEMU_SpidevTypeDef FLASHEMU_Spidev[FLASHEMU_SPIDEVS];
+
+static void FLASHEMU_SpidevCs(FLASHEMU_SpidevTypeDef *Bus, bool Select);
+
+static void FLASHEMU_SpidevCs(FLASHEMU_SpidevTypeDef *Bus, bool Select)
+{
+  if (Bus->Selected != Select)
+  {
+    HAL_GPIO_WritePin(&Bus->Gpio, 1, Select ? GPIO_PIN_RESET : GPIO_PIN_SET);
+    Bus->Selected = Select;
+  }
+}
+
+/**
+  * @brief  Make an opened emulated chip available to FLASHMAN_SpidevOpen() under a device path
+  *
+  * @param  *Path: e.g. "/dev/spidev0.0", kept by reference
+  * @param  *Device: Pointer to an opened FLASHEMU_DeviceTypeDef structure, not attached to a bus
+  *
+  * @retval bool: true or false
+  */
+bool FLASHEMU_SpidevAdd(const char *Path, FLASHEMU_DeviceTypeDef *Device)
+{
+  for (int i = 0; i < FLASHEMU_SPIDEVS; i++)
+  {
+    FLASHEMU_SpidevTypeDef *bus = &FLASHEMU_Spidev[i];
+    if (bus->Path == NULL)
+    {
+      FLASHEMU_SpiInit(&bus->Spi, FLASHEMU_PCLK_HZ, SPI_BAUDRATEPRESCALER_2);
+      /* the system call is charged per message instead */
+      bus->Spi.CallOverheadNs = 0;
+      if (FLASHEMU_Attach(Device, &bus->Spi, &bus->Gpio, 1) == false)
+      {
+        return false;
+      }
+      bus->Path = Path;
+      bus->Device = Device;
+      bus->Selected = false;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FLASHMAN_SpidevOpen(FLASHMAN_SpidevTypeDef *Spi, const char *Path, uint32_t SpeedHz, uint8_t Mode)
+{
+  if ((Spi == NULL) || (Path == NULL) || (SpeedHz == 0) || ((Mode != SPI_MODE_0) && (Mode != SPI_MODE_3)))
+  {
+    return false;
+  }
+  memset(Spi, 0, sizeof(FLASHMAN_SpidevTypeDef));
+  Spi->Fd = -1;
+  for (int i = 0; i < FLASHEMU_SPIDEVS; i++)
+  {
+    if ((FLASHEMU_Spidev[i].Path != NULL) && (strcmp(FLASHEMU_Spidev[i].Path, Path) == 0))
+    {
+      FLASHEMU_Spidev[i].Spi.PclkHz = SpeedHz * 2;
+      Spi->Fd = i;
+      Spi->SpeedHz = SpeedHz;
+      return true;
+    }
+  }
+  return false;
+}
+
+void FLASHMAN_SpidevClose(FLASHMAN_SpidevTypeDef *Spi)
+{
+  if ((Spi != NULL) && (Spi->Fd >= 0))
+  {
+    FLASHEMU_SpidevCs(&FLASHEMU_Spidev[Spi->Fd], false);
+    Spi->Fd = -1;
+  }
+}
+
+bool FLASHMAN_SpidevMessage(FLASHMAN_SpidevTypeDef *Spi, struct spi_ioc_transfer *Xfer, uint32_t Cnt)
+{
+  FLASHEMU_SpidevTypeDef *bus;
+  uint64_t total = 0;
+  uint32_t length;
+  uint8_t *tx, *rx;
+
+  if ((Spi == NULL) || (Spi->Fd < 0) || (Spi->Fd >= FLASHEMU_SPIDEVS) || (Xfer == NULL) || (Cnt == 0))
+  {
+    return false;
+  }
+  bus = &FLASHEMU_Spidev[Spi->Fd];
+  /* spidev refuses messages longer than its bufsiz */
+  for (uint32_t i = 0; i < Cnt; i++)
+  {
+    total += Xfer[i].len;
+  }
+  if (total > FLASHMAN_SPIDEV_BUFSIZ)
+  {
+    return false;
+  }
+  Spi->Messages++;
+  FLASHEMU_Advance(FLASHEMU_SPIDEV_CALL_NS);
+  for (uint32_t i = 0; i < Cnt; i++)
+  {
+    if (Xfer[i].speed_hz != 0)
+    {
+      bus->Spi.PclkHz = Xfer[i].speed_hz * 2;
+    }
+    tx = (uint8_t *)(uintptr_t)Xfer[i].tx_buf;
+    rx = (uint8_t *)(uintptr_t)Xfer[i].rx_buf;
+    if (Xfer[i].len > 0)
+    {
+      FLASHEMU_SpidevCs(bus, true);
+    }
+    for (uint32_t done = 0; done < Xfer[i].len; done += length)
+    {
+      length = Xfer[i].len - done;
+      if (length > 0xFFFF)
+      {
+        length = 0xFFFF;
+      }
+      HAL_SPI_TransmitReceive(&bus->Spi, (tx != NULL) ? tx + done : NULL, (rx != NULL) ? rx + done : NULL, (uint16_t)length, 0);
+    }
+    /* cs_change: deselect between transfers, stay selected after the last one */
+    if ((i + 1 < Cnt) ? Xfer[i].cs_change : (Xfer[i].cs_change == 0))
+    {
+      FLASHEMU_SpidevCs(bus, false);
+    }
+  }
+  return true;
+}
+
+uint32_t FLASHMAN_SpidevTimeUs(void)
+{
+  return (uint32_t)(FLASHEMU_GetTimeNs() / 1000);
+}
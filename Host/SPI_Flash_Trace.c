@@ -0,0 +1,180 @@
+/*
+ * Decoder for SPI_Flash_Manager transaction trace dumps (FLASHMAN_TRACE_ENABLE).
+ *
+ *   make -C Host trace && Host/build/flashman_trace [-t] dump.bin > trace.csv
+ *
+ *   -t           human readable timeline instead of CSV
+ *
+ * A dump is the raw FLASHMAN_TraceTypeDef returned by FLASHMAN_GetTrace(), e.g. written to a
+ * file by the application or saved from a debugger ("dump binary memory dump.bin &h.Trace ...").
+ * The ring size is taken from the dump, so it does not have to match this build. Little endian.
+ */
+
+#include "SPI_Flash_Manager.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct
+{
+  uint8_t                Cmd;
+  const char             *Name;
+
+} TRACE_CmdTypeDef;
+
+static const TRACE_CmdTypeDef TRACE_Cmds[] =
+{
+  {FLASHMAN_CMD_READDATA3ADD, "read"},
+  {FLASHMAN_CMD_READDATA4ADD, "read4"},
+  {FLASHMAN_CMD_FASTREAD3ADD, "fast_read"},
+  {FLASHMAN_CMD_FASTREAD4ADD, "fast_read4"},
+  {FLASHMAN_CMD_PAGEPROG3ADD, "page_program"},
+  {FLASHMAN_CMD_PAGEPROG4ADD, "page_program4"},
+  {FLASHMAN_CMD_SECTORERASE3ADD, "sector_erase"},
+  {FLASHMAN_CMD_SECTORERASE4ADD, "sector_erase4"},
+  {FLASHMAN_CMD_BLOCKERASE3ADD, "block_erase"},
+  {FLASHMAN_CMD_BLOCKERASE4ADD, "block_erase4"},
+  {FLASHMAN_CMD_CHIPERASE1, "chip_erase"},
+  {FLASHMAN_CMD_CHIPERASE2, "chip_erase"},
+};
+
+static const char *TRACE_Results[] = {"ok", "error", "timeout", "pending"};
+
+static const char *TRACE_CmdName(uint8_t Cmd)
+{
+  for (size_t i = 0; i < sizeof(TRACE_Cmds) / sizeof(TRACE_Cmds[0]); i++)
+  {
+    if (TRACE_Cmds[i].Cmd == Cmd)
+    {
+      return TRACE_Cmds[i].Name;
+    }
+  }
+  return "unknown";
+}
+
+static const char *TRACE_ResultName(uint8_t Result)
+{
+  return (Result < sizeof(TRACE_Results) / sizeof(TRACE_Results[0])) ? TRACE_Results[Result] : "?";
+}
+
+static uint32_t TRACE_Get32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t TRACE_Get16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static int TRACE_Decode(const char *Path, bool Timeline)
+{
+  FILE *f = fopen(Path, "rb");
+  if (f == NULL)
+  {
+    perror(Path);
+    return 1;
+  }
+  uint8_t header[offsetof(FLASHMAN_TraceTypeDef, Record)];
+  if (fread(header, sizeof(header), 1, f) != 1)
+  {
+    fprintf(stderr, "%s: short dump\n", Path);
+    fclose(f);
+    return 1;
+  }
+  uint32_t magic = TRACE_Get32(&header[offsetof(FLASHMAN_TraceTypeDef, Magic)]);
+  uint16_t recordSize = TRACE_Get16(&header[offsetof(FLASHMAN_TraceTypeDef, RecordSize)]);
+  uint16_t size = TRACE_Get16(&header[offsetof(FLASHMAN_TraceTypeDef, Size)]);
+  uint32_t head = TRACE_Get32(&header[offsetof(FLASHMAN_TraceTypeDef, Head)]);
+  if ((magic != FLASHMAN_TRACE_MAGIC) || (recordSize < sizeof(FLASHMAN_TraceRecordTypeDef)) || (size == 0))
+  {
+    fprintf(stderr, "%s: not a FLASHMAN trace dump\n", Path);
+    fclose(f);
+    return 1;
+  }
+  uint8_t *ring = malloc((size_t)recordSize * size);
+  if ((ring == NULL) || (fread(ring, recordSize, size, f) != size))
+  {
+    fprintf(stderr, "%s: short dump\n", Path);
+    free(ring);
+    fclose(f);
+    return 1;
+  }
+  fclose(f);
+
+  uint32_t count = (head < size) ? head : size;
+  uint32_t first = head - count;
+  uint32_t origin = 0, lastHigh = 0;
+  if (Timeline == false)
+  {
+    printf("seq,cmd,opcode,address,length,cs_low_us,cs_us,busy_us,result\n");
+  }
+  for (uint32_t seq = first; seq < head; seq++)
+  {
+    const uint8_t *rec = &ring[(size_t)(seq % size) * recordSize];
+    uint32_t csLow = TRACE_Get32(&rec[offsetof(FLASHMAN_TraceRecordTypeDef, CsLow)]);
+    uint32_t csHigh = TRACE_Get32(&rec[offsetof(FLASHMAN_TraceRecordTypeDef, CsHigh)]);
+    uint32_t address = TRACE_Get32(&rec[offsetof(FLASHMAN_TraceRecordTypeDef, Address)]);
+    uint32_t length = TRACE_Get32(&rec[offsetof(FLASHMAN_TraceRecordTypeDef, Length)]);
+    uint32_t busyUs = TRACE_Get32(&rec[offsetof(FLASHMAN_TraceRecordTypeDef, BusyUs)]);
+    uint8_t cmd = rec[offsetof(FLASHMAN_TraceRecordTypeDef, Cmd)];
+    uint8_t result = rec[offsetof(FLASHMAN_TraceRecordTypeDef, Result)];
+    if (seq == first)
+    {
+      origin = csLow;
+      lastHigh = csLow;
+    }
+    /* time stamps are free running 32 bit us, so only differences are meaningful */
+    if (Timeline)
+    {
+      printf("%10.3f ms  +%-8u %-14s 0x%08X %6u B  cs %6u us", (csLow - origin) / 1000.0, csLow - lastHigh,
+             TRACE_CmdName(cmd), address, length, csHigh - csLow);
+      if (busyUs != 0)
+      {
+        printf("  busy %8u us", busyUs);
+      }
+      printf("  %s\n", TRACE_ResultName(result));
+      lastHigh = csHigh + busyUs;
+    }
+    else
+    {
+      printf("%u,%s,0x%02X,0x%08X,%u,%u,%u,%u,%s\n", seq, TRACE_CmdName(cmd), cmd, address, length,
+             csLow - origin, csHigh - csLow, busyUs, TRACE_ResultName(result));
+    }
+  }
+  if (head > size)
+  {
+    fprintf(stderr, "%s: %u older records were overwritten\n", Path, head - size);
+  }
+  free(ring);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  bool timeline = false;
+  const char *path = NULL;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-t") == 0)
+    {
+      timeline = true;
+    }
+    else if ((argv[i][0] != '-') && (path == NULL))
+    {
+      path = argv[i];
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [-t] dump.bin\n", argv[0]);
+      return 2;
+    }
+  }
+  if (path == NULL)
+  {
+    fprintf(stderr, "usage: %s [-t] dump.bin\n", argv[0]);
+    return 2;
+  }
+  return TRACE_Decode(path, timeline);
+}
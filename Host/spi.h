@@ -0,0 +1,100 @@
+#ifndef _FLASHEMU_SPI_H_
+#define _FLASHEMU_SPI_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+/*
+ * Host stand-in for the CubeMX spi.h, the subset of STM32 HAL used by SPI_Flash_Manager.
+ * Every SPI transfer and CS edge is routed to the SPI NOR emulator in SPI_Flash_Emulator.c,
+ * HAL_GetTick() / HAL_Delay() run on the emulator's virtual clock.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FLASHEMU_PINS                             16
+
+#define SPI_BAUDRATEPRESCALER_2                   (0x00000000U)
+#define SPI_BAUDRATEPRESCALER_4                   (0x00000008U)
+#define SPI_BAUDRATEPRESCALER_8                   (0x00000010U)
+#define SPI_BAUDRATEPRESCALER_16                  (0x00000018U)
+#define SPI_BAUDRATEPRESCALER_32                  (0x00000020U)
+#define SPI_BAUDRATEPRESCALER_64                  (0x00000028U)
+#define SPI_BAUDRATEPRESCALER_128                 (0x00000030U)
+#define SPI_BAUDRATEPRESCALER_256                 (0x00000038U)
+
+typedef enum
+{
+  HAL_OK = 0,
+  HAL_ERROR = 1,
+  HAL_BUSY = 2,
+  HAL_TIMEOUT = 3,
+
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+  GPIO_PIN_RESET = 0,
+  GPIO_PIN_SET,
+
+} GPIO_PinState;
+
+typedef enum
+{
+  HAL_SPI_STATE_RESET = 0,
+  HAL_SPI_STATE_READY = 1,
+  HAL_SPI_STATE_BUSY = 2,
+
+} HAL_SPI_StateTypeDef;
+
+typedef struct FLASHEMU_DeviceTypeDef FLASHEMU_DeviceTypeDef;
+
+typedef struct
+{
+  uint32_t               BaudRatePrescaler;
+
+} SPI_InitTypeDef;
+
+typedef struct
+{
+  SPI_InitTypeDef        Init;
+  uint32_t               PclkHz;
+  uint32_t               CallOverheadNs;
+  FLASHEMU_DeviceTypeDef *Devices;
+  uint64_t               Calls;
+  uint64_t               Bytes;
+  uint64_t               BusNs;
+  uint64_t               DmaUntil;         /* a DMA transfer runs in the background until here */
+
+} SPI_HandleTypeDef;
+
+typedef struct
+{
+  FLASHEMU_DeviceTypeDef *Pins[FLASHEMU_PINS];
+
+} GPIO_TypeDef;
+
+HAL_StatusTypeDef    HAL_SPI_Init(SPI_HandleTypeDef *hspi);
+HAL_StatusTypeDef    HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef    HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef    HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef    HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef    HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef    HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size);
+HAL_StatusTypeDef    HAL_SPI_DMAStop(SPI_HandleTypeDef *hspi);
+HAL_SPI_StateTypeDef HAL_SPI_GetState(SPI_HandleTypeDef *hspi);
+void                 HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+uint32_t             HAL_GetTick(void);
+void                 HAL_Delay(uint32_t Delay);
+
+/* statistics time base of SPI_Flash_Manager, on the emulator clock */
+uint64_t             FLASHEMU_GetTimeNs(void);
+#define FLASHMAN_TIME_US()                        ((uint32_t)(FLASHEMU_GetTimeNs() / 1000))
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHEMU_SPI_H_
@@ -1,5 +1,7 @@
 #include "SPI_Flash_Manager.h"
 
+#include <stddef.h>
+
 #if FLASHMAN_DEBUG == FLASHMAN_DEBUG_DISABLE
 #define dprintf(...)
 #else
@@ -18,13 +20,83 @@
 #include "app_threadx.h"
 #endif
 
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+#define FLASHMAN_STAT(...)    __VA_ARGS__
+#else
+#define FLASHMAN_STAT(...)
+#endif
+
+#if FLASHMAN_FIXED_BLOCK_CNT != 0
+#define FLASHMAN_BLOCK_CNT(Handle)     (FLASHMAN_FIXED_BLOCK_CNT)
+#else
+#define FLASHMAN_BLOCK_CNT(Handle)     ((Handle)->BlockCnt)
+#endif
+#define FLASHMAN_SECTOR_CNT(Handle)    (FLASHMAN_BLOCK_CNT(Handle) << (FLASHMAN_BLOCK_SHIFT - FLASHMAN_SECTOR_SHIFT))
+#define FLASHMAN_PAGE_CNT(Handle)      (FLASHMAN_BLOCK_CNT(Handle) << (FLASHMAN_BLOCK_SHIFT - FLASHMAN_PAGE_SHIFT))
+/* parts above 128 Mbit take the 4 byte address opcodes */
+#define FLASHMAN_ADDR4(Handle)         (FLASHMAN_BLOCK_CNT(Handle) >= 512)
+#define FLASHMAN_ROR(x, n)             (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* consumer of a streamed read, returns how many bytes of the chunk it took, fewer stops the read */
+typedef uint32_t (*FLASHMAN_ConsumeTypeDef)(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size);
+
+typedef struct
+{
+  FLASHMAN_ReadCallbackTypeDef Callback;
+  void                   *Context;
+
+} FLASHMAN_CallbackTypeDef;
+
+/* FLASHMAN_WriteImage() view of the sector being compared */
+typedef struct
+{
+  const uint8_t          *Image;
+  uint32_t               Pages;            /* pages that differ, bit n for page n of the sector */
+  bool                   Erase;            /* a bit has to go from 0 to 1, the rest of the sector is not compared */
+
+} FLASHMAN_ImageDiffTypeDef;
+
+#if FLASHMAN_TRACE == FLASHMAN_TRACE_ENABLE
+#define FLASHMAN_TRC(...)     __VA_ARGS__
+#else
+#define FLASHMAN_TRC(...)
+#endif
+
+#if FLASHMAN_WRITEBACK == FLASHMAN_WRITEBACK_ENABLE
+#define FLASHMAN_WB(...)      __VA_ARGS__
+#else
+#define FLASHMAN_WB(...)
+#endif
+
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_ENABLE
+#define FLASHMAN_CAL(...)     __VA_ARGS__
+#else
+#define FLASHMAN_CAL(...)
+#endif
+
 static void     FLASHMAN_Delay(uint32_t Delay);
 static void     FLASHMAN_Lock(FLASHMAN_HandleTypeDef *Handle);
 static void     FLASHMAN_UnLock(FLASHMAN_HandleTypeDef *Handle);
-static void     FLASHMAN_CsPin(FLASHMAN_HandleTypeDef *Handle, bool Select);
+static bool     FLASHMAN_CsPin(FLASHMAN_HandleTypeDef *Handle, bool Select);
+static void     FLASHMAN_CsPinRead(FLASHMAN_HandleTypeDef *Handle);
+static bool     FLASHMAN_CsPinNext(FLASHMAN_HandleTypeDef *Handle);
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_ENABLE
+static void     FLASHMAN_Clock(FLASHMAN_HandleTypeDef *Handle, uint32_t Prescaler);
+static bool     FLASHMAN_CalFrame(FLASHMAN_HandleTypeDef *Handle, uint8_t Cmd, uint8_t *Rx, uint32_t Size);
+static void     FLASHMAN_Calibrate(FLASHMAN_HandleTypeDef *Handle);
+#endif
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL_DMA)
+static bool     FLASHMAN_DmaWait(FLASHMAN_HandleTypeDef *Handle, uint32_t Timeout);
+#endif
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+static bool     FLASHMAN_MsgAdd(FLASHMAN_HandleTypeDef *Handle, const uint8_t *Tx, uint8_t *Rx, uint32_t Size);
+static bool     FLASHMAN_MsgSend(FLASHMAN_HandleTypeDef *Handle, bool Hold);
+#endif
 static bool     FLASHMAN_TransmitReceive(FLASHMAN_HandleTypeDef *Handle, uint8_t *Tx, uint8_t *Rx, size_t Size, uint32_t Timeout);
 static bool     FLASHMAN_Transmit(FLASHMAN_HandleTypeDef *Handle, uint8_t *Tx, size_t Size, uint32_t Timeout);
 static bool     FLASHMAN_Receive(FLASHMAN_HandleTypeDef *Handle, uint8_t *Rx, size_t Size, uint32_t Timeout);
+static bool     FLASHMAN_ReceiveStart(FLASHMAN_HandleTypeDef *Handle, uint8_t *Rx, uint32_t Size, bool More);
+static bool     FLASHMAN_ReceiveWait(FLASHMAN_HandleTypeDef *Handle);
 static bool     FLASHMAN_WriteEnable(FLASHMAN_HandleTypeDef *Handle);
 static bool     FLASHMAN_WriteDisable(FLASHMAN_HandleTypeDef *Handle);
 static uint8_t  FLASHMAN_ReadReg1(FLASHMAN_HandleTypeDef *Handle);
@@ -36,9 +108,384 @@ static bool     FLASHMAN_WriteReg2(FLASHMAN_HandleTypeDef *Handle, uint8_t Data)
 static bool     FLASHMAN_WriteReg3(FLASHMAN_HandleTypeDef *Handle, uint8_t Data);
 #endif
 static bool     FLASHMAN_WaitForWriting(FLASHMAN_HandleTypeDef *Handle, uint32_t Timeout);
+static bool     FLASHMAN_WaitForReady(FLASHMAN_HandleTypeDef *Handle);
+static uint32_t FLASHMAN_Header(FLASHMAN_HandleTypeDef *Handle, uint8_t *Tx, uint8_t Cmd3Add, uint8_t Cmd4Add, uint32_t Address);
+static bool     FLASHMAN_SendAddress(FLASHMAN_HandleTypeDef *Handle, uint8_t Cmd3Add, uint8_t Cmd4Add, uint32_t Address);
 static bool     FLASHMAN_FindChip(FLASHMAN_HandleTypeDef *Handle);
-static bool     FLASHMAN_WriteFn(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uint8_t *Data, uint32_t Size, uint32_t Offset);
+static void     FLASHMAN_Setup(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_SpiTypeDef *hspi, FLASHMAN_GpioTypeDef *gpio, uint16_t Pin);
+static bool     FLASHMAN_WarmId(FLASHMAN_HandleTypeDef *Handle, const FLASHMAN_DescriptorTypeDef *Descriptor);
+static bool     FLASHMAN_EraseFn(FLASHMAN_HandleTypeDef *Handle, uint8_t Cmd3Add, uint8_t Cmd4Add, uint32_t Address, uint32_t Timeout, bool Wait);
+static bool     FLASHMAN_WriteFn(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uint8_t *Data, uint32_t Size, uint32_t Offset, bool Wait);
+static bool     FLASHMAN_BufferedWriteFn(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uint8_t *Data, uint32_t Size, uint32_t Offset, bool Wait);
+static bool     FLASHMAN_WriteAddressFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size, bool Wait);
 static bool     FLASHMAN_ReadFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size);
+static bool     FLASHMAN_ReadCrcFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size, uint32_t *Crc);
+static uint32_t FLASHMAN_Diff(const uint8_t *A, const uint8_t *B, uint32_t Size);
+static bool     FLASHMAN_Blank(const uint8_t *Data, uint32_t Size);
+static bool     FLASHMAN_CopyMatch(FLASHMAN_HandleTypeDef *Src, uint32_t SrcAddress, FLASHMAN_HandleTypeDef *Dst, uint32_t DstAddress, uint32_t Size, bool *Match);
+static bool     FLASHMAN_CopyProgram(FLASHMAN_HandleTypeDef *Src, uint32_t SrcAddress, FLASHMAN_HandleTypeDef *Dst, uint32_t DstAddress, uint32_t Size);
+static bool     FLASHMAN_Clearable(const uint8_t *Flash, const uint8_t *Image, uint32_t Size);
+static bool     FLASHMAN_ImageProgram(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, const uint8_t *Image, uint32_t Size, uint32_t Pages, uint32_t *Programmed);
+static bool     FLASHMAN_StreamFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size, uint8_t *const *Buffers, uint32_t BufferCnt,
+                                  uint32_t BufferSize, FLASHMAN_ConsumeTypeDef Consume, void *Context, uint32_t *Done);
+static uint32_t FLASHMAN_CallbackChunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size);
+static uint32_t FLASHMAN_CompareChunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size);
+static uint32_t FLASHMAN_ImageChunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size);
+static uint32_t FLASHMAN_Crc32Chunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size);
+static uint32_t FLASHMAN_Crc32cChunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size);
+static uint32_t FLASHMAN_Sha256Chunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size);
+static void     FLASHMAN_Sha256Block(FLASHMAN_Sha256TypeDef *Sha, const uint8_t *Block);
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+static void     FLASHMAN_StatsHist(uint32_t *Hist, uint32_t Us);
+static void     FLASHMAN_StatsApi(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_StatApiTypeDef Api, uint32_t Bytes, bool Ok);
+static void     FLASHMAN_StatsBusyStart(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_StatOpTypeDef Op);
+static void     FLASHMAN_StatsBusyDone(FLASHMAN_HandleTypeDef *Handle);
+#endif
+#if FLASHMAN_TRACE == FLASHMAN_TRACE_ENABLE
+static void     FLASHMAN_TraceInit(FLASHMAN_TraceTypeDef *Trace);
+static void     FLASHMAN_TraceBegin(FLASHMAN_HandleTypeDef *Handle, uint8_t Cmd3Add, uint8_t Cmd4Add, uint32_t Address, uint32_t Length);
+static void     FLASHMAN_TraceEnd(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_TraceResultTypeDef Result);
+static void     FLASHMAN_TraceBusy(FLASHMAN_HandleTypeDef *Handle, bool Ready);
+#endif
+#if FLASHMAN_WRITEBACK == FLASHMAN_WRITEBACK_ENABLE
+static bool     FLASHMAN_WbFlush(FLASHMAN_HandleTypeDef *Handle, bool Wait);
+static void     FLASHMAN_WbDrop(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size);
+static void     FLASHMAN_WbRead(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size);
+#endif
+
+/* CRC32 slices, [0] is the byte table, [j][i] continues [j - 1][i] by a zero byte */
+#if FLASHMAN_CRC != FLASHMAN_CRC_HW
+#if FLASHMAN_CRC == FLASHMAN_CRC_SLICE8
+static const uint32_t FLASHMAN_CrcTable[8][256] =
+#else
+static const uint32_t FLASHMAN_CrcTable[1][256] =
+#endif
+{
+  {
+    0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
+    0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
+    0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+    0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
+    0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
+    0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+    0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
+    0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D,
+    0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+    0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D, 0x91646C97, 0xE6635C01,
+    0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E, 0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
+    0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+    0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
+    0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
+    0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+    0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81, 0xB7BD5C3B, 0xC0BA6CAD,
+    0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683,
+    0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+    0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7,
+    0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5,
+    0xD6D6A3E8, 0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+    0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF, 0x4669BE79,
+    0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F,
+    0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+    0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713,
+    0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21,
+    0x86D3D2D4, 0xF1D4E242, 0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+    0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
+    0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB,
+    0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+    0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF,
+    0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+  },
+#if FLASHMAN_CRC == FLASHMAN_CRC_SLICE8
+  {
+    0x00000000, 0x191B3141, 0x32366282, 0x2B2D53C3, 0x646CC504, 0x7D77F445, 0x565AA786, 0x4F4196C7,
+    0xC8D98A08, 0xD1C2BB49, 0xFAEFE88A, 0xE3F4D9CB, 0xACB54F0C, 0xB5AE7E4D, 0x9E832D8E, 0x87981CCF,
+    0x4AC21251, 0x53D92310, 0x78F470D3, 0x61EF4192, 0x2EAED755, 0x37B5E614, 0x1C98B5D7, 0x05838496,
+    0x821B9859, 0x9B00A918, 0xB02DFADB, 0xA936CB9A, 0xE6775D5D, 0xFF6C6C1C, 0xD4413FDF, 0xCD5A0E9E,
+    0x958424A2, 0x8C9F15E3, 0xA7B24620, 0xBEA97761, 0xF1E8E1A6, 0xE8F3D0E7, 0xC3DE8324, 0xDAC5B265,
+    0x5D5DAEAA, 0x44469FEB, 0x6F6BCC28, 0x7670FD69, 0x39316BAE, 0x202A5AEF, 0x0B07092C, 0x121C386D,
+    0xDF4636F3, 0xC65D07B2, 0xED705471, 0xF46B6530, 0xBB2AF3F7, 0xA231C2B6, 0x891C9175, 0x9007A034,
+    0x179FBCFB, 0x0E848DBA, 0x25A9DE79, 0x3CB2EF38, 0x73F379FF, 0x6AE848BE, 0x41C51B7D, 0x58DE2A3C,
+    0xF0794F05, 0xE9627E44, 0xC24F2D87, 0xDB541CC6, 0x94158A01, 0x8D0EBB40, 0xA623E883, 0xBF38D9C2,
+    0x38A0C50D, 0x21BBF44C, 0x0A96A78F, 0x138D96CE, 0x5CCC0009, 0x45D73148, 0x6EFA628B, 0x77E153CA,
+    0xBABB5D54, 0xA3A06C15, 0x888D3FD6, 0x91960E97, 0xDED79850, 0xC7CCA911, 0xECE1FAD2, 0xF5FACB93,
+    0x7262D75C, 0x6B79E61D, 0x4054B5DE, 0x594F849F, 0x160E1258, 0x0F152319, 0x243870DA, 0x3D23419B,
+    0x65FD6BA7, 0x7CE65AE6, 0x57CB0925, 0x4ED03864, 0x0191AEA3, 0x188A9FE2, 0x33A7CC21, 0x2ABCFD60,
+    0xAD24E1AF, 0xB43FD0EE, 0x9F12832D, 0x8609B26C, 0xC94824AB, 0xD05315EA, 0xFB7E4629, 0xE2657768,
+    0x2F3F79F6, 0x362448B7, 0x1D091B74, 0x04122A35, 0x4B53BCF2, 0x52488DB3, 0x7965DE70, 0x607EEF31,
+    0xE7E6F3FE, 0xFEFDC2BF, 0xD5D0917C, 0xCCCBA03D, 0x838A36FA, 0x9A9107BB, 0xB1BC5478, 0xA8A76539,
+    0x3B83984B, 0x2298A90A, 0x09B5FAC9, 0x10AECB88, 0x5FEF5D4F, 0x46F46C0E, 0x6DD93FCD, 0x74C20E8C,
+    0xF35A1243, 0xEA412302, 0xC16C70C1, 0xD8774180, 0x9736D747, 0x8E2DE606, 0xA500B5C5, 0xBC1B8484,
+    0x71418A1A, 0x685ABB5B, 0x4377E898, 0x5A6CD9D9, 0x152D4F1E, 0x0C367E5F, 0x271B2D9C, 0x3E001CDD,
+    0xB9980012, 0xA0833153, 0x8BAE6290, 0x92B553D1, 0xDDF4C516, 0xC4EFF457, 0xEFC2A794, 0xF6D996D5,
+    0xAE07BCE9, 0xB71C8DA8, 0x9C31DE6B, 0x852AEF2A, 0xCA6B79ED, 0xD37048AC, 0xF85D1B6F, 0xE1462A2E,
+    0x66DE36E1, 0x7FC507A0, 0x54E85463, 0x4DF36522, 0x02B2F3E5, 0x1BA9C2A4, 0x30849167, 0x299FA026,
+    0xE4C5AEB8, 0xFDDE9FF9, 0xD6F3CC3A, 0xCFE8FD7B, 0x80A96BBC, 0x99B25AFD, 0xB29F093E, 0xAB84387F,
+    0x2C1C24B0, 0x350715F1, 0x1E2A4632, 0x07317773, 0x4870E1B4, 0x516BD0F5, 0x7A468336, 0x635DB277,
+    0xCBFAD74E, 0xD2E1E60F, 0xF9CCB5CC, 0xE0D7848D, 0xAF96124A, 0xB68D230B, 0x9DA070C8, 0x84BB4189,
+    0x03235D46, 0x1A386C07, 0x31153FC4, 0x280E0E85, 0x674F9842, 0x7E54A903, 0x5579FAC0, 0x4C62CB81,
+    0x8138C51F, 0x9823F45E, 0xB30EA79D, 0xAA1596DC, 0xE554001B, 0xFC4F315A, 0xD7626299, 0xCE7953D8,
+    0x49E14F17, 0x50FA7E56, 0x7BD72D95, 0x62CC1CD4, 0x2D8D8A13, 0x3496BB52, 0x1FBBE891, 0x06A0D9D0,
+    0x5E7EF3EC, 0x4765C2AD, 0x6C48916E, 0x7553A02F, 0x3A1236E8, 0x230907A9, 0x0824546A, 0x113F652B,
+    0x96A779E4, 0x8FBC48A5, 0xA4911B66, 0xBD8A2A27, 0xF2CBBCE0, 0xEBD08DA1, 0xC0FDDE62, 0xD9E6EF23,
+    0x14BCE1BD, 0x0DA7D0FC, 0x268A833F, 0x3F91B27E, 0x70D024B9, 0x69CB15F8, 0x42E6463B, 0x5BFD777A,
+    0xDC656BB5, 0xC57E5AF4, 0xEE530937, 0xF7483876, 0xB809AEB1, 0xA1129FF0, 0x8A3FCC33, 0x9324FD72
+  },
+  {
+    0x00000000, 0x01C26A37, 0x0384D46E, 0x0246BE59, 0x0709A8DC, 0x06CBC2EB, 0x048D7CB2, 0x054F1685,
+    0x0E1351B8, 0x0FD13B8F, 0x0D9785D6, 0x0C55EFE1, 0x091AF964, 0x08D89353, 0x0A9E2D0A, 0x0B5C473D,
+    0x1C26A370, 0x1DE4C947, 0x1FA2771E, 0x1E601D29, 0x1B2F0BAC, 0x1AED619B, 0x18ABDFC2, 0x1969B5F5,
+    0x1235F2C8, 0x13F798FF, 0x11B126A6, 0x10734C91, 0x153C5A14, 0x14FE3023, 0x16B88E7A, 0x177AE44D,
+    0x384D46E0, 0x398F2CD7, 0x3BC9928E, 0x3A0BF8B9, 0x3F44EE3C, 0x3E86840B, 0x3CC03A52, 0x3D025065,
+    0x365E1758, 0x379C7D6F, 0x35DAC336, 0x3418A901, 0x3157BF84, 0x3095D5B3, 0x32D36BEA, 0x331101DD,
+    0x246BE590, 0x25A98FA7, 0x27EF31FE, 0x262D5BC9, 0x23624D4C, 0x22A0277B, 0x20E69922, 0x2124F315,
+    0x2A78B428, 0x2BBADE1F, 0x29FC6046, 0x283E0A71, 0x2D711CF4, 0x2CB376C3, 0x2EF5C89A, 0x2F37A2AD,
+    0x709A8DC0, 0x7158E7F7, 0x731E59AE, 0x72DC3399, 0x7793251C, 0x76514F2B, 0x7417F172, 0x75D59B45,
+    0x7E89DC78, 0x7F4BB64F, 0x7D0D0816, 0x7CCF6221, 0x798074A4, 0x78421E93, 0x7A04A0CA, 0x7BC6CAFD,
+    0x6CBC2EB0, 0x6D7E4487, 0x6F38FADE, 0x6EFA90E9, 0x6BB5866C, 0x6A77EC5B, 0x68315202, 0x69F33835,
+    0x62AF7F08, 0x636D153F, 0x612BAB66, 0x60E9C151, 0x65A6D7D4, 0x6464BDE3, 0x662203BA, 0x67E0698D,
+    0x48D7CB20, 0x4915A117, 0x4B531F4E, 0x4A917579, 0x4FDE63FC, 0x4E1C09CB, 0x4C5AB792, 0x4D98DDA5,
+    0x46C49A98, 0x4706F0AF, 0x45404EF6, 0x448224C1, 0x41CD3244, 0x400F5873, 0x4249E62A, 0x438B8C1D,
+    0x54F16850, 0x55330267, 0x5775BC3E, 0x56B7D609, 0x53F8C08C, 0x523AAABB, 0x507C14E2, 0x51BE7ED5,
+    0x5AE239E8, 0x5B2053DF, 0x5966ED86, 0x58A487B1, 0x5DEB9134, 0x5C29FB03, 0x5E6F455A, 0x5FAD2F6D,
+    0xE1351B80, 0xE0F771B7, 0xE2B1CFEE, 0xE373A5D9, 0xE63CB35C, 0xE7FED96B, 0xE5B86732, 0xE47A0D05,
+    0xEF264A38, 0xEEE4200F, 0xECA29E56, 0xED60F461, 0xE82FE2E4, 0xE9ED88D3, 0xEBAB368A, 0xEA695CBD,
+    0xFD13B8F0, 0xFCD1D2C7, 0xFE976C9E, 0xFF5506A9, 0xFA1A102C, 0xFBD87A1B, 0xF99EC442, 0xF85CAE75,
+    0xF300E948, 0xF2C2837F, 0xF0843D26, 0xF1465711, 0xF4094194, 0xF5CB2BA3, 0xF78D95FA, 0xF64FFFCD,
+    0xD9785D60, 0xD8BA3757, 0xDAFC890E, 0xDB3EE339, 0xDE71F5BC, 0xDFB39F8B, 0xDDF521D2, 0xDC374BE5,
+    0xD76B0CD8, 0xD6A966EF, 0xD4EFD8B6, 0xD52DB281, 0xD062A404, 0xD1A0CE33, 0xD3E6706A, 0xD2241A5D,
+    0xC55EFE10, 0xC49C9427, 0xC6DA2A7E, 0xC7184049, 0xC25756CC, 0xC3953CFB, 0xC1D382A2, 0xC011E895,
+    0xCB4DAFA8, 0xCA8FC59F, 0xC8C97BC6, 0xC90B11F1, 0xCC440774, 0xCD866D43, 0xCFC0D31A, 0xCE02B92D,
+    0x91AF9640, 0x906DFC77, 0x922B422E, 0x93E92819, 0x96A63E9C, 0x976454AB, 0x9522EAF2, 0x94E080C5,
+    0x9FBCC7F8, 0x9E7EADCF, 0x9C381396, 0x9DFA79A1, 0x98B56F24, 0x99770513, 0x9B31BB4A, 0x9AF3D17D,
+    0x8D893530, 0x8C4B5F07, 0x8E0DE15E, 0x8FCF8B69, 0x8A809DEC, 0x8B42F7DB, 0x89044982, 0x88C623B5,
+    0x839A6488, 0x82580EBF, 0x801EB0E6, 0x81DCDAD1, 0x8493CC54, 0x8551A663, 0x8717183A, 0x86D5720D,
+    0xA9E2D0A0, 0xA820BA97, 0xAA6604CE, 0xABA46EF9, 0xAEEB787C, 0xAF29124B, 0xAD6FAC12, 0xACADC625,
+    0xA7F18118, 0xA633EB2F, 0xA4755576, 0xA5B73F41, 0xA0F829C4, 0xA13A43F3, 0xA37CFDAA, 0xA2BE979D,
+    0xB5C473D0, 0xB40619E7, 0xB640A7BE, 0xB782CD89, 0xB2CDDB0C, 0xB30FB13B, 0xB1490F62, 0xB08B6555,
+    0xBBD72268, 0xBA15485F, 0xB853F606, 0xB9919C31, 0xBCDE8AB4, 0xBD1CE083, 0xBF5A5EDA, 0xBE9834ED
+  },
+  {
+    0x00000000, 0xB8BC6765, 0xAA09C88B, 0x12B5AFEE, 0x8F629757, 0x37DEF032, 0x256B5FDC, 0x9DD738B9,
+    0xC5B428EF, 0x7D084F8A, 0x6FBDE064, 0xD7018701, 0x4AD6BFB8, 0xF26AD8DD, 0xE0DF7733, 0x58631056,
+    0x5019579F, 0xE8A530FA, 0xFA109F14, 0x42ACF871, 0xDF7BC0C8, 0x67C7A7AD, 0x75720843, 0xCDCE6F26,
+    0x95AD7F70, 0x2D111815, 0x3FA4B7FB, 0x8718D09E, 0x1ACFE827, 0xA2738F42, 0xB0C620AC, 0x087A47C9,
+    0xA032AF3E, 0x188EC85B, 0x0A3B67B5, 0xB28700D0, 0x2F503869, 0x97EC5F0C, 0x8559F0E2, 0x3DE59787,
+    0x658687D1, 0xDD3AE0B4, 0xCF8F4F5A, 0x7733283F, 0xEAE41086, 0x525877E3, 0x40EDD80D, 0xF851BF68,
+    0xF02BF8A1, 0x48979FC4, 0x5A22302A, 0xE29E574F, 0x7F496FF6, 0xC7F50893, 0xD540A77D, 0x6DFCC018,
+    0x359FD04E, 0x8D23B72B, 0x9F9618C5, 0x272A7FA0, 0xBAFD4719, 0x0241207C, 0x10F48F92, 0xA848E8F7,
+    0x9B14583D, 0x23A83F58, 0x311D90B6, 0x89A1F7D3, 0x1476CF6A, 0xACCAA80F, 0xBE7F07E1, 0x06C36084,
+    0x5EA070D2, 0xE61C17B7, 0xF4A9B859, 0x4C15DF3C, 0xD1C2E785, 0x697E80E0, 0x7BCB2F0E, 0xC377486B,
+    0xCB0D0FA2, 0x73B168C7, 0x6104C729, 0xD9B8A04C, 0x446F98F5, 0xFCD3FF90, 0xEE66507E, 0x56DA371B,
+    0x0EB9274D, 0xB6054028, 0xA4B0EFC6, 0x1C0C88A3, 0x81DBB01A, 0x3967D77F, 0x2BD27891, 0x936E1FF4,
+    0x3B26F703, 0x839A9066, 0x912F3F88, 0x299358ED, 0xB4446054, 0x0CF80731, 0x1E4DA8DF, 0xA6F1CFBA,
+    0xFE92DFEC, 0x462EB889, 0x549B1767, 0xEC277002, 0x71F048BB, 0xC94C2FDE, 0xDBF98030, 0x6345E755,
+    0x6B3FA09C, 0xD383C7F9, 0xC1366817, 0x798A0F72, 0xE45D37CB, 0x5CE150AE, 0x4E54FF40, 0xF6E89825,
+    0xAE8B8873, 0x1637EF16, 0x048240F8, 0xBC3E279D, 0x21E91F24, 0x99557841, 0x8BE0D7AF, 0x335CB0CA,
+    0xED59B63B, 0x55E5D15E, 0x47507EB0, 0xFFEC19D5, 0x623B216C, 0xDA874609, 0xC832E9E7, 0x708E8E82,
+    0x28ED9ED4, 0x9051F9B1, 0x82E4565F, 0x3A58313A, 0xA78F0983, 0x1F336EE6, 0x0D86C108, 0xB53AA66D,
+    0xBD40E1A4, 0x05FC86C1, 0x1749292F, 0xAFF54E4A, 0x322276F3, 0x8A9E1196, 0x982BBE78, 0x2097D91D,
+    0x78F4C94B, 0xC048AE2E, 0xD2FD01C0, 0x6A4166A5, 0xF7965E1C, 0x4F2A3979, 0x5D9F9697, 0xE523F1F2,
+    0x4D6B1905, 0xF5D77E60, 0xE762D18E, 0x5FDEB6EB, 0xC2098E52, 0x7AB5E937, 0x680046D9, 0xD0BC21BC,
+    0x88DF31EA, 0x3063568F, 0x22D6F961, 0x9A6A9E04, 0x07BDA6BD, 0xBF01C1D8, 0xADB46E36, 0x15080953,
+    0x1D724E9A, 0xA5CE29FF, 0xB77B8611, 0x0FC7E174, 0x9210D9CD, 0x2AACBEA8, 0x38191146, 0x80A57623,
+    0xD8C66675, 0x607A0110, 0x72CFAEFE, 0xCA73C99B, 0x57A4F122, 0xEF189647, 0xFDAD39A9, 0x45115ECC,
+    0x764DEE06, 0xCEF18963, 0xDC44268D, 0x64F841E8, 0xF92F7951, 0x41931E34, 0x5326B1DA, 0xEB9AD6BF,
+    0xB3F9C6E9, 0x0B45A18C, 0x19F00E62, 0xA14C6907, 0x3C9B51BE, 0x842736DB, 0x96929935, 0x2E2EFE50,
+    0x2654B999, 0x9EE8DEFC, 0x8C5D7112, 0x34E11677, 0xA9362ECE, 0x118A49AB, 0x033FE645, 0xBB838120,
+    0xE3E09176, 0x5B5CF613, 0x49E959FD, 0xF1553E98, 0x6C820621, 0xD43E6144, 0xC68BCEAA, 0x7E37A9CF,
+    0xD67F4138, 0x6EC3265D, 0x7C7689B3, 0xC4CAEED6, 0x591DD66F, 0xE1A1B10A, 0xF3141EE4, 0x4BA87981,
+    0x13CB69D7, 0xAB770EB2, 0xB9C2A15C, 0x017EC639, 0x9CA9FE80, 0x241599E5, 0x36A0360B, 0x8E1C516E,
+    0x866616A7, 0x3EDA71C2, 0x2C6FDE2C, 0x94D3B949, 0x090481F0, 0xB1B8E695, 0xA30D497B, 0x1BB12E1E,
+    0x43D23E48, 0xFB6E592D, 0xE9DBF6C3, 0x516791A6, 0xCCB0A91F, 0x740CCE7A, 0x66B96194, 0xDE0506F1
+  },
+  {
+    0x00000000, 0x3D6029B0, 0x7AC05360, 0x47A07AD0, 0xF580A6C0, 0xC8E08F70, 0x8F40F5A0, 0xB220DC10,
+    0x30704BC1, 0x0D106271, 0x4AB018A1, 0x77D03111, 0xC5F0ED01, 0xF890C4B1, 0xBF30BE61, 0x825097D1,
+    0x60E09782, 0x5D80BE32, 0x1A20C4E2, 0x2740ED52, 0x95603142, 0xA80018F2, 0xEFA06222, 0xD2C04B92,
+    0x5090DC43, 0x6DF0F5F3, 0x2A508F23, 0x1730A693, 0xA5107A83, 0x98705333, 0xDFD029E3, 0xE2B00053,
+    0xC1C12F04, 0xFCA106B4, 0xBB017C64, 0x866155D4, 0x344189C4, 0x0921A074, 0x4E81DAA4, 0x73E1F314,
+    0xF1B164C5, 0xCCD14D75, 0x8B7137A5, 0xB6111E15, 0x0431C205, 0x3951EBB5, 0x7EF19165, 0x4391B8D5,
+    0xA121B886, 0x9C419136, 0xDBE1EBE6, 0xE681C256, 0x54A11E46, 0x69C137F6, 0x2E614D26, 0x13016496,
+    0x9151F347, 0xAC31DAF7, 0xEB91A027, 0xD6F18997, 0x64D15587, 0x59B17C37, 0x1E1106E7, 0x23712F57,
+    0x58F35849, 0x659371F9, 0x22330B29, 0x1F532299, 0xAD73FE89, 0x9013D739, 0xD7B3ADE9, 0xEAD38459,
+    0x68831388, 0x55E33A38, 0x124340E8, 0x2F236958, 0x9D03B548, 0xA0639CF8, 0xE7C3E628, 0xDAA3CF98,
+    0x3813CFCB, 0x0573E67B, 0x42D39CAB, 0x7FB3B51B, 0xCD93690B, 0xF0F340BB, 0xB7533A6B, 0x8A3313DB,
+    0x0863840A, 0x3503ADBA, 0x72A3D76A, 0x4FC3FEDA, 0xFDE322CA, 0xC0830B7A, 0x872371AA, 0xBA43581A,
+    0x9932774D, 0xA4525EFD, 0xE3F2242D, 0xDE920D9D, 0x6CB2D18D, 0x51D2F83D, 0x167282ED, 0x2B12AB5D,
+    0xA9423C8C, 0x9422153C, 0xD3826FEC, 0xEEE2465C, 0x5CC29A4C, 0x61A2B3FC, 0x2602C92C, 0x1B62E09C,
+    0xF9D2E0CF, 0xC4B2C97F, 0x8312B3AF, 0xBE729A1F, 0x0C52460F, 0x31326FBF, 0x7692156F, 0x4BF23CDF,
+    0xC9A2AB0E, 0xF4C282BE, 0xB362F86E, 0x8E02D1DE, 0x3C220DCE, 0x0142247E, 0x46E25EAE, 0x7B82771E,
+    0xB1E6B092, 0x8C869922, 0xCB26E3F2, 0xF646CA42, 0x44661652, 0x79063FE2, 0x3EA64532, 0x03C66C82,
+    0x8196FB53, 0xBCF6D2E3, 0xFB56A833, 0xC6368183, 0x74165D93, 0x49767423, 0x0ED60EF3, 0x33B62743,
+    0xD1062710, 0xEC660EA0, 0xABC67470, 0x96A65DC0, 0x248681D0, 0x19E6A860, 0x5E46D2B0, 0x6326FB00,
+    0xE1766CD1, 0xDC164561, 0x9BB63FB1, 0xA6D61601, 0x14F6CA11, 0x2996E3A1, 0x6E369971, 0x5356B0C1,
+    0x70279F96, 0x4D47B626, 0x0AE7CCF6, 0x3787E546, 0x85A73956, 0xB8C710E6, 0xFF676A36, 0xC2074386,
+    0x4057D457, 0x7D37FDE7, 0x3A978737, 0x07F7AE87, 0xB5D77297, 0x88B75B27, 0xCF1721F7, 0xF2770847,
+    0x10C70814, 0x2DA721A4, 0x6A075B74, 0x576772C4, 0xE547AED4, 0xD8278764, 0x9F87FDB4, 0xA2E7D404,
+    0x20B743D5, 0x1DD76A65, 0x5A7710B5, 0x67173905, 0xD537E515, 0xE857CCA5, 0xAFF7B675, 0x92979FC5,
+    0xE915E8DB, 0xD475C16B, 0x93D5BBBB, 0xAEB5920B, 0x1C954E1B, 0x21F567AB, 0x66551D7B, 0x5B3534CB,
+    0xD965A31A, 0xE4058AAA, 0xA3A5F07A, 0x9EC5D9CA, 0x2CE505DA, 0x11852C6A, 0x562556BA, 0x6B457F0A,
+    0x89F57F59, 0xB49556E9, 0xF3352C39, 0xCE550589, 0x7C75D999, 0x4115F029, 0x06B58AF9, 0x3BD5A349,
+    0xB9853498, 0x84E51D28, 0xC34567F8, 0xFE254E48, 0x4C059258, 0x7165BBE8, 0x36C5C138, 0x0BA5E888,
+    0x28D4C7DF, 0x15B4EE6F, 0x521494BF, 0x6F74BD0F, 0xDD54611F, 0xE03448AF, 0xA794327F, 0x9AF41BCF,
+    0x18A48C1E, 0x25C4A5AE, 0x6264DF7E, 0x5F04F6CE, 0xED242ADE, 0xD044036E, 0x97E479BE, 0xAA84500E,
+    0x4834505D, 0x755479ED, 0x32F4033D, 0x0F942A8D, 0xBDB4F69D, 0x80D4DF2D, 0xC774A5FD, 0xFA148C4D,
+    0x78441B9C, 0x4524322C, 0x028448FC, 0x3FE4614C, 0x8DC4BD5C, 0xB0A494EC, 0xF704EE3C, 0xCA64C78C
+  },
+  {
+    0x00000000, 0xCB5CD3A5, 0x4DC8A10B, 0x869472AE, 0x9B914216, 0x50CD91B3, 0xD659E31D, 0x1D0530B8,
+    0xEC53826D, 0x270F51C8, 0xA19B2366, 0x6AC7F0C3, 0x77C2C07B, 0xBC9E13DE, 0x3A0A6170, 0xF156B2D5,
+    0x03D6029B, 0xC88AD13E, 0x4E1EA390, 0x85427035, 0x9847408D, 0x531B9328, 0xD58FE186, 0x1ED33223,
+    0xEF8580F6, 0x24D95353, 0xA24D21FD, 0x6911F258, 0x7414C2E0, 0xBF481145, 0x39DC63EB, 0xF280B04E,
+    0x07AC0536, 0xCCF0D693, 0x4A64A43D, 0x81387798, 0x9C3D4720, 0x57619485, 0xD1F5E62B, 0x1AA9358E,
+    0xEBFF875B, 0x20A354FE, 0xA6372650, 0x6D6BF5F5, 0x706EC54D, 0xBB3216E8, 0x3DA66446, 0xF6FAB7E3,
+    0x047A07AD, 0xCF26D408, 0x49B2A6A6, 0x82EE7503, 0x9FEB45BB, 0x54B7961E, 0xD223E4B0, 0x197F3715,
+    0xE82985C0, 0x23755665, 0xA5E124CB, 0x6EBDF76E, 0x73B8C7D6, 0xB8E41473, 0x3E7066DD, 0xF52CB578,
+    0x0F580A6C, 0xC404D9C9, 0x4290AB67, 0x89CC78C2, 0x94C9487A, 0x5F959BDF, 0xD901E971, 0x125D3AD4,
+    0xE30B8801, 0x28575BA4, 0xAEC3290A, 0x659FFAAF, 0x789ACA17, 0xB3C619B2, 0x35526B1C, 0xFE0EB8B9,
+    0x0C8E08F7, 0xC7D2DB52, 0x4146A9FC, 0x8A1A7A59, 0x971F4AE1, 0x5C439944, 0xDAD7EBEA, 0x118B384F,
+    0xE0DD8A9A, 0x2B81593F, 0xAD152B91, 0x6649F834, 0x7B4CC88C, 0xB0101B29, 0x36846987, 0xFDD8BA22,
+    0x08F40F5A, 0xC3A8DCFF, 0x453CAE51, 0x8E607DF4, 0x93654D4C, 0x58399EE9, 0xDEADEC47, 0x15F13FE2,
+    0xE4A78D37, 0x2FFB5E92, 0xA96F2C3C, 0x6233FF99, 0x7F36CF21, 0xB46A1C84, 0x32FE6E2A, 0xF9A2BD8F,
+    0x0B220DC1, 0xC07EDE64, 0x46EAACCA, 0x8DB67F6F, 0x90B34FD7, 0x5BEF9C72, 0xDD7BEEDC, 0x16273D79,
+    0xE7718FAC, 0x2C2D5C09, 0xAAB92EA7, 0x61E5FD02, 0x7CE0CDBA, 0xB7BC1E1F, 0x31286CB1, 0xFA74BF14,
+    0x1EB014D8, 0xD5ECC77D, 0x5378B5D3, 0x98246676, 0x852156CE, 0x4E7D856B, 0xC8E9F7C5, 0x03B52460,
+    0xF2E396B5, 0x39BF4510, 0xBF2B37BE, 0x7477E41B, 0x6972D4A3, 0xA22E0706, 0x24BA75A8, 0xEFE6A60D,
+    0x1D661643, 0xD63AC5E6, 0x50AEB748, 0x9BF264ED, 0x86F75455, 0x4DAB87F0, 0xCB3FF55E, 0x006326FB,
+    0xF135942E, 0x3A69478B, 0xBCFD3525, 0x77A1E680, 0x6AA4D638, 0xA1F8059D, 0x276C7733, 0xEC30A496,
+    0x191C11EE, 0xD240C24B, 0x54D4B0E5, 0x9F886340, 0x828D53F8, 0x49D1805D, 0xCF45F2F3, 0x04192156,
+    0xF54F9383, 0x3E134026, 0xB8873288, 0x73DBE12D, 0x6EDED195, 0xA5820230, 0x2316709E, 0xE84AA33B,
+    0x1ACA1375, 0xD196C0D0, 0x5702B27E, 0x9C5E61DB, 0x815B5163, 0x4A0782C6, 0xCC93F068, 0x07CF23CD,
+    0xF6999118, 0x3DC542BD, 0xBB513013, 0x700DE3B6, 0x6D08D30E, 0xA65400AB, 0x20C07205, 0xEB9CA1A0,
+    0x11E81EB4, 0xDAB4CD11, 0x5C20BFBF, 0x977C6C1A, 0x8A795CA2, 0x41258F07, 0xC7B1FDA9, 0x0CED2E0C,
+    0xFDBB9CD9, 0x36E74F7C, 0xB0733DD2, 0x7B2FEE77, 0x662ADECF, 0xAD760D6A, 0x2BE27FC4, 0xE0BEAC61,
+    0x123E1C2F, 0xD962CF8A, 0x5FF6BD24, 0x94AA6E81, 0x89AF5E39, 0x42F38D9C, 0xC467FF32, 0x0F3B2C97,
+    0xFE6D9E42, 0x35314DE7, 0xB3A53F49, 0x78F9ECEC, 0x65FCDC54, 0xAEA00FF1, 0x28347D5F, 0xE368AEFA,
+    0x16441B82, 0xDD18C827, 0x5B8CBA89, 0x90D0692C, 0x8DD55994, 0x46898A31, 0xC01DF89F, 0x0B412B3A,
+    0xFA1799EF, 0x314B4A4A, 0xB7DF38E4, 0x7C83EB41, 0x6186DBF9, 0xAADA085C, 0x2C4E7AF2, 0xE712A957,
+    0x15921919, 0xDECECABC, 0x585AB812, 0x93066BB7, 0x8E035B0F, 0x455F88AA, 0xC3CBFA04, 0x089729A1,
+    0xF9C19B74, 0x329D48D1, 0xB4093A7F, 0x7F55E9DA, 0x6250D962, 0xA90C0AC7, 0x2F987869, 0xE4C4ABCC
+  },
+  {
+    0x00000000, 0xA6770BB4, 0x979F1129, 0x31E81A9D, 0xF44F2413, 0x52382FA7, 0x63D0353A, 0xC5A73E8E,
+    0x33EF4E67, 0x959845D3, 0xA4705F4E, 0x020754FA, 0xC7A06A74, 0x61D761C0, 0x503F7B5D, 0xF64870E9,
+    0x67DE9CCE, 0xC1A9977A, 0xF0418DE7, 0x56368653, 0x9391B8DD, 0x35E6B369, 0x040EA9F4, 0xA279A240,
+    0x5431D2A9, 0xF246D91D, 0xC3AEC380, 0x65D9C834, 0xA07EF6BA, 0x0609FD0E, 0x37E1E793, 0x9196EC27,
+    0xCFBD399C, 0x69CA3228, 0x582228B5, 0xFE552301, 0x3BF21D8F, 0x9D85163B, 0xAC6D0CA6, 0x0A1A0712,
+    0xFC5277FB, 0x5A257C4F, 0x6BCD66D2, 0xCDBA6D66, 0x081D53E8, 0xAE6A585C, 0x9F8242C1, 0x39F54975,
+    0xA863A552, 0x0E14AEE6, 0x3FFCB47B, 0x998BBFCF, 0x5C2C8141, 0xFA5B8AF5, 0xCBB39068, 0x6DC49BDC,
+    0x9B8CEB35, 0x3DFBE081, 0x0C13FA1C, 0xAA64F1A8, 0x6FC3CF26, 0xC9B4C492, 0xF85CDE0F, 0x5E2BD5BB,
+    0x440B7579, 0xE27C7ECD, 0xD3946450, 0x75E36FE4, 0xB044516A, 0x16335ADE, 0x27DB4043, 0x81AC4BF7,
+    0x77E43B1E, 0xD19330AA, 0xE07B2A37, 0x460C2183, 0x83AB1F0D, 0x25DC14B9, 0x14340E24, 0xB2430590,
+    0x23D5E9B7, 0x85A2E203, 0xB44AF89E, 0x123DF32A, 0xD79ACDA4, 0x71EDC610, 0x4005DC8D, 0xE672D739,
+    0x103AA7D0, 0xB64DAC64, 0x87A5B6F9, 0x21D2BD4D, 0xE47583C3, 0x42028877, 0x73EA92EA, 0xD59D995E,
+    0x8BB64CE5, 0x2DC14751, 0x1C295DCC, 0xBA5E5678, 0x7FF968F6, 0xD98E6342, 0xE86679DF, 0x4E11726B,
+    0xB8590282, 0x1E2E0936, 0x2FC613AB, 0x89B1181F, 0x4C162691, 0xEA612D25, 0xDB8937B8, 0x7DFE3C0C,
+    0xEC68D02B, 0x4A1FDB9F, 0x7BF7C102, 0xDD80CAB6, 0x1827F438, 0xBE50FF8C, 0x8FB8E511, 0x29CFEEA5,
+    0xDF879E4C, 0x79F095F8, 0x48188F65, 0xEE6F84D1, 0x2BC8BA5F, 0x8DBFB1EB, 0xBC57AB76, 0x1A20A0C2,
+    0x8816EAF2, 0x2E61E146, 0x1F89FBDB, 0xB9FEF06F, 0x7C59CEE1, 0xDA2EC555, 0xEBC6DFC8, 0x4DB1D47C,
+    0xBBF9A495, 0x1D8EAF21, 0x2C66B5BC, 0x8A11BE08, 0x4FB68086, 0xE9C18B32, 0xD82991AF, 0x7E5E9A1B,
+    0xEFC8763C, 0x49BF7D88, 0x78576715, 0xDE206CA1, 0x1B87522F, 0xBDF0599B, 0x8C184306, 0x2A6F48B2,
+    0xDC27385B, 0x7A5033EF, 0x4BB82972, 0xEDCF22C6, 0x28681C48, 0x8E1F17FC, 0xBFF70D61, 0x198006D5,
+    0x47ABD36E, 0xE1DCD8DA, 0xD034C247, 0x7643C9F3, 0xB3E4F77D, 0x1593FCC9, 0x247BE654, 0x820CEDE0,
+    0x74449D09, 0xD23396BD, 0xE3DB8C20, 0x45AC8794, 0x800BB91A, 0x267CB2AE, 0x1794A833, 0xB1E3A387,
+    0x20754FA0, 0x86024414, 0xB7EA5E89, 0x119D553D, 0xD43A6BB3, 0x724D6007, 0x43A57A9A, 0xE5D2712E,
+    0x139A01C7, 0xB5ED0A73, 0x840510EE, 0x22721B5A, 0xE7D525D4, 0x41A22E60, 0x704A34FD, 0xD63D3F49,
+    0xCC1D9F8B, 0x6A6A943F, 0x5B828EA2, 0xFDF58516, 0x3852BB98, 0x9E25B02C, 0xAFCDAAB1, 0x09BAA105,
+    0xFFF2D1EC, 0x5985DA58, 0x686DC0C5, 0xCE1ACB71, 0x0BBDF5FF, 0xADCAFE4B, 0x9C22E4D6, 0x3A55EF62,
+    0xABC30345, 0x0DB408F1, 0x3C5C126C, 0x9A2B19D8, 0x5F8C2756, 0xF9FB2CE2, 0xC813367F, 0x6E643DCB,
+    0x982C4D22, 0x3E5B4696, 0x0FB35C0B, 0xA9C457BF, 0x6C636931, 0xCA146285, 0xFBFC7818, 0x5D8B73AC,
+    0x03A0A617, 0xA5D7ADA3, 0x943FB73E, 0x3248BC8A, 0xF7EF8204, 0x519889B0, 0x6070932D, 0xC6079899,
+    0x304FE870, 0x9638E3C4, 0xA7D0F959, 0x01A7F2ED, 0xC400CC63, 0x6277C7D7, 0x539FDD4A, 0xF5E8D6FE,
+    0x647E3AD9, 0xC209316D, 0xF3E12BF0, 0x55962044, 0x90311ECA, 0x3646157E, 0x07AE0FE3, 0xA1D90457,
+    0x579174BE, 0xF1E67F0A, 0xC00E6597, 0x66796E23, 0xA3DE50AD, 0x05A95B19, 0x34414184, 0x92364A30
+  },
+  {
+    0x00000000, 0xCCAA009E, 0x4225077D, 0x8E8F07E3, 0x844A0EFA, 0x48E00E64, 0xC66F0987, 0x0AC50919,
+    0xD3E51BB5, 0x1F4F1B2B, 0x91C01CC8, 0x5D6A1C56, 0x57AF154F, 0x9B0515D1, 0x158A1232, 0xD92012AC,
+    0x7CBB312B, 0xB01131B5, 0x3E9E3656, 0xF23436C8, 0xF8F13FD1, 0x345B3F4F, 0xBAD438AC, 0x767E3832,
+    0xAF5E2A9E, 0x63F42A00, 0xED7B2DE3, 0x21D12D7D, 0x2B142464, 0xE7BE24FA, 0x69312319, 0xA59B2387,
+    0xF9766256, 0x35DC62C8, 0xBB53652B, 0x77F965B5, 0x7D3C6CAC, 0xB1966C32, 0x3F196BD1, 0xF3B36B4F,
+    0x2A9379E3, 0xE639797D, 0x68B67E9E, 0xA41C7E00, 0xAED97719, 0x62737787, 0xECFC7064, 0x205670FA,
+    0x85CD537D, 0x496753E3, 0xC7E85400, 0x0B42549E, 0x01875D87, 0xCD2D5D19, 0x43A25AFA, 0x8F085A64,
+    0x562848C8, 0x9A824856, 0x140D4FB5, 0xD8A74F2B, 0xD2624632, 0x1EC846AC, 0x9047414F, 0x5CED41D1,
+    0x299DC2ED, 0xE537C273, 0x6BB8C590, 0xA712C50E, 0xADD7CC17, 0x617DCC89, 0xEFF2CB6A, 0x2358CBF4,
+    0xFA78D958, 0x36D2D9C6, 0xB85DDE25, 0x74F7DEBB, 0x7E32D7A2, 0xB298D73C, 0x3C17D0DF, 0xF0BDD041,
+    0x5526F3C6, 0x998CF358, 0x1703F4BB, 0xDBA9F425, 0xD16CFD3C, 0x1DC6FDA2, 0x9349FA41, 0x5FE3FADF,
+    0x86C3E873, 0x4A69E8ED, 0xC4E6EF0E, 0x084CEF90, 0x0289E689, 0xCE23E617, 0x40ACE1F4, 0x8C06E16A,
+    0xD0EBA0BB, 0x1C41A025, 0x92CEA7C6, 0x5E64A758, 0x54A1AE41, 0x980BAEDF, 0x1684A93C, 0xDA2EA9A2,
+    0x030EBB0E, 0xCFA4BB90, 0x412BBC73, 0x8D81BCED, 0x8744B5F4, 0x4BEEB56A, 0xC561B289, 0x09CBB217,
+    0xAC509190, 0x60FA910E, 0xEE7596ED, 0x22DF9673, 0x281A9F6A, 0xE4B09FF4, 0x6A3F9817, 0xA6959889,
+    0x7FB58A25, 0xB31F8ABB, 0x3D908D58, 0xF13A8DC6, 0xFBFF84DF, 0x37558441, 0xB9DA83A2, 0x7570833C,
+    0x533B85DA, 0x9F918544, 0x111E82A7, 0xDDB48239, 0xD7718B20, 0x1BDB8BBE, 0x95548C5D, 0x59FE8CC3,
+    0x80DE9E6F, 0x4C749EF1, 0xC2FB9912, 0x0E51998C, 0x04949095, 0xC83E900B, 0x46B197E8, 0x8A1B9776,
+    0x2F80B4F1, 0xE32AB46F, 0x6DA5B38C, 0xA10FB312, 0xABCABA0B, 0x6760BA95, 0xE9EFBD76, 0x2545BDE8,
+    0xFC65AF44, 0x30CFAFDA, 0xBE40A839, 0x72EAA8A7, 0x782FA1BE, 0xB485A120, 0x3A0AA6C3, 0xF6A0A65D,
+    0xAA4DE78C, 0x66E7E712, 0xE868E0F1, 0x24C2E06F, 0x2E07E976, 0xE2ADE9E8, 0x6C22EE0B, 0xA088EE95,
+    0x79A8FC39, 0xB502FCA7, 0x3B8DFB44, 0xF727FBDA, 0xFDE2F2C3, 0x3148F25D, 0xBFC7F5BE, 0x736DF520,
+    0xD6F6D6A7, 0x1A5CD639, 0x94D3D1DA, 0x5879D144, 0x52BCD85D, 0x9E16D8C3, 0x1099DF20, 0xDC33DFBE,
+    0x0513CD12, 0xC9B9CD8C, 0x4736CA6F, 0x8B9CCAF1, 0x8159C3E8, 0x4DF3C376, 0xC37CC495, 0x0FD6C40B,
+    0x7AA64737, 0xB60C47A9, 0x3883404A, 0xF42940D4, 0xFEEC49CD, 0x32464953, 0xBCC94EB0, 0x70634E2E,
+    0xA9435C82, 0x65E95C1C, 0xEB665BFF, 0x27CC5B61, 0x2D095278, 0xE1A352E6, 0x6F2C5505, 0xA386559B,
+    0x061D761C, 0xCAB77682, 0x44387161, 0x889271FF, 0x825778E6, 0x4EFD7878, 0xC0727F9B, 0x0CD87F05,
+    0xD5F86DA9, 0x19526D37, 0x97DD6AD4, 0x5B776A4A, 0x51B26353, 0x9D1863CD, 0x1397642E, 0xDF3D64B0,
+    0x83D02561, 0x4F7A25FF, 0xC1F5221C, 0x0D5F2282, 0x079A2B9B, 0xCB302B05, 0x45BF2CE6, 0x89152C78,
+    0x50353ED4, 0x9C9F3E4A, 0x121039A9, 0xDEBA3937, 0xD47F302E, 0x18D530B0, 0x965A3753, 0x5AF037CD,
+    0xFF6B144A, 0x33C114D4, 0xBD4E1337, 0x71E413A9, 0x7B211AB0, 0xB78B1A2E, 0x39041DCD, 0xF5AE1D53,
+    0x2C8E0FFF, 0xE0240F61, 0x6EAB0882, 0xA201081C, 0xA8C40105, 0x646E019B, 0xEAE10678, 0x264B06E6
+  }
+#endif
+};
+#endif
+
+/* CRC32C byte table, 0x82F63B78 */
+static const uint32_t FLASHMAN_Crc32cTable[256] =
+{
+  0x00000000, 0xF26B8303, 0xE13B70F7, 0x1350F3F4, 0xC79A971F, 0x35F1141C, 0x26A1E7E8, 0xD4CA64EB,
+  0x8AD958CF, 0x78B2DBCC, 0x6BE22838, 0x9989AB3B, 0x4D43CFD0, 0xBF284CD3, 0xAC78BF27, 0x5E133C24,
+  0x105EC76F, 0xE235446C, 0xF165B798, 0x030E349B, 0xD7C45070, 0x25AFD373, 0x36FF2087, 0xC494A384,
+  0x9A879FA0, 0x68EC1CA3, 0x7BBCEF57, 0x89D76C54, 0x5D1D08BF, 0xAF768BBC, 0xBC267848, 0x4E4DFB4B,
+  0x20BD8EDE, 0xD2D60DDD, 0xC186FE29, 0x33ED7D2A, 0xE72719C1, 0x154C9AC2, 0x061C6936, 0xF477EA35,
+  0xAA64D611, 0x580F5512, 0x4B5FA6E6, 0xB93425E5, 0x6DFE410E, 0x9F95C20D, 0x8CC531F9, 0x7EAEB2FA,
+  0x30E349B1, 0xC288CAB2, 0xD1D83946, 0x23B3BA45, 0xF779DEAE, 0x05125DAD, 0x1642AE59, 0xE4292D5A,
+  0xBA3A117E, 0x4851927D, 0x5B016189, 0xA96AE28A, 0x7DA08661, 0x8FCB0562, 0x9C9BF696, 0x6EF07595,
+  0x417B1DBC, 0xB3109EBF, 0xA0406D4B, 0x522BEE48, 0x86E18AA3, 0x748A09A0, 0x67DAFA54, 0x95B17957,
+  0xCBA24573, 0x39C9C670, 0x2A993584, 0xD8F2B687, 0x0C38D26C, 0xFE53516F, 0xED03A29B, 0x1F682198,
+  0x5125DAD3, 0xA34E59D0, 0xB01EAA24, 0x42752927, 0x96BF4DCC, 0x64D4CECF, 0x77843D3B, 0x85EFBE38,
+  0xDBFC821C, 0x2997011F, 0x3AC7F2EB, 0xC8AC71E8, 0x1C661503, 0xEE0D9600, 0xFD5D65F4, 0x0F36E6F7,
+  0x61C69362, 0x93AD1061, 0x80FDE395, 0x72966096, 0xA65C047D, 0x5437877E, 0x4767748A, 0xB50CF789,
+  0xEB1FCBAD, 0x197448AE, 0x0A24BB5A, 0xF84F3859, 0x2C855CB2, 0xDEEEDFB1, 0xCDBE2C45, 0x3FD5AF46,
+  0x7198540D, 0x83F3D70E, 0x90A324FA, 0x62C8A7F9, 0xB602C312, 0x44694011, 0x5739B3E5, 0xA55230E6,
+  0xFB410CC2, 0x092A8FC1, 0x1A7A7C35, 0xE811FF36, 0x3CDB9BDD, 0xCEB018DE, 0xDDE0EB2A, 0x2F8B6829,
+  0x82F63B78, 0x709DB87B, 0x63CD4B8F, 0x91A6C88C, 0x456CAC67, 0xB7072F64, 0xA457DC90, 0x563C5F93,
+  0x082F63B7, 0xFA44E0B4, 0xE9141340, 0x1B7F9043, 0xCFB5F4A8, 0x3DDE77AB, 0x2E8E845F, 0xDCE5075C,
+  0x92A8FC17, 0x60C37F14, 0x73938CE0, 0x81F80FE3, 0x55326B08, 0xA759E80B, 0xB4091BFF, 0x466298FC,
+  0x1871A4D8, 0xEA1A27DB, 0xF94AD42F, 0x0B21572C, 0xDFEB33C7, 0x2D80B0C4, 0x3ED04330, 0xCCBBC033,
+  0xA24BB5A6, 0x502036A5, 0x4370C551, 0xB11B4652, 0x65D122B9, 0x97BAA1BA, 0x84EA524E, 0x7681D14D,
+  0x2892ED69, 0xDAF96E6A, 0xC9A99D9E, 0x3BC21E9D, 0xEF087A76, 0x1D63F975, 0x0E330A81, 0xFC588982,
+  0xB21572C9, 0x407EF1CA, 0x532E023E, 0xA145813D, 0x758FE5D6, 0x87E466D5, 0x94B49521, 0x66DF1622,
+  0x38CC2A06, 0xCAA7A905, 0xD9F75AF1, 0x2B9CD9F2, 0xFF56BD19, 0x0D3D3E1A, 0x1E6DCDEE, 0xEC064EED,
+  0xC38D26C4, 0x31E6A5C7, 0x22B65633, 0xD0DDD530, 0x0417B1DB, 0xF67C32D8, 0xE52CC12C, 0x1747422F,
+  0x49547E0B, 0xBB3FFD08, 0xA86F0EFC, 0x5A048DFF, 0x8ECEE914, 0x7CA56A17, 0x6FF599E3, 0x9D9E1AE0,
+  0xD3D3E1AB, 0x21B862A8, 0x32E8915C, 0xC083125F, 0x144976B4, 0xE622F5B7, 0xF5720643, 0x07198540,
+  0x590AB964, 0xAB613A67, 0xB831C993, 0x4A5A4A90, 0x9E902E7B, 0x6CFBAD78, 0x7FAB5E8C, 0x8DC0DD8F,
+  0xE330A81A, 0x115B2B19, 0x020BD8ED, 0xF0605BEE, 0x24AA3F05, 0xD6C1BC06, 0xC5914FF2, 0x37FACCF1,
+  0x69E9F0D5, 0x9B8273D6, 0x88D28022, 0x7AB90321, 0xAE7367CA, 0x5C18E4C9, 0x4F48173D, 0xBD23943E,
+  0xF36E6F75, 0x0105EC76, 0x12551F82, 0xE03E9C81, 0x34F4F86A, 0xC69F7B69, 0xD5CF889D, 0x27A40B9E,
+  0x79B737BA, 0x8BDCB4B9, 0x988C474D, 0x6AE7C44E, 0xBE2DA0A5, 0x4C4623A6, 0x5F16D052, 0xAD7D5351
+};
+
+static const uint32_t FLASHMAN_Sha256K[64] =
+{
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
 
 static void FLASHMAN_Delay(uint32_t Delay)
 {
@@ -59,10 +506,23 @@ static void FLASHMAN_Delay(uint32_t Delay)
 
 static void FLASHMAN_Lock(FLASHMAN_HandleTypeDef *Handle)
 {
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+  if (Handle->Lock)
+  {
+    uint32_t startTime = FLASHMAN_TIME_US();
+    while (Handle->Lock)
+    {
+      FLASHMAN_Delay(1);
+    }
+    Handle->Stats.LockWaits++;
+    Handle->Stats.LockWaitUs += FLASHMAN_TIME_US() - startTime;
+  }
+#else
   while (Handle->Lock)
   {
     FLASHMAN_Delay(1);
   }
+#endif
   Handle->Lock = 1;
 }
 
@@ -71,132 +531,295 @@ static void FLASHMAN_UnLock(FLASHMAN_HandleTypeDef *Handle)
   Handle->Lock = 0;
 }
 
-static void FLASHMAN_CsPin(FLASHMAN_HandleTypeDef *Handle, bool Select)
+/* false only if the frame was gathered and sending it failed (spidev) */
+static bool FLASHMAN_CsPin(FLASHMAN_HandleTypeDef *Handle, bool Select)
 {
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+  /* the kernel drives CS, a frame ends with the message carrying it */
+  if (Select && ((Handle->MsgCnt > 0) || Handle->MsgHeld))
+  {
+    return FLASHMAN_MsgSend(Handle, false);
+  }
+  return true;
+#else
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_ENABLE
+  if (Select == 0)
+  {
+    FLASHMAN_Clock(Handle, Handle->CmdPrescaler);
+  }
+#endif
   HAL_GPIO_WritePin(Handle->gpio, Handle->Pin, (GPIO_PinState)Select);
   for (int i = 0; i < 10; i++);
+  return true;
+#endif
 }
 
-static bool FLASHMAN_TransmitReceive(FLASHMAN_HandleTypeDef *Handle, uint8_t *Tx, uint8_t *Rx, size_t Size, uint32_t Timeout)
+/* select for a READ frame, it can have its own clock */
+static void FLASHMAN_CsPinRead(FLASHMAN_HandleTypeDef *Handle)
 {
-  bool retVal = false;
-#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL)
-  if (HAL_SPI_TransmitReceive(Handle->hspi, Tx, Rx, Size, Timeout) == HAL_OK)
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+  (void)Handle;
+#else
+  FLASHMAN_CAL(FLASHMAN_Clock(Handle, Handle->ReadPrescaler));
+  HAL_GPIO_WritePin(Handle->gpio, Handle->Pin, GPIO_PIN_RESET);
+  for (int i = 0; i < 10; i++);
+#endif
+}
+
+/* deselect when the next frame belongs to the same operation (write enable), spidev sends both in one message */
+static bool FLASHMAN_CsPinNext(FLASHMAN_HandleTypeDef *Handle)
+{
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+  if (Handle->MsgCnt > 0)
   {
-    retVal = true;
+    Handle->Msg[Handle->MsgCnt - 1].cs_change = 1;
+    return true;
   }
-  else
+#endif
+  return FLASHMAN_CsPin(Handle, 1);
+}
+
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_ENABLE
+static void FLASHMAN_Clock(FLASHMAN_HandleTypeDef *Handle, uint32_t Prescaler)
+{
+  if (Handle->hspi->Init.BaudRatePrescaler != Prescaler)
   {
-    dprintf("FLASHMAN TIMEOUT\r\n");
+    Handle->hspi->Init.BaudRatePrescaler = Prescaler;
+    HAL_SPI_Init(Handle->hspi);
   }
-#elif (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL_DMA)
+}
+#endif
+
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL_DMA)
+/* short frames finish within the tick they started in, so only sleep once a tick has passed */
+static bool FLASHMAN_DmaWait(FLASHMAN_HandleTypeDef *Handle, uint32_t Timeout)
+{
+  bool retVal = false;
   uint32_t startTime = HAL_GetTick();
-  if (HAL_SPI_TransmitReceive_DMA(Handle->hspi, Tx, Rx, Size) != HAL_OK)
-  {
-    dprintf("FLASHMAN TRANSFER ERROR\r\n");
-  }
-  else
+  while (1)
   {
-    while (1)
+    if (HAL_SPI_GetState(Handle->hspi) == HAL_SPI_STATE_READY)
+    {
+      retVal = true;
+      break;
+    }
+    if (HAL_GetTick() - startTime >= Timeout)
+    {
+      dprintf("FLASHMAN TIMEOUT\r\n");
+      HAL_SPI_DMAStop(Handle->hspi);
+      break;
+    }
+    if (HAL_GetTick() != startTime)
     {
       FLASHMAN_Delay(1);
-      if (HAL_GetTick() - startTime >= Timeout)
-      {
-        dprintf("FLASHMAN TIMEOUT\r\n");
-        HAL_SPI_DMAStop(Handle->hspi);
-        break;
-      }
-      if (HAL_SPI_GetState(Handle->hspi) == HAL_SPI_STATE_READY)
-      {
-        retVal = true;
-        break;
-      }
     }
   }
-#endif
   return retVal;
 }
+#endif
 
-static bool FLASHMAN_Transmit(FLASHMAN_HandleTypeDef *Handle, uint8_t *Tx, size_t Size, uint32_t Timeout)
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+/* append to the next message, a full message goes out with CS kept asserted */
+static bool FLASHMAN_MsgAdd(FLASHMAN_HandleTypeDef *Handle, const uint8_t *Tx, uint8_t *Rx, uint32_t Size)
 {
-  bool retVal = false;
-#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL)
-  if (HAL_SPI_Transmit(Handle->hspi, Tx, Size, Timeout) == HAL_OK)
+  bool retVal = true;
+  struct spi_ioc_transfer *xfer;
+  uint32_t length;
+  while ((Size > 0) && retVal)
   {
-    retVal = true;
+    if ((Handle->MsgCnt == FLASHMAN_SPIDEV_XFERS) || (Handle->MsgBytes == FLASHMAN_SPIDEV_BUFSIZ))
+    {
+      retVal = FLASHMAN_MsgSend(Handle, true);
+      continue;
+    }
+    length = FLASHMAN_SPIDEV_BUFSIZ - Handle->MsgBytes;
+    if (length > Size)
+    {
+      length = Size;
+    }
+    xfer = &Handle->Msg[Handle->MsgCnt];
+    memset(xfer, 0, sizeof(struct spi_ioc_transfer));
+    xfer->tx_buf = (uintptr_t)Tx;
+    xfer->rx_buf = (uintptr_t)Rx;
+    xfer->len = length;
+    xfer->speed_hz = Handle->hspi->SpeedHz;
+    xfer->bits_per_word = 8;
+    if ((Tx != NULL) && (Rx == NULL) && (length <= FLASHMAN_HEADER_MAX))
+    {
+      memcpy(Handle->MsgTx[Handle->MsgCnt], Tx, length);
+      xfer->tx_buf = (uintptr_t)Handle->MsgTx[Handle->MsgCnt];
+    }
+    Handle->MsgCnt++;
+    Handle->MsgBytes += length;
+    Tx = (Tx != NULL) ? Tx + length : NULL;
+    Rx = (Rx != NULL) ? Rx + length : NULL;
+    Size -= length;
   }
-  else
+  return retVal;
+}
+
+/* one SPI_IOC_MESSAGE of the gathered transfers, Hold leaves CS asserted for the rest of the frame */
+static bool FLASHMAN_MsgSend(FLASHMAN_HandleTypeDef *Handle, bool Hold)
+{
+  bool retVal;
+  if (Handle->MsgCnt == 0)
   {
-    dprintf("FLASHMAN TIMEOUT\r\n");
+    /* nothing left but releasing CS */
+    memset(&Handle->Msg[0], 0, sizeof(struct spi_ioc_transfer));
+    Handle->MsgCnt = 1;
   }
-#elif (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL_DMA)
-  uint32_t startTime = HAL_GetTick();
-  if (HAL_SPI_Transmit_DMA(Handle->hspi, Tx, Size) != HAL_OK)
+  Handle->Msg[Handle->MsgCnt - 1].cs_change = Hold;
+  retVal = FLASHMAN_SpidevMessage(Handle->hspi, Handle->Msg, Handle->MsgCnt);
+  if (retVal == false)
   {
     dprintf("FLASHMAN TRANSFER ERROR\r\n");
   }
-  else
+  Handle->MsgCnt = 0;
+  Handle->MsgBytes = 0;
+  Handle->MsgHeld = Hold;
+  return retVal;
+}
+#endif
+
+/* HAL transfer sizes are 16 bit, longer frames go out as several calls under the same CS */
+static bool FLASHMAN_TransmitReceive(FLASHMAN_HandleTypeDef *Handle, uint8_t *Tx, uint8_t *Rx, size_t Size, uint32_t Timeout)
+{
+  bool retVal = true;
+  uint16_t length;
+  while ((Size > 0) && retVal)
   {
-    while (1)
+    length = (Size > FLASHMAN_HAL_CHUNK) ? FLASHMAN_HAL_CHUNK : Size;
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL)
+    if (HAL_SPI_TransmitReceive(Handle->hspi, Tx, Rx, length, Timeout) != HAL_OK)
     {
-      FLASHMAN_Delay(1);
-      if (HAL_GetTick() - startTime >= Timeout)
-      {
-        dprintf("FLASHMAN TIMEOUT\r\n");
-        HAL_SPI_DMAStop(Handle->hspi);
-        break;
-      }
-      if (HAL_SPI_GetState(Handle->hspi) == HAL_SPI_STATE_READY)
-      {
-        retVal = true;
-        break;
-      }
+      retVal = false;
+      dprintf("FLASHMAN TIMEOUT\r\n");
+    }
+#elif (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL_DMA)
+    if (HAL_SPI_TransmitReceive_DMA(Handle->hspi, Tx, Rx, length) != HAL_OK)
+    {
+      retVal = false;
+      dprintf("FLASHMAN TRANSFER ERROR\r\n");
+    }
+    else
+    {
+      retVal = FLASHMAN_DmaWait(Handle, Timeout);
     }
+#elif (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+    (void)Timeout;
+    retVal = FLASHMAN_MsgAdd(Handle, Tx, Rx, length);
+#endif
+    Tx += length;
+    Rx += length;
+    Size -= length;
   }
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+  /* the caller looks at the data before CS goes up */
+  retVal = retVal && FLASHMAN_MsgSend(Handle, false);
 #endif
   return retVal;
 }
 
-static bool FLASHMAN_Receive(FLASHMAN_HandleTypeDef *Handle, uint8_t *Rx, size_t Size, uint32_t Timeout)
+static bool FLASHMAN_Transmit(FLASHMAN_HandleTypeDef *Handle, uint8_t *Tx, size_t Size, uint32_t Timeout)
 {
-  bool retVal = false;
-#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL)
-  if (HAL_SPI_Receive(Handle->hspi, Rx, Size, Timeout) == HAL_OK)
-  {
-    retVal = true;
-  }
-  else
+  bool retVal = true;
+  uint16_t length;
+  while ((Size > 0) && retVal)
   {
-    dprintf("FLASHMAN TIMEOUT\r\n");
-  }
+    length = (Size > FLASHMAN_HAL_CHUNK) ? FLASHMAN_HAL_CHUNK : Size;
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL)
+    if (HAL_SPI_Transmit(Handle->hspi, Tx, length, Timeout) != HAL_OK)
+    {
+      retVal = false;
+      dprintf("FLASHMAN TIMEOUT\r\n");
+    }
 #elif (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL_DMA)
-  uint32_t startTime = HAL_GetTick();
-  if (HAL_SPI_Receive_DMA(Handle->hspi, Rx, Size) != HAL_OK)
-  {
-    dprintf("FLASHMAN TRANSFER ERROR\r\n");
+    if (HAL_SPI_Transmit_DMA(Handle->hspi, Tx, length) != HAL_OK)
+    {
+      retVal = false;
+      dprintf("FLASHMAN TRANSFER ERROR\r\n");
+    }
+    else
+    {
+      retVal = FLASHMAN_DmaWait(Handle, Timeout);
+    }
+#elif (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+    (void)Timeout;
+    retVal = FLASHMAN_MsgAdd(Handle, Tx, NULL, length);
+#endif
+    Tx += length;
+    Size -= length;
   }
-  else
+  return retVal;
+}
+
+static bool FLASHMAN_Receive(FLASHMAN_HandleTypeDef *Handle, uint8_t *Rx, size_t Size, uint32_t Timeout)
+{
+  bool retVal = true;
+  uint16_t length;
+  while ((Size > 0) && retVal)
   {
-    while (1)
+    length = (Size > FLASHMAN_HAL_CHUNK) ? FLASHMAN_HAL_CHUNK : Size;
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL)
+    if (HAL_SPI_Receive(Handle->hspi, Rx, length, Timeout) != HAL_OK)
     {
-      FLASHMAN_Delay(1);
-      if (HAL_GetTick() - startTime >= Timeout)
-      {
-        dprintf("FLASHMAN TIMEOUT\r\n");
-        HAL_SPI_DMAStop(Handle->hspi);
-        break;
-      }
-      if (HAL_SPI_GetState(Handle->hspi) == HAL_SPI_STATE_READY)
-      {
-        retVal = true;
-        break;
-      }
+      retVal = false;
+      dprintf("FLASHMAN TIMEOUT\r\n");
+    }
+#elif (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL_DMA)
+    if (HAL_SPI_Receive_DMA(Handle->hspi, Rx, length) != HAL_OK)
+    {
+      retVal = false;
+      dprintf("FLASHMAN TRANSFER ERROR\r\n");
+    }
+    else
+    {
+      retVal = FLASHMAN_DmaWait(Handle, Timeout);
     }
+#elif (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+    (void)Timeout;
+    retVal = FLASHMAN_MsgAdd(Handle, NULL, Rx, length);
+#endif
+    Rx += length;
+    Size -= length;
   }
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+  retVal = retVal && FLASHMAN_MsgSend(Handle, false);
 #endif
   return retVal;
 }
 
+/* one chunk of a streamed read. With DMA it is still running on return, without it the transfer is already done.
+   More tells that another chunk follows under the same CS. A chunk can be FLASHMAN_HAL_CHUNK long, so it gets
+   the timeout of FLASHMAN_ReadFn() */
+static bool FLASHMAN_ReceiveStart(FLASHMAN_HandleTypeDef *Handle, uint8_t *Rx, uint32_t Size, bool More)
+{
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL_DMA)
+  (void)More;
+  if (HAL_SPI_Receive_DMA(Handle->hspi, Rx, (uint16_t)Size) != HAL_OK)
+  {
+    dprintf("FLASHMAN TRANSFER ERROR\r\n");
+    return false;
+  }
+  return true;
+#elif (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV)
+  return FLASHMAN_MsgAdd(Handle, NULL, Rx, Size) && FLASHMAN_MsgSend(Handle, More);
+#else
+  (void)More;
+  return FLASHMAN_Receive(Handle, Rx, Size, 2000);
+#endif
+}
+
+static bool FLASHMAN_ReceiveWait(FLASHMAN_HandleTypeDef *Handle)
+{
+#if (FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_HAL_DMA)
+  return FLASHMAN_DmaWait(Handle, 2000);
+#else
+  (void)Handle;
+  return true;
+#endif
+}
+
 static bool FLASHMAN_WriteEnable(FLASHMAN_HandleTypeDef *Handle)
 {
   bool retVal = true;
@@ -207,7 +830,11 @@ static bool FLASHMAN_WriteEnable(FLASHMAN_HandleTypeDef *Handle)
     retVal = false;
     dprintf("FLASHMAN_WriteEnable() Error\r\n");
   }
-  FLASHMAN_CsPin(Handle, 1);
+  /* the program/erase frame follows */
+  if (FLASHMAN_CsPinNext(Handle) == false)
+  {
+    retVal = false;
+  }
   return retVal;
 }
 
@@ -216,12 +843,12 @@ static bool FLASHMAN_WriteDisable(FLASHMAN_HandleTypeDef *Handle)
   bool retVal = true;
   uint8_t tx[1] = {FLASHMAN_CMD_WRITEDISABLE};
   FLASHMAN_CsPin(Handle, 0);
-  if (FLASHMAN_Transmit(Handle, tx, 1, 100) == false)
+  if ((FLASHMAN_Transmit(Handle, tx, 1, 100) == false) || (FLASHMAN_CsPin(Handle, 1) == false))
   {
     retVal = false;
     dprintf("FLASHMAN_WriteDisable() Error\r\n");
+    FLASHMAN_CsPin(Handle, 1);
   }
-  FLASHMAN_CsPin(Handle, 1);
   return retVal;
 }
 
@@ -359,48 +986,160 @@ static bool FLASHMAN_WaitForWriting(FLASHMAN_HandleTypeDef *Handle, uint32_t Tim
   uint32_t startTime = HAL_GetTick();
   while (1)
   {
-    FLASHMAN_Delay(1);
-    if (HAL_GetTick() - startTime >= Timeout)
+    FLASHMAN_STAT(Handle->Stats.BusyPolls++);
+    if ((FLASHMAN_ReadReg1(Handle) & FLASHMAN_STATUS1_BUSY) == 0)
     {
-      dprintf("FLASHMAN_WaitForWriting() TIMEOUT\r\n");
+      retVal = true;
       break;
     }
-    if ((FLASHMAN_ReadReg1(Handle) & FLASHMAN_STATUS1_BUSY) == 0)
+    if (HAL_GetTick() - startTime >= Timeout)
     {
-      retVal = true;
+      FLASHMAN_STAT(Handle->Stats.BusyTimeouts++);
+      dprintf("FLASHMAN_WaitForWriting() TIMEOUT\r\n");
       break;
     }
+    FLASHMAN_Delay(1);
   }
   return retVal;
 }
 
-static bool FLASHMAN_FindChip(FLASHMAN_HandleTypeDef *Handle)
+/* complete the program/erase left running by an async call, if any */
+static bool FLASHMAN_WaitForReady(FLASHMAN_HandleTypeDef *Handle)
 {
-  uint8_t tx[4] = {FLASHMAN_CMD_JEDECID, 0xFF, 0xFF, 0xFF};
-  uint8_t rx[4];
-  bool retVal = false;
-  do
+  bool retVal = true;
+  if (Handle->Busy)
   {
-    dprintf("FLASHMAN_FindChip()\r\n");
-    FLASHMAN_CsPin(Handle, 0);
-    if (FLASHMAN_TransmitReceive(Handle, tx, rx, 4, 100) == false)
-    {
-      FLASHMAN_CsPin(Handle, 1);
-      break;
-    }
-    FLASHMAN_CsPin(Handle, 1);
-    dprintf("CHIP ID: 0x%02X%02X%02X\r\n", rx[1], rx[2], rx[3]);
-    Handle->MANUF = rx[1];
-    Handle->MemType = rx[2];
-    Handle->Size = rx[3];
+    retVal = FLASHMAN_WaitForWriting(Handle, Handle->BusyTimeout);
+    FLASHMAN_STAT(FLASHMAN_StatsBusyDone(Handle));
+    FLASHMAN_TRC(FLASHMAN_TraceBusy(Handle, retVal));
+    Handle->Busy = 0;
+  }
+  return retVal;
+}
 
-    dprintf("FLASHMAN MANUFACTURE: ");
-    switch (Handle->MANUF)
-    {
-    case FLASHMAN_MANUF_WINBOND:
-      dprintf("WINBOND");
-      break;
-    case FLASHMAN_MANUF_SPANSION:
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+static void FLASHMAN_StatsHist(uint32_t *Hist, uint32_t Us)
+{
+  uint32_t bucket = 0;
+  while ((Us != 0) && (bucket < FLASHMAN_STATS_BUCKETS - 1))
+  {
+    Us >>= 1;
+    bucket++;
+  }
+  Hist[bucket]++;
+}
+
+static void FLASHMAN_StatsApi(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_StatApiTypeDef Api, uint32_t Bytes, bool Ok)
+{
+  Handle->Stats.Ops[Api]++;
+  Handle->Stats.Bytes[Api] += Bytes;
+  if (Ok == false)
+  {
+    Handle->Stats.Errors[Api]++;
+  }
+}
+
+static void FLASHMAN_StatsBusyStart(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_StatOpTypeDef Op)
+{
+  Handle->BusyOp = Op;
+  Handle->BusyStart = FLASHMAN_TIME_US();
+  if (Op == FLASHMAN_STAT_OP_PROGRAM)
+  {
+    Handle->Stats.PagePrograms++;
+  }
+}
+
+/* latency from the command to the poll that saw the chip ready */
+static void FLASHMAN_StatsBusyDone(FLASHMAN_HandleTypeDef *Handle)
+{
+  uint32_t us = FLASHMAN_TIME_US() - Handle->BusyStart;
+  if (Handle->BusyOp == FLASHMAN_STAT_OP_PROGRAM)
+  {
+    FLASHMAN_StatsHist(Handle->Stats.ProgramHist, us);
+  }
+  else if (Handle->BusyOp == FLASHMAN_STAT_OP_ERASE)
+  {
+    FLASHMAN_StatsHist(Handle->Stats.EraseHist, us);
+  }
+  Handle->BusyOp = FLASHMAN_STAT_OP_NONE;
+}
+#endif
+
+#if FLASHMAN_TRACE == FLASHMAN_TRACE_ENABLE
+static void FLASHMAN_TraceInit(FLASHMAN_TraceTypeDef *Trace)
+{
+  memset(Trace, 0, sizeof(FLASHMAN_TraceTypeDef));
+  Trace->Magic = FLASHMAN_TRACE_MAGIC;
+  Trace->RecordSize = sizeof(FLASHMAN_TraceRecordTypeDef);
+  Trace->Size = FLASHMAN_TRACE_SIZE;
+}
+
+static void FLASHMAN_TraceBegin(FLASHMAN_HandleTypeDef *Handle, uint8_t Cmd3Add, uint8_t Cmd4Add, uint32_t Address, uint32_t Length)
+{
+  FLASHMAN_TraceRecordTypeDef *rec = &Handle->Trace.Record[Handle->Trace.Head % FLASHMAN_TRACE_SIZE];
+  rec->CsLow = FLASHMAN_TIME_US();
+  rec->CsHigh = rec->CsLow;
+  rec->Address = Address;
+  rec->Length = Length;
+  rec->BusyUs = 0;
+  rec->Cmd = FLASHMAN_ADDR4(Handle) ? Cmd4Add : Cmd3Add;
+  rec->Result = FLASHMAN_TRACE_ERROR;
+  rec->Reserved = 0;
+}
+
+static void FLASHMAN_TraceEnd(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_TraceResultTypeDef Result)
+{
+  FLASHMAN_TraceRecordTypeDef *rec = &Handle->Trace.Record[Handle->Trace.Head % FLASHMAN_TRACE_SIZE];
+  rec->CsHigh = FLASHMAN_TIME_US();
+  rec->Result = Result;
+  Handle->Trace.Head++;
+  if (Result == FLASHMAN_TRACE_PENDING)
+  {
+    Handle->Trace.Pending = Handle->Trace.Head;
+  }
+}
+
+/* close the record of the program/erase that left BUSY, unless the ring has already reused it */
+static void FLASHMAN_TraceBusy(FLASHMAN_HandleTypeDef *Handle, bool Ready)
+{
+  uint32_t pending = Handle->Trace.Pending;
+  if ((pending != 0) && ((Handle->Trace.Head - pending) < FLASHMAN_TRACE_SIZE))
+  {
+    FLASHMAN_TraceRecordTypeDef *rec = &Handle->Trace.Record[(pending - 1) % FLASHMAN_TRACE_SIZE];
+    rec->BusyUs = FLASHMAN_TIME_US() - rec->CsHigh;
+    rec->Result = Ready ? FLASHMAN_TRACE_OK : FLASHMAN_TRACE_TIMEOUT;
+  }
+  Handle->Trace.Pending = 0;
+}
+#endif
+
+static bool FLASHMAN_FindChip(FLASHMAN_HandleTypeDef *Handle)
+{
+  uint8_t tx[4] = {FLASHMAN_CMD_JEDECID, 0xFF, 0xFF, 0xFF};
+  uint8_t rx[4];
+  bool retVal = false;
+  do
+  {
+    dprintf("FLASHMAN_FindChip()\r\n");
+    FLASHMAN_CsPin(Handle, 0);
+    if (FLASHMAN_TransmitReceive(Handle, tx, rx, 4, 100) == false)
+    {
+      FLASHMAN_CsPin(Handle, 1);
+      break;
+    }
+    FLASHMAN_CsPin(Handle, 1);
+    dprintf("CHIP ID: 0x%02X%02X%02X\r\n", rx[1], rx[2], rx[3]);
+    Handle->MANUF = rx[1];
+    Handle->MemType = rx[2];
+    Handle->Size = rx[3];
+
+    dprintf("FLASHMAN MANUFACTURE: ");
+    switch (Handle->MANUF)
+    {
+    case FLASHMAN_MANUF_WINBOND:
+      dprintf("WINBOND");
+      break;
+    case FLASHMAN_MANUF_SPANSION:
       dprintf("SPANSION");
       break;
     case FLASHMAN_MANUF_MICRON:
@@ -500,6 +1239,13 @@ static bool FLASHMAN_FindChip(FLASHMAN_HandleTypeDef *Handle)
       break;
     }
 
+#if FLASHMAN_FIXED_BLOCK_CNT != 0
+    if (Handle->BlockCnt != FLASHMAN_FIXED_BLOCK_CNT)
+    {
+      dprintf("FLASHMAN_FindChip() ERROR, NOT THE CONFIGURED PART\r\n");
+      break;
+    }
+#endif
     Handle->SectorCnt = Handle->BlockCnt * 16;
     Handle->PageCnt = (Handle->SectorCnt * FLASHMAN_SECTOR_SIZE) / FLASHMAN_PAGE_SIZE;
     dprintf("FLASHMAN BLOCK CNT: %ld\r\n", Handle->BlockCnt);
@@ -515,18 +1261,175 @@ static bool FLASHMAN_FindChip(FLASHMAN_HandleTypeDef *Handle)
   return retVal;
 }
 
-static bool FLASHMAN_WriteFn(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uint8_t *Data, uint32_t Size, uint32_t Offset)
+/* handle state before the first frame, shared by the cold and the warm init */
+static void FLASHMAN_Setup(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_SpiTypeDef *hspi, FLASHMAN_GpioTypeDef *gpio, uint16_t Pin)
+{
+  memset(Handle, 0, sizeof(FLASHMAN_HandleTypeDef));
+  FLASHMAN_TRC(FLASHMAN_TraceInit(&Handle->Trace));
+  FLASHMAN_WB(Handle->WbPage = FLASHMAN_WRITEBACK_NONE);
+  Handle->hspi = hspi;
+  Handle->gpio = gpio;
+  Handle->Pin = Pin;
+  FLASHMAN_CAL(Handle->ReadPrescaler = Handle->CmdPrescaler = hspi->Init.BaudRatePrescaler);
+  FLASHMAN_CsPin(Handle, 1);
+}
+
+/* true if the chip answers the JEDEC ID of the descriptor */
+static bool FLASHMAN_WarmId(FLASHMAN_HandleTypeDef *Handle, const FLASHMAN_DescriptorTypeDef *Descriptor)
+{
+  uint8_t tx[4] = {FLASHMAN_CMD_JEDECID, 0xFF, 0xFF, 0xFF};
+  uint8_t rx[4];
+  bool retVal;
+  FLASHMAN_CsPin(Handle, 0);
+  retVal = FLASHMAN_TransmitReceive(Handle, tx, rx, 4, 100);
+  FLASHMAN_CsPin(Handle, 1);
+  return retVal && (rx[1] == Descriptor->MANUF) && (rx[2] == Descriptor->MemType) && (rx[3] == Descriptor->Size);
+}
+
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_ENABLE
+/* JEDEC ID, SFDP header or READ at FLASHMAN_CALIBRATE_ADDRESS, at the clocks in the handle */
+static bool FLASHMAN_CalFrame(FLASHMAN_HandleTypeDef *Handle, uint8_t Cmd, uint8_t *Rx, uint32_t Size)
+{
+  uint8_t tx[5] = {Cmd, 0x00, 0x00, 0x00, FLASHMAN_DUMMY_BYTE};
+  bool retVal;
+  if (Cmd == FLASHMAN_CMD_READDATA3ADD)
+  {
+    FLASHMAN_CsPinRead(Handle);
+    retVal = FLASHMAN_SendAddress(Handle, FLASHMAN_CMD_READDATA3ADD, FLASHMAN_CMD_READDATA4ADD, FLASHMAN_CALIBRATE_ADDRESS);
+  }
+  else
+  {
+    FLASHMAN_CsPin(Handle, 0);
+    retVal = FLASHMAN_Transmit(Handle, tx, (Cmd == FLASHMAN_CMD_READSFDP) ? 5 : 1, 100);
+  }
+  retVal = retVal && FLASHMAN_Receive(Handle, Rx, Size, 100);
+  FLASHMAN_CsPin(Handle, 1);
+  return retVal;
+}
+
+/* speed the bus up from the CubeMX prescaler while the chip keeps answering as it did there */
+static void FLASHMAN_Calibrate(FLASHMAN_HandleTypeDef *Handle)
+{
+  const uint32_t step = SPI_BAUDRATEPRESCALER_4 - SPI_BAUDRATEPRESCALER_2;
+  uint32_t base = Handle->hspi->Init.BaudRatePrescaler, prescaler = base, cmd = base, read = base, i;
+  uint8_t id[3], sfdp[16], rx[16];
+  bool cmdOk, readOk;
+  Handle->CmdPrescaler = base;
+  Handle->ReadPrescaler = base;
+  cmdOk = FLASHMAN_CalFrame(Handle, FLASHMAN_CMD_JEDECID, id, sizeof(id)) && FLASHMAN_CalFrame(Handle, FLASHMAN_CMD_READSFDP, sfdp, sizeof(sfdp));
+  readOk = FLASHMAN_CalFrame(Handle, FLASHMAN_CMD_READDATA3ADD, Handle->Chunk[0], FLASHMAN_READ_CHUNK);
+  /* a blank area reads the same at any clock, READ stays where it is */
+  for (i = 1; readOk && (i < FLASHMAN_READ_CHUNK) && (Handle->Chunk[0][i] == Handle->Chunk[0][0]); i++);
+  readOk = readOk && (i < FLASHMAN_READ_CHUNK);
+  while ((cmdOk || readOk) && (prescaler >= step))
+  {
+    prescaler -= step;
+    Handle->CmdPrescaler = prescaler;
+    Handle->ReadPrescaler = prescaler;
+    for (i = 0; i < FLASHMAN_CALIBRATE_ROUNDS; i++)
+    {
+      cmdOk = cmdOk && FLASHMAN_CalFrame(Handle, FLASHMAN_CMD_JEDECID, rx, sizeof(id)) && (memcmp(rx, id, sizeof(id)) == 0) &&
+              FLASHMAN_CalFrame(Handle, FLASHMAN_CMD_READSFDP, rx, sizeof(sfdp)) && (memcmp(rx, sfdp, sizeof(sfdp)) == 0);
+      readOk = readOk && FLASHMAN_CalFrame(Handle, FLASHMAN_CMD_READDATA3ADD, Handle->Chunk[1], FLASHMAN_READ_CHUNK) &&
+               (memcmp(Handle->Chunk[0], Handle->Chunk[1], FLASHMAN_READ_CHUNK) == 0);
+    }
+    if (cmdOk)
+    {
+      cmd = prescaler;
+    }
+    if (readOk)
+    {
+      read = prescaler;
+    }
+  }
+  cmd += FLASHMAN_CALIBRATE_MARGIN * step;
+  read += FLASHMAN_CALIBRATE_MARGIN * step;
+  Handle->CmdPrescaler = (cmd < base) ? cmd : base;
+  Handle->ReadPrescaler = (read < base) ? read : base;
+  dprintf("FLASHMAN CLOCK: READ PCLK/%d, COMMANDS PCLK/%d\r\n", 2 << (Handle->ReadPrescaler / step), 2 << (Handle->CmdPrescaler / step));
+}
+#endif
+
+/* opcode and 3 or 4 byte address into Tx, returns the header length */
+static uint32_t FLASHMAN_Header(FLASHMAN_HandleTypeDef *Handle, uint8_t *Tx, uint8_t Cmd3Add, uint8_t Cmd4Add, uint32_t Address)
+{
+  if (FLASHMAN_ADDR4(Handle))
+  {
+    Tx[0] = Cmd4Add;
+    Tx[1] = (Address & 0xFF000000) >> 24;
+    Tx[2] = (Address & 0x00FF0000) >> 16;
+    Tx[3] = (Address & 0x0000FF00) >> 8;
+    Tx[4] = (Address & 0x000000FF);
+    return 5;
+  }
+  Tx[0] = Cmd3Add;
+  Tx[1] = (Address & 0x00FF0000) >> 16;
+  Tx[2] = (Address & 0x0000FF00) >> 8;
+  Tx[3] = (Address & 0x000000FF);
+  return 4;
+}
+
+/* send the opcode and the 3 or 4 byte address, CS must already be low */
+static bool FLASHMAN_SendAddress(FLASHMAN_HandleTypeDef *Handle, uint8_t Cmd3Add, uint8_t Cmd4Add, uint32_t Address)
+{
+  uint8_t tx[FLASHMAN_HEADER_MAX];
+  return FLASHMAN_Transmit(Handle, tx, FLASHMAN_Header(Handle, tx, Cmd3Add, Cmd4Add, Address), 100);
+}
+
+static bool FLASHMAN_EraseFn(FLASHMAN_HandleTypeDef *Handle, uint8_t Cmd3Add, uint8_t Cmd4Add, uint32_t Address, uint32_t Timeout, bool Wait)
 {
   bool retVal = false;
+  do
+  {
+    if (FLASHMAN_WaitForReady(Handle) == false)
+    {
+      break;
+    }
+    if (FLASHMAN_WriteEnable(Handle) == false)
+    {
+      break;
+    }
+    FLASHMAN_TRC(FLASHMAN_TraceBegin(Handle, Cmd3Add, Cmd4Add, Address, 0));
+    FLASHMAN_CsPin(Handle, 0);
+    if ((FLASHMAN_SendAddress(Handle, Cmd3Add, Cmd4Add, Address) == false) || (FLASHMAN_CsPin(Handle, 1) == false))
+    {
+      FLASHMAN_CsPin(Handle, 1);
+      FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, FLASHMAN_TRACE_ERROR));
+      break;
+    }
+    FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, FLASHMAN_TRACE_PENDING));
+    Handle->Busy = 1;
+    Handle->BusyTimeout = Timeout;
+    FLASHMAN_STAT(FLASHMAN_StatsBusyStart(Handle, FLASHMAN_STAT_OP_ERASE));
+    if ((Wait == false) || FLASHMAN_WaitForReady(Handle))
+    {
+      retVal = true;
+    }
+
+  } while (0);
+
+  /* WEL clears by itself once the chip finishes, only a command that never started leaves it set */
+  if ((retVal == false) && (Handle->Busy == 0))
+  {
+    FLASHMAN_WriteDisable(Handle);
+  }
+  return retVal;
+}
+
+static bool FLASHMAN_WriteFn(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uint8_t *Data, uint32_t Size, uint32_t Offset, bool Wait)
+{
+  bool retVal = false, sent;
   uint32_t address = 0, maximum = FLASHMAN_PAGE_SIZE - Offset;
-  uint8_t tx[5];
+#if FLASHMAN_XFER == FLASHMAN_XFER_SINGLE
+  uint32_t length;
+#endif
   do
   {
 #if FLASHMAN_DEBUG != FLASHMAN_DEBUG_DISABLE
     uint32_t dbgTime = HAL_GetTick();
 #endif
     dprintf("FLASHMAN_WritePage() START PAGE %ld\r\n", PageNumber);
-    if (PageNumber >= Handle->PageCnt)
+    if (PageNumber >= FLASHMAN_PAGE_CNT(Handle))
     {
       dprintf("FLASHMAN_WritePage() ERROR PageNumber\r\n");
       break;
@@ -553,96 +1456,231 @@ static bool FLASHMAN_WriteFn(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber
       }
       dprintf("\r\n}\r\n");
 #endif
+    if (FLASHMAN_WaitForReady(Handle) == false)
+    {
+      break;
+    }
     if (FLASHMAN_WriteEnable(Handle) == false)
     {
       break;
     }
+#if FLASHMAN_XFER == FLASHMAN_XFER_SINGLE
+    length = FLASHMAN_Header(Handle, Handle->Xfer, FLASHMAN_CMD_PAGEPROG3ADD, FLASHMAN_CMD_PAGEPROG4ADD, address);
+    memcpy(&Handle->Xfer[length], Data, Size);
+    FLASHMAN_TRC(FLASHMAN_TraceBegin(Handle, FLASHMAN_CMD_PAGEPROG3ADD, FLASHMAN_CMD_PAGEPROG4ADD, address, Size));
+    FLASHMAN_CsPin(Handle, 0);
+    sent = FLASHMAN_Transmit(Handle, Handle->Xfer, length + Size, 1000);
+#else
+    FLASHMAN_TRC(FLASHMAN_TraceBegin(Handle, FLASHMAN_CMD_PAGEPROG3ADD, FLASHMAN_CMD_PAGEPROG4ADD, address, Size));
     FLASHMAN_CsPin(Handle, 0);
-    if (Handle->BlockCnt >= 512)
-    {
-      tx[0] = FLASHMAN_CMD_PAGEPROG4ADD;
-      tx[1] = (address & 0xFF000000) >> 24;
-      tx[2] = (address & 0x00FF0000) >> 16;
-      tx[3] = (address & 0x0000FF00) >> 8;
-      tx[4] = (address & 0x000000FF);
-      if (FLASHMAN_Transmit(Handle, tx, 5, 100) == false)
+    sent = FLASHMAN_SendAddress(Handle, FLASHMAN_CMD_PAGEPROG3ADD, FLASHMAN_CMD_PAGEPROG4ADD, address) &&
+           FLASHMAN_Transmit(Handle, Data, Size, 1000);
+#endif
+    if ((sent == false) || (FLASHMAN_CsPin(Handle, 1) == false))
+    {
+      FLASHMAN_CsPin(Handle, 1);
+      FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, FLASHMAN_TRACE_ERROR));
+      break;
+    }
+    FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, FLASHMAN_TRACE_PENDING));
+    Handle->Busy = 1;
+    Handle->BusyTimeout = 100;
+    FLASHMAN_STAT(FLASHMAN_StatsBusyStart(Handle, FLASHMAN_STAT_OP_PROGRAM));
+    if ((Wait == false) || FLASHMAN_WaitForReady(Handle))
+    {
+      dprintf("FLASHMAN_WritePage() %d BYTES WITERN DONE AFTER %ld ms\r\n", (uint16_t)Size, HAL_GetTick() - dbgTime);
+      retVal = true;
+    }
+
+  } while (0);
+
+  if ((retVal == false) && (Handle->Busy == 0))
+  {
+    FLASHMAN_WriteDisable(Handle);
+  }
+  return retVal;
+}
+
+#if FLASHMAN_WRITEBACK == FLASHMAN_WRITEBACK_ENABLE
+/* program the gathered bytes of the buffered page as one page program */
+static bool FLASHMAN_WbFlush(FLASHMAN_HandleTypeDef *Handle, bool Wait)
+{
+  uint32_t page = Handle->WbPage;
+  if (page == FLASHMAN_WRITEBACK_NONE)
+  {
+    return true;
+  }
+  Handle->WbPage = FLASHMAN_WRITEBACK_NONE;
+  return FLASHMAN_WriteFn(Handle, page, &Handle->WbData[Handle->WbLo], Handle->WbHi - Handle->WbLo, Handle->WbLo, Wait);
+}
+
+/* an erase makes buffered bytes in its range meaningless */
+static void FLASHMAN_WbDrop(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size)
+{
+  if ((Handle->WbPage != FLASHMAN_WRITEBACK_NONE) && (FLASHMAN_PageToAddress(Handle->WbPage) - Address < Size))
+  {
+    Handle->WbPage = FLASHMAN_WRITEBACK_NONE;
+  }
+}
+
+/* the chip will AND the buffered bytes into what it holds, so reads do the same */
+static void FLASHMAN_WbRead(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size)
+{
+  uint32_t page, start, end;
+  if (Handle->WbPage == FLASHMAN_WRITEBACK_NONE)
+  {
+    return;
+  }
+  page = FLASHMAN_PageToAddress(Handle->WbPage);
+  start = page + Handle->WbLo;
+  end = page + Handle->WbHi;
+  if (start < Address)
+  {
+    start = Address;
+  }
+  if (end > Address + Size)
+  {
+    end = Address + Size;
+  }
+  for (; start < end; start++)
+  {
+    Data[start - Address] &= Handle->WbData[start - page];
+  }
+}
+#endif
+
+/* writes shorter than a page are gathered per page when the write-back buffer is enabled */
+static bool FLASHMAN_BufferedWriteFn(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uint8_t *Data, uint32_t Size, uint32_t Offset, bool Wait)
+{
+#if FLASHMAN_WRITEBACK == FLASHMAN_WRITEBACK_ENABLE
+  if ((PageNumber < FLASHMAN_PAGE_CNT(Handle)) && (Offset < FLASHMAN_PAGE_SIZE) && (Size > 0))
+  {
+    if (Size > FLASHMAN_PAGE_SIZE - Offset)
+    {
+      Size = FLASHMAN_PAGE_SIZE - Offset;
+    }
+    if ((Handle->WbPage != FLASHMAN_WRITEBACK_NONE) &&
+        ((Handle->WbPage != PageNumber) || (Size == FLASHMAN_PAGE_SIZE) || (HAL_GetTick() - Handle->WbTick >= FLASHMAN_WRITEBACK_MS)))
+    {
+      if (FLASHMAN_WbFlush(Handle, true) == false)
       {
-        FLASHMAN_CsPin(Handle, 1);
-        break;
+        return false;
       }
     }
-    else
+    if (Size < FLASHMAN_PAGE_SIZE)
     {
-      tx[0] = FLASHMAN_CMD_PAGEPROG3ADD;
-      tx[1] = (address & 0x00FF0000) >> 16;
-      tx[2] = (address & 0x0000FF00) >> 8;
-      tx[3] = (address & 0x000000FF);
-      if (FLASHMAN_Transmit(Handle, tx, 4, 100) == false)
+      if (Handle->WbPage == FLASHMAN_WRITEBACK_NONE)
       {
-        FLASHMAN_CsPin(Handle, 1);
-        break;
+        memset(Handle->WbData, 0xFF, FLASHMAN_PAGE_SIZE);
+        Handle->WbPage = PageNumber;
+        Handle->WbTick = HAL_GetTick();
+        Handle->WbLo = (uint16_t)Offset;
+        Handle->WbHi = (uint16_t)(Offset + Size);
       }
+      for (uint32_t i = 0; i < Size; i++)
+      {
+        Handle->WbData[Offset + i] &= Data[i];
+      }
+      if (Offset < Handle->WbLo)
+      {
+        Handle->WbLo = (uint16_t)Offset;
+      }
+      if (Offset + Size > Handle->WbHi)
+      {
+        Handle->WbHi = (uint16_t)(Offset + Size);
+      }
+      /* the last byte of the page is written, the writer has moved on */
+      if (Handle->WbHi == FLASHMAN_PAGE_SIZE)
+      {
+        return FLASHMAN_WbFlush(Handle, Wait);
+      }
+      return true;
+    }
+  }
+#endif
+  return FLASHMAN_WriteFn(Handle, PageNumber, Data, Size, Offset, Wait);
+}
+
+static bool FLASHMAN_WriteAddressFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size, bool Wait)
+{
+  bool retVal = false;
+  uint32_t page, add, offset, remaining, length, maximum, index = 0;
+  add = Address;
+  remaining = Size;
+  do
+  {
+    page = FLASHMAN_AddressToPage(add);
+    offset = add % FLASHMAN_PAGE_SIZE;
+    maximum = FLASHMAN_PAGE_SIZE - offset;
+    if (remaining <= maximum)
+    {
+      length = remaining;
     }
-    if (FLASHMAN_Transmit(Handle, Data, Size, 1000) == false)
+    else
+    {
+      length = maximum;
+    }
+    if (FLASHMAN_BufferedWriteFn(Handle, page, &Data[index], length, offset, Wait) == false)
     {
-      FLASHMAN_CsPin(Handle, 1);
       break;
     }
-    FLASHMAN_CsPin(Handle, 1);
-    if (FLASHMAN_WaitForWriting(Handle, 100))
+    add += length;
+    index += length;
+    remaining -= length;
+    if (remaining == 0)
     {
-      dprintf("FLASHMAN_WritePage() %d BYTES WITERN DONE AFTER %ld ms\r\n", (uint16_t)Size, HAL_GetTick() - dbgTime);
       retVal = true;
+      break;
     }
 
-  } while (0);
+  } while (remaining > 0);
 
-  FLASHMAN_WriteDisable(Handle);
   return retVal;
 }
 
 static bool FLASHMAN_ReadFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size)
 {
-  bool retVal = false;
-  uint8_t tx[5];
+  bool retVal = false, sent;
+#if FLASHMAN_XFER == FLASHMAN_XFER_SINGLE
+  uint32_t length;
+#endif
   do
   {
 #if FLASHMAN_DEBUG != FLASHMAN_DEBUG_DISABLE
     uint32_t dbgTime = HAL_GetTick();
+#endif
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+    uint32_t statTime = FLASHMAN_TIME_US();
 #endif
     dprintf("FLASHMAN_ReadAddress() START ADDRESS %ld\r\n", Address);
-    FLASHMAN_CsPin(Handle, 0);
-    if (Handle->BlockCnt >= 512)
-    {
-      tx[0] = FLASHMAN_CMD_READDATA4ADD;
-      tx[1] = (Address & 0xFF000000) >> 24;
-      tx[2] = (Address & 0x00FF0000) >> 16;
-      tx[3] = (Address & 0x0000FF00) >> 8;
-      tx[4] = (Address & 0x000000FF);
-      if (FLASHMAN_Transmit(Handle, tx, 5, 100) == false)
-      {
-        FLASHMAN_CsPin(Handle, 1);
-        break;
-      }
+    if (FLASHMAN_WaitForReady(Handle) == false)
+    {
+      break;
+    }
+    FLASHMAN_TRC(FLASHMAN_TraceBegin(Handle, FLASHMAN_CMD_READDATA3ADD, FLASHMAN_CMD_READDATA4ADD, Address, Size));
+    FLASHMAN_CsPinRead(Handle);
+#if FLASHMAN_XFER == FLASHMAN_XFER_SINGLE
+    /* small reads are dominated by per-call overhead, clock header and data as one full duplex frame */
+    if (Size <= FLASHMAN_PAGE_SIZE)
+    {
+      length = FLASHMAN_Header(Handle, Handle->Xfer, FLASHMAN_CMD_READDATA3ADD, FLASHMAN_CMD_READDATA4ADD, Address);
+      sent = FLASHMAN_TransmitReceive(Handle, Handle->Xfer, Handle->Xfer, length + Size, 100);
+      memcpy(Data, &Handle->Xfer[length], Size);
     }
     else
+#endif
     {
-      tx[0] = FLASHMAN_CMD_READDATA3ADD;
-      tx[1] = (Address & 0x00FF0000) >> 16;
-      tx[2] = (Address & 0x0000FF00) >> 8;
-      tx[3] = (Address & 0x000000FF);
-      if (FLASHMAN_Transmit(Handle, tx, 4, 100) == false)
-      {
-        FLASHMAN_CsPin(Handle, 1);
-        break;
-      }
+      sent = FLASHMAN_SendAddress(Handle, FLASHMAN_CMD_READDATA3ADD, FLASHMAN_CMD_READDATA4ADD, Address) &&
+             FLASHMAN_Receive(Handle, Data, Size, 2000);
     }
-    if (FLASHMAN_Receive(Handle, Data, Size, 2000) == false)
+    if (sent == false)
     {
       FLASHMAN_CsPin(Handle, 1);
+      FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, FLASHMAN_TRACE_ERROR));
       break;
     }
     FLASHMAN_CsPin(Handle, 1);
+    FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, FLASHMAN_TRACE_OK));
     dprintf("FLASHMAN_ReadAddress() %d BYTES READ DONE AFTER %ld ms\r\n", (uint16_t)Size, HAL_GetTick() - dbgTime);
 #if FLASHMAN_DEBUG == FLASHMAN_DEBUG_FULL
     dprintf("{\r\n0x%02X", Data[0]);
@@ -656,6 +1694,8 @@ static bool FLASHMAN_ReadFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, ui
     }
     dprintf("\r\n}\r\n");
 #endif
+    FLASHMAN_STAT(FLASHMAN_StatsHist(Handle->Stats.ReadHist, FLASHMAN_TIME_US() - statTime));
+    FLASHMAN_WB(FLASHMAN_WbRead(Handle, Address, Data, Size));
     retVal = true;
 
   } while (0);
@@ -663,32 +1703,369 @@ static bool FLASHMAN_ReadFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, ui
   return retVal;
 }
 
-/**
-  * @brief  Initialize the FLASHMAN.
-  * @note   Enable and configure the SPI and Set GPIO as output for CS pin on the CubeMX
-  *
-  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
-  * @param  *hspi: Pointer to a SPI_HandleTypeDef structure
-  * @param  *gpio: Pointer to a GPIO_TypeDef structure for CS
-  * @param  Pin: Pin of CS
-  *
-  * @retval bool: true or false
-  */
-bool FLASHMAN_Init(FLASHMAN_HandleTypeDef *Handle, SPI_HandleTypeDef *hspi, GPIO_TypeDef *gpio, uint16_t Pin)
+/* read back a range under one READ command through a small buffer and fold it into Crc */
+static bool FLASHMAN_ReadCrcFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size, uint32_t *Crc)
 {
   bool retVal = false;
+  uint8_t chunk[FLASHMAN_VERIFY_CHUNK];
+  uint32_t length;
   do
   {
-    if ((Handle == NULL) || (hspi == NULL) || (gpio == NULL) || (Handle->Inited == 1))
+    if (FLASHMAN_WaitForReady(Handle) == false)
+    {
+      break;
+    }
+    FLASHMAN_TRC(FLASHMAN_TraceBegin(Handle, FLASHMAN_CMD_READDATA3ADD, FLASHMAN_CMD_READDATA4ADD, Address, Size));
+    FLASHMAN_CsPinRead(Handle);
+    if (FLASHMAN_SendAddress(Handle, FLASHMAN_CMD_READDATA3ADD, FLASHMAN_CMD_READDATA4ADD, Address) == false)
+    {
+      FLASHMAN_CsPin(Handle, 1);
+      FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, FLASHMAN_TRACE_ERROR));
+      break;
+    }
+    while (Size > 0)
+    {
+      length = (Size > FLASHMAN_VERIFY_CHUNK) ? FLASHMAN_VERIFY_CHUNK : Size;
+      if ((FLASHMAN_ReceiveStart(Handle, chunk, length, Size > length) == false) || (FLASHMAN_ReceiveWait(Handle) == false))
+      {
+        break;
+      }
+      *Crc = FLASHMAN_Crc32(*Crc, chunk, length);
+      Size -= length;
+    }
+    FLASHMAN_CsPin(Handle, 1);
+    FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, (Size == 0) ? FLASHMAN_TRACE_OK : FLASHMAN_TRACE_ERROR));
+    retVal = (Size == 0);
+
+  } while (0);
+
+  return retVal;
+}
+
+/* index of the first differing byte, Size if none. Word compares until a word differs */
+static uint32_t FLASHMAN_Diff(const uint8_t *A, const uint8_t *B, uint32_t Size)
+{
+  uint32_t i = 0, a, b;
+  for (; i + sizeof(uint32_t) <= Size; i += sizeof(uint32_t))
+  {
+    memcpy(&a, &A[i], sizeof(uint32_t));
+    memcpy(&b, &B[i], sizeof(uint32_t));
+    if (a != b)
+    {
+      break;
+    }
+  }
+  for (; i < Size; i++)
+  {
+    if (A[i] != B[i])
+    {
+      break;
+    }
+  }
+  return i;
+}
+
+static bool FLASHMAN_Blank(const uint8_t *Data, uint32_t Size)
+{
+  uint32_t i = 0, word;
+  for (; i + sizeof(uint32_t) <= Size; i += sizeof(uint32_t))
+  {
+    memcpy(&word, &Data[i], sizeof(uint32_t));
+    if (word != 0xFFFFFFFF)
+    {
+      return false;
+    }
+  }
+  for (; i < Size; i++)
+  {
+    if (Data[i] != 0xFF)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* compare two ranges chunk by chunk through the chunks of Dst, stops at the first difference. A stale
+   sector mostly differs in its first page already, so that one is compared on its own */
+static bool FLASHMAN_CopyMatch(FLASHMAN_HandleTypeDef *Src, uint32_t SrcAddress, FLASHMAN_HandleTypeDef *Dst, uint32_t DstAddress, uint32_t Size, bool *Match)
+{
+  bool retVal = true;
+  uint32_t length;
+  *Match = true;
+  for (uint32_t offset = 0; retVal && *Match && (offset < Size); offset += length)
+  {
+    length = ((offset == 0) && (FLASHMAN_PAGE_SIZE < FLASHMAN_READ_CHUNK)) ? FLASHMAN_PAGE_SIZE : FLASHMAN_READ_CHUNK;
+    if (length > Size - offset)
+    {
+      length = Size - offset;
+    }
+    retVal = FLASHMAN_ReadFn(Src, SrcAddress + offset, Dst->Chunk[0], length) &&
+             FLASHMAN_ReadFn(Dst, DstAddress + offset, Dst->Chunk[1], length);
+    *Match = retVal && (FLASHMAN_Diff(Dst->Chunk[0], Dst->Chunk[1], length) == length);
+  }
+  return retVal;
+}
+
+/* program Size bytes of Src to the erased DstAddress without waiting. Each page program runs on Dst
+   while the next chunk is read from Src, chunks blank in Src stay erased */
+static bool FLASHMAN_CopyProgram(FLASHMAN_HandleTypeDef *Src, uint32_t SrcAddress, FLASHMAN_HandleTypeDef *Dst, uint32_t DstAddress, uint32_t Size)
+{
+  bool retVal = true;
+  uint32_t length, piece, address;
+  for (uint32_t offset = 0; retVal && (offset < Size); offset += length)
+  {
+    length = (Size - offset > FLASHMAN_READ_CHUNK) ? FLASHMAN_READ_CHUNK : Size - offset;
+    retVal = FLASHMAN_ReadFn(Src, SrcAddress + offset, Dst->Chunk[0], length);
+    if (retVal && FLASHMAN_Blank(Dst->Chunk[0], length))
+    {
+      continue;
+    }
+    for (uint32_t done = 0; retVal && (done < length); done += piece)
+    {
+      address = DstAddress + offset + done;
+      piece = FLASHMAN_PAGE_SIZE - (address % FLASHMAN_PAGE_SIZE);
+      if (piece > length - done)
+      {
+        piece = length - done;
+      }
+      retVal = FLASHMAN_WriteFn(Dst, FLASHMAN_AddressToPage(address), &Dst->Chunk[0][done], piece, address % FLASHMAN_PAGE_SIZE, false);
+    }
+  }
+  return retVal;
+}
+
+/* true if programming Image over Flash gives Image, i.e. no bit has to go from 0 to 1 */
+static bool FLASHMAN_Clearable(const uint8_t *Flash, const uint8_t *Image, uint32_t Size)
+{
+  uint32_t i = 0, flash, image;
+  for (; i + sizeof(uint32_t) <= Size; i += sizeof(uint32_t))
+  {
+    memcpy(&flash, &Flash[i], sizeof(uint32_t));
+    memcpy(&image, &Image[i], sizeof(uint32_t));
+    if ((flash & image) != image)
+    {
+      return false;
+    }
+  }
+  for (; i < Size; i++)
+  {
+    if ((Flash[i] & Image[i]) != Image[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* program the pages of a sector set in Pages without waiting, Address sector aligned */
+static bool FLASHMAN_ImageProgram(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, const uint8_t *Image, uint32_t Size, uint32_t Pages, uint32_t *Programmed)
+{
+  bool retVal = true;
+  uint32_t length;
+  for (uint32_t offset = 0; retVal && (offset < Size); offset += FLASHMAN_PAGE_SIZE)
+  {
+    if (Pages & (1UL << (offset / FLASHMAN_PAGE_SIZE)))
+    {
+      length = (Size - offset > FLASHMAN_PAGE_SIZE) ? FLASHMAN_PAGE_SIZE : Size - offset;
+      retVal = FLASHMAN_WriteFn(Handle, FLASHMAN_AddressToPage(Address + offset), (uint8_t *)&Image[offset], length, 0, false);
+      (*Programmed)++;
+    }
+  }
+  return retVal;
+}
+
+/* read a range under one READ command and hand it to Consume chunk by chunk, chunk N is consumed
+   while chunk N+1 is received into the next buffer. Buffers NULL uses the two chunks of the handle.
+   Done is the number of bytes the consumer took */
+static bool FLASHMAN_StreamFn(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size, uint8_t *const *Buffers, uint32_t BufferCnt,
+                              uint32_t BufferSize, FLASHMAN_ConsumeTypeDef Consume, void *Context, uint32_t *Done)
+{
+  bool retVal = false;
+  uint8_t *chunk[2] = {Handle->Chunk[0], Handle->Chunk[1]};
+  uint32_t length, next, taken, current = 0;
+  *Done = 0;
+  if (Buffers == NULL)
+  {
+    Buffers = chunk;
+    BufferCnt = 2;
+    BufferSize = FLASHMAN_READ_CHUNK;
+  }
+  if (BufferSize > FLASHMAN_HAL_CHUNK)
+  {
+    BufferSize = FLASHMAN_HAL_CHUNK;
+  }
+  do
+  {
+    if (Size == 0)
+    {
+      retVal = true;
+      break;
+    }
+    if (FLASHMAN_WaitForReady(Handle) == false)
     {
-      dprintf("FLASHMAN_Init() Error, Wrong Parameter\r\n");
       break;
     }
-    memset(Handle, 0, sizeof(FLASHMAN_HandleTypeDef));
-    Handle->hspi = hspi;
-    Handle->gpio = gpio;
-    Handle->Pin = Pin;
+    FLASHMAN_TRC(FLASHMAN_TraceBegin(Handle, FLASHMAN_CMD_READDATA3ADD, FLASHMAN_CMD_READDATA4ADD, Address, Size));
+    FLASHMAN_CsPinRead(Handle);
+    length = (Size > BufferSize) ? BufferSize : Size;
+    retVal = FLASHMAN_SendAddress(Handle, FLASHMAN_CMD_READDATA3ADD, FLASHMAN_CMD_READDATA4ADD, Address) &&
+             FLASHMAN_ReceiveStart(Handle, Buffers[current], length, Size > length);
+    while (retVal && (length > 0))
+    {
+      if (FLASHMAN_ReceiveWait(Handle) == false)
+      {
+        retVal = false;
+        break;
+      }
+      next = Size - *Done - length;
+      if (next > BufferSize)
+      {
+        next = BufferSize;
+      }
+      if ((next > 0) && (FLASHMAN_ReceiveStart(Handle, Buffers[(current + 1) % BufferCnt], next, Size - *Done - length > next) == false))
+      {
+        retVal = false;
+        break;
+      }
+      taken = Consume(Context, Buffers[current], *Done, length);
+      *Done += taken;
+      if (taken < length)
+      {
+        /* the next chunk is on the wire, CS can only go up after it */
+        if (next > 0)
+        {
+          retVal = FLASHMAN_ReceiveWait(Handle);
+        }
+        break;
+      }
+      length = next;
+      current = (current + 1) % BufferCnt;
+    }
     FLASHMAN_CsPin(Handle, 1);
+    FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, retVal ? FLASHMAN_TRACE_OK : FLASHMAN_TRACE_ERROR));
+
+  } while (0);
+
+  return retVal;
+}
+
+/* FLASHMAN_ReadStream() callback, false stops the read */
+static uint32_t FLASHMAN_CallbackChunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size)
+{
+  FLASHMAN_CallbackTypeDef *callback = (FLASHMAN_CallbackTypeDef *)Context;
+  return callback->Callback(callback->Context, Chunk, Offset, Size) ? Size : 0;
+}
+
+/* Context is the data compared against, stops at the first difference */
+static uint32_t FLASHMAN_CompareChunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size)
+{
+  return FLASHMAN_Diff(Chunk, (const uint8_t *)Context + Offset, Size);
+}
+
+/* Context is a FLASHMAN_ImageDiffTypeDef, Offset counts from the start of the sector */
+static uint32_t FLASHMAN_ImageChunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size)
+{
+  FLASHMAN_ImageDiffTypeDef *diff = (FLASHMAN_ImageDiffTypeDef *)Context;
+  uint32_t piece, at;
+  for (uint32_t done = 0; done < Size; done += piece)
+  {
+    at = Offset + done;
+    piece = FLASHMAN_PAGE_SIZE - (at % FLASHMAN_PAGE_SIZE);
+    if (piece > Size - done)
+    {
+      piece = Size - done;
+    }
+    if (FLASHMAN_Diff(&Chunk[done], &diff->Image[at], piece) < piece)
+    {
+      if (FLASHMAN_Clearable(&Chunk[done], &diff->Image[at], piece) == false)
+      {
+        diff->Erase = true;
+        return 0;
+      }
+      diff->Pages |= 1UL << (at / FLASHMAN_PAGE_SIZE);
+    }
+  }
+  return Size;
+}
+
+static uint32_t FLASHMAN_Crc32Chunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size)
+{
+  (void)Offset;
+  *(uint32_t *)Context = FLASHMAN_Crc32(*(uint32_t *)Context, Chunk, Size);
+  return Size;
+}
+
+static uint32_t FLASHMAN_Crc32cChunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size)
+{
+  (void)Offset;
+  *(uint32_t *)Context = FLASHMAN_Crc32c(*(uint32_t *)Context, Chunk, Size);
+  return Size;
+}
+
+static uint32_t FLASHMAN_Sha256Chunk(void *Context, const uint8_t *Chunk, uint32_t Offset, uint32_t Size)
+{
+  (void)Offset;
+  FLASHMAN_Sha256Update((FLASHMAN_Sha256TypeDef *)Context, Chunk, Size);
+  return Size;
+}
+
+static void FLASHMAN_Sha256Block(FLASHMAN_Sha256TypeDef *Sha, const uint8_t *Block)
+{
+  uint32_t w[64], v[8], t1, t2;
+  for (int i = 0; i < 16; i++)
+  {
+    w[i] = ((uint32_t)Block[i * 4] << 24) | ((uint32_t)Block[i * 4 + 1] << 16) | ((uint32_t)Block[i * 4 + 2] << 8) | Block[i * 4 + 3];
+  }
+  for (int i = 16; i < 64; i++)
+  {
+    t1 = FLASHMAN_ROR(w[i - 15], 7) ^ FLASHMAN_ROR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    t2 = FLASHMAN_ROR(w[i - 2], 17) ^ FLASHMAN_ROR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + t1 + w[i - 7] + t2;
+  }
+  memcpy(v, Sha->State, sizeof(v));
+  for (int i = 0; i < 64; i++)
+  {
+    t1 = v[7] + (FLASHMAN_ROR(v[4], 6) ^ FLASHMAN_ROR(v[4], 11) ^ FLASHMAN_ROR(v[4], 25)) +
+         ((v[4] & v[5]) ^ (~v[4] & v[6])) + FLASHMAN_Sha256K[i] + w[i];
+    t2 = (FLASHMAN_ROR(v[0], 2) ^ FLASHMAN_ROR(v[0], 13) ^ FLASHMAN_ROR(v[0], 22)) +
+         ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+    memmove(&v[1], &v[0], 7 * sizeof(uint32_t));
+    v[4] += t1;
+    v[0] = t1 + t2;
+  }
+  for (int i = 0; i < 8; i++)
+  {
+    Sha->State[i] += v[i];
+  }
+}
+
+/**
+  * @brief  Initialize the FLASHMAN.
+  * @note   Enable and configure the SPI and Set GPIO as output for CS pin on the CubeMX
+  * @note   With FLASHMAN_CALIBRATE_ENABLE the fastest reliable prescalers for READ and for the other
+  *         commands are searched here, starting at the CubeMX one, and kept in the handle. The bus is
+  *         switched between them per frame, other users of the same SPI have to set their own.
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  *hspi: Pointer to a SPI_HandleTypeDef structure (FLASHMAN_SpidevTypeDef on Linux)
+  * @param  *gpio: Pointer to a GPIO_TypeDef structure for CS, NULL on Linux
+  * @param  Pin: Pin of CS
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_Init(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_SpiTypeDef *hspi, FLASHMAN_GpioTypeDef *gpio, uint16_t Pin)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Handle == NULL) || (hspi == NULL) || (Handle->Inited == 1) ||
+        ((gpio == NULL) && (FLASHMAN_PLATFORM != FLASHMAN_PLATFORM_LINUX_SPIDEV)))
+    {
+      dprintf("FLASHMAN_Init() Error, Wrong Parameter\r\n");
+      break;
+    }
+    FLASHMAN_Setup(Handle, hspi, gpio, Pin);
     /* wait for stable VCC */
     while (HAL_GetTick() < 20)
     {
@@ -701,6 +2078,7 @@ bool FLASHMAN_Init(FLASHMAN_HandleTypeDef *Handle, SPI_HandleTypeDef *hspi, GPIO
     retVal = FLASHMAN_FindChip(Handle);
     if (retVal)
     {
+      FLASHMAN_CAL(FLASHMAN_Calibrate(Handle));
       Handle->Inited = 1;
       dprintf("FLASHMAN_Init() Done\r\n");
     }
@@ -710,6 +2088,114 @@ bool FLASHMAN_Init(FLASHMAN_HandleTypeDef *Handle, SPI_HandleTypeDef *hspi, GPIO
   return retVal;
 }
 
+/**
+  * @brief  Initialize from the descriptor of an earlier boot, without probing the chip
+  * @note   One JEDEC ID read checks that the chip is the one described and is awake, then the handle
+  *         is ready. No power-up delay: a chip that answers is powered.
+  * @note   If it does not answer, it is released from deep power-down (0xAB) and checked again. If it
+  *         still does not, it is polled after the power-up time until a program or erase cut by the
+  *         reset is done (up to 3 s) and checked a last time. On false use FLASHMAN_Init().
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  *hspi: Pointer to SPI_HandleTypeDef structure
+  * @param  *gpio: Pointer to GPIO_TypeDef structure of the CS pin
+  * @param  Pin: CS pin
+  * @param  *Descriptor: From FLASHMAN_GetDescriptor()
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_InitWarm(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_SpiTypeDef *hspi, FLASHMAN_GpioTypeDef *gpio, uint16_t Pin,
+                       const FLASHMAN_DescriptorTypeDef *Descriptor)
+{
+  bool retVal = false;
+  uint8_t tx[1] = {FLASHMAN_CMD_RELEASE};
+  do
+  {
+    if ((Handle == NULL) || (hspi == NULL) || (Handle->Inited == 1) || (Descriptor == NULL) ||
+        ((gpio == NULL) && (FLASHMAN_PLATFORM != FLASHMAN_PLATFORM_LINUX_SPIDEV)))
+    {
+      dprintf("FLASHMAN_InitWarm() Error, Wrong Parameter\r\n");
+      break;
+    }
+    if ((Descriptor->Magic != FLASHMAN_DESCRIPTOR_MAGIC) ||
+        (Descriptor->Crc != FLASHMAN_Crc32(0, (const uint8_t *)Descriptor, offsetof(FLASHMAN_DescriptorTypeDef, Crc))) ||
+        (Descriptor->BlockCnt == 0) || ((FLASHMAN_FIXED_BLOCK_CNT != 0) && (Descriptor->BlockCnt != FLASHMAN_FIXED_BLOCK_CNT)))
+    {
+      dprintf("FLASHMAN_InitWarm() Error, Descriptor\r\n");
+      break;
+    }
+    FLASHMAN_Setup(Handle, hspi, gpio, Pin);
+    FLASHMAN_CAL(Handle->ReadPrescaler = Descriptor->ReadPrescaler);
+    FLASHMAN_CAL(Handle->CmdPrescaler = Descriptor->CmdPrescaler);
+    if (FLASHMAN_WarmId(Handle, Descriptor) == false)
+    {
+      /* asleep in deep power-down, or busy with a program/erase cut by the reset, or not powered long enough */
+      FLASHMAN_CsPin(Handle, 0);
+      retVal = FLASHMAN_Transmit(Handle, tx, 1, 100);
+      FLASHMAN_CsPin(Handle, 1);
+      FLASHMAN_Delay(1);
+      if (retVal && (FLASHMAN_WarmId(Handle, Descriptor) == false))
+      {
+        while (HAL_GetTick() < 20)
+        {
+          FLASHMAN_Delay(1);
+        }
+        retVal = FLASHMAN_WaitForWriting(Handle, 3000) && FLASHMAN_WarmId(Handle, Descriptor);
+      }
+      if (retVal == false)
+      {
+        break;
+      }
+    }
+    Handle->MANUF = (FLASHMAN_MANUFTypeDef)Descriptor->MANUF;
+    Handle->MemType = Descriptor->MemType;
+    Handle->Size = (FLASHMAN_SizeTypeDef)Descriptor->Size;
+    Handle->BlockCnt = Descriptor->BlockCnt;
+    Handle->SectorCnt = Handle->BlockCnt * 16;
+    Handle->PageCnt = (Handle->SectorCnt * FLASHMAN_SECTOR_SIZE) / FLASHMAN_PAGE_SIZE;
+    Handle->Inited = 1;
+    retVal = true;
+    dprintf("FLASHMAN_InitWarm() Done\r\n");
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Capture what FLASHMAN_InitWarm() needs, keep it where it survives a reset
+  * @note   Chip identity, geometry and the calibrated clocks, protected by a CRC32
+  *
+  * @param  *Handle: Pointer to an initialized FLASHMAN_HandleTypeDef structure
+  * @param  *Descriptor: Pointer to FLASHMAN_DescriptorTypeDef structure (output)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_GetDescriptor(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_DescriptorTypeDef *Descriptor)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Handle == NULL) || (Handle->Inited == 0) || (Descriptor == NULL))
+    {
+      break;
+    }
+    memset(Descriptor, 0, sizeof(FLASHMAN_DescriptorTypeDef));
+    Descriptor->Magic = FLASHMAN_DESCRIPTOR_MAGIC;
+    Descriptor->MANUF = (uint8_t)Handle->MANUF;
+    Descriptor->MemType = Handle->MemType;
+    Descriptor->Size = (uint8_t)Handle->Size;
+    Descriptor->BlockCnt = FLASHMAN_BLOCK_CNT(Handle);
+    FLASHMAN_CAL(Descriptor->ReadPrescaler = Handle->ReadPrescaler);
+    FLASHMAN_CAL(Descriptor->CmdPrescaler = Handle->CmdPrescaler);
+    Descriptor->Crc = FLASHMAN_Crc32(0, (const uint8_t *)Descriptor, offsetof(FLASHMAN_DescriptorTypeDef, Crc));
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
 /**
   * @brief  Full Erase chip.
   * @note   Send the Full-Erase-chip command and wait for completion
@@ -729,18 +2215,28 @@ bool FLASHMAN_EraseChip(FLASHMAN_HandleTypeDef *Handle)
     uint32_t dbgTime = HAL_GetTick();
 #endif
     dprintf("FLASHMAN_EraseChip() START\r\n");
+    FLASHMAN_WB(Handle->WbPage = FLASHMAN_WRITEBACK_NONE);
+    if (FLASHMAN_WaitForReady(Handle) == false)
+    {
+      break;
+    }
     if (FLASHMAN_WriteEnable(Handle) == false)
     {
       break;
     }
+    FLASHMAN_TRC(FLASHMAN_TraceBegin(Handle, tx[0], tx[0], 0, 0));
     FLASHMAN_CsPin(Handle, 0);
-    if (FLASHMAN_Transmit(Handle, tx, 1, 100) == false)
+    if ((FLASHMAN_Transmit(Handle, tx, 1, 100) == false) || (FLASHMAN_CsPin(Handle, 1) == false))
     {
       FLASHMAN_CsPin(Handle, 1);
+      FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, FLASHMAN_TRACE_ERROR));
       break;
     }
-    FLASHMAN_CsPin(Handle, 1);
-    if (FLASHMAN_WaitForWriting(Handle, Handle->BlockCnt * 1000))
+    FLASHMAN_TRC(FLASHMAN_TraceEnd(Handle, FLASHMAN_TRACE_PENDING));
+    Handle->Busy = 1;
+    Handle->BusyTimeout = FLASHMAN_BLOCK_CNT(Handle) * 1000;
+    FLASHMAN_STAT(FLASHMAN_StatsBusyStart(Handle, FLASHMAN_STAT_OP_ERASE));
+    if (FLASHMAN_WaitForReady(Handle))
     {
       dprintf("FLASHMAN_EraseChip() DONE AFTER %ld ms\r\n", HAL_GetTick() - dbgTime);
       retVal = true;
@@ -748,7 +2244,11 @@ bool FLASHMAN_EraseChip(FLASHMAN_HandleTypeDef *Handle)
 
   } while (0);
 
-  FLASHMAN_WriteDisable(Handle);
+  if (retVal == false)
+  {
+    FLASHMAN_WriteDisable(Handle);
+  }
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_ERASE_CHIP, FLASHMAN_BlockToAddress(FLASHMAN_BLOCK_CNT(Handle)), retVal));
   FLASHMAN_UnLock(Handle);
   return retVal;
 }
@@ -766,51 +2266,19 @@ bool FLASHMAN_EraseSector(FLASHMAN_HandleTypeDef *Handle, uint32_t Sector)
 {
   FLASHMAN_Lock(Handle);
   bool retVal = false;
-  uint32_t address = Sector * FLASHMAN_SECTOR_SIZE;
-  uint8_t tx[5];
   do
   {
 #if FLASHMAN_DEBUG != FLASHMAN_DEBUG_DISABLE
     uint32_t dbgTime = HAL_GetTick();
 #endif
     dprintf("FLASHMAN_EraseSector() START SECTOR %ld\r\n", Sector);
-    if (Sector >= Handle->SectorCnt)
+    if (Sector >= FLASHMAN_SECTOR_CNT(Handle))
     {
       dprintf("FLASHMAN_EraseSector() ERROR Sector NUMBER\r\n");
       break;
     }
-    if (FLASHMAN_WriteEnable(Handle) == false)
-    {
-      break;
-    }
-    FLASHMAN_CsPin(Handle, 0);
-    if (Handle->BlockCnt >= 512)
-    {
-      tx[0] = FLASHMAN_CMD_SECTORERASE4ADD;
-      tx[1] = (address & 0xFF000000) >> 24;
-      tx[2] = (address & 0x00FF0000) >> 16;
-      tx[3] = (address & 0x0000FF00) >> 8;
-      tx[4] = (address & 0x000000FF);
-      if (FLASHMAN_Transmit(Handle, tx, 5, 100) == false)
-      {
-        FLASHMAN_CsPin(Handle, 1);
-        break;
-      }
-    }
-    else
-    {
-      tx[0] = FLASHMAN_CMD_SECTORERASE3ADD;
-      tx[1] = (address & 0x00FF0000) >> 16;
-      tx[2] = (address & 0x0000FF00) >> 8;
-      tx[3] = (address & 0x000000FF);
-      if (FLASHMAN_Transmit(Handle, tx, 4, 100) == false)
-      {
-        FLASHMAN_CsPin(Handle, 1);
-        break;
-      }
-    }
-    FLASHMAN_CsPin(Handle, 1);
-    if (FLASHMAN_WaitForWriting(Handle, 1000))
+    FLASHMAN_WB(FLASHMAN_WbDrop(Handle, FLASHMAN_SectorToAddress(Sector), FLASHMAN_SECTOR_SIZE));
+    if (FLASHMAN_EraseFn(Handle, FLASHMAN_CMD_SECTORERASE3ADD, FLASHMAN_CMD_SECTORERASE4ADD, FLASHMAN_SectorToAddress(Sector), 1000, true))
     {
       dprintf("FLASHMAN_EraseSector() DONE AFTER %ld ms\r\n", HAL_GetTick() - dbgTime);
       retVal = true;
@@ -818,7 +2286,7 @@ bool FLASHMAN_EraseSector(FLASHMAN_HandleTypeDef *Handle, uint32_t Sector)
 
   } while (0);
 
-  FLASHMAN_WriteDisable(Handle);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_ERASE_SECTOR, FLASHMAN_SECTOR_SIZE, retVal));
   FLASHMAN_UnLock(Handle);
   return retVal;
 }
@@ -836,59 +2304,75 @@ bool FLASHMAN_EraseBlock(FLASHMAN_HandleTypeDef *Handle, uint32_t Block)
 {
   FLASHMAN_Lock(Handle);
   bool retVal = false;
-  uint32_t address = Block * FLASHMAN_BLOCK_SIZE;
-  uint8_t tx[5];
   do
   {
 #if FLASHMAN_DEBUG != FLASHMAN_DEBUG_DISABLE
     uint32_t dbgTime = HAL_GetTick();
 #endif
     dprintf("FLASHMAN_EraseBlock() START PAGE %ld\r\n", Block);
-    if (Block >= Handle->BlockCnt)
+    if (Block >= FLASHMAN_BLOCK_CNT(Handle))
     {
       dprintf("FLASHMAN_EraseBlock() ERROR Block NUMBER\r\n");
       break;
     }
-    if (FLASHMAN_WriteEnable(Handle) == false)
+    FLASHMAN_WB(FLASHMAN_WbDrop(Handle, FLASHMAN_BlockToAddress(Block), FLASHMAN_BLOCK_SIZE));
+    if (FLASHMAN_EraseFn(Handle, FLASHMAN_CMD_BLOCKERASE3ADD, FLASHMAN_CMD_BLOCKERASE4ADD, FLASHMAN_BlockToAddress(Block), 3000, true))
     {
-      break;
-    }
-    FLASHMAN_CsPin(Handle, 0);
-    if (Handle->BlockCnt >= 512)
-    {
-      tx[0] = FLASHMAN_CMD_BLOCKERASE4ADD;
-      tx[1] = (address & 0xFF000000) >> 24;
-      tx[2] = (address & 0x00FF0000) >> 16;
-      tx[3] = (address & 0x0000FF00) >> 8;
-      tx[4] = (address & 0x000000FF);
-      if (FLASHMAN_Transmit(Handle, tx, 5, 100) == false)
-      {
-        FLASHMAN_CsPin(Handle, 1);
-        break;
-      }
-    }
-    else
-    {
-      tx[0] = FLASHMAN_CMD_BLOCKERASE3ADD;
-      tx[1] = (address & 0x00FF0000) >> 16;
-      tx[2] = (address & 0x0000FF00) >> 8;
-      tx[3] = (address & 0x000000FF);
-      if (FLASHMAN_Transmit(Handle, tx, 4, 100) == false)
-      {
-        FLASHMAN_CsPin(Handle, 1);
-        break;
-      }
-    }
-    FLASHMAN_CsPin(Handle, 1);
-    if (FLASHMAN_WaitForWriting(Handle, 3000))
-    {
-      dprintf("FLASHMAN_EraseBlock() DONE AFTER %ld ms\r\n", HAL_GetTick() - dbgTime);
-      retVal = true;
+      dprintf("FLASHMAN_EraseBlock() DONE AFTER %ld ms\r\n", HAL_GetTick() - dbgTime);
+      retVal = true;
     }
 
   } while (0);
 
-  FLASHMAN_WriteDisable(Handle);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_ERASE_BLOCK, FLASHMAN_BLOCK_SIZE, retVal));
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Start erasing a Sector.
+  * @note   Send the Erase-Sector command and return without waiting.
+  * @note   The next access to the chip waits for the erase to finish, use FLASHMAN_IsBusy() to poll it
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  Sector: Selected Sector
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_EraseSectorAsync(FLASHMAN_HandleTypeDef *Handle, uint32_t Sector)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = false;
+  if (Sector < FLASHMAN_SECTOR_CNT(Handle))
+  {
+    FLASHMAN_WB(FLASHMAN_WbDrop(Handle, FLASHMAN_SectorToAddress(Sector), FLASHMAN_SECTOR_SIZE));
+    retVal = FLASHMAN_EraseFn(Handle, FLASHMAN_CMD_SECTORERASE3ADD, FLASHMAN_CMD_SECTORERASE4ADD, FLASHMAN_SectorToAddress(Sector), 1000, false);
+  }
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_ERASE_SECTOR, FLASHMAN_SECTOR_SIZE, retVal));
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Start erasing a Block.
+  * @note   Send the Erase-Block command and return without waiting.
+  * @note   The next access to the chip waits for the erase to finish, use FLASHMAN_IsBusy() to poll it
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  Block: Selected Block
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_EraseBlockAsync(FLASHMAN_HandleTypeDef *Handle, uint32_t Block)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = false;
+  if (Block < FLASHMAN_BLOCK_CNT(Handle))
+  {
+    FLASHMAN_WB(FLASHMAN_WbDrop(Handle, FLASHMAN_BlockToAddress(Block), FLASHMAN_BLOCK_SIZE));
+    retVal = FLASHMAN_EraseFn(Handle, FLASHMAN_CMD_BLOCKERASE3ADD, FLASHMAN_CMD_BLOCKERASE4ADD, FLASHMAN_BlockToAddress(Block), 3000, false);
+  }
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_ERASE_BLOCK, FLASHMAN_BLOCK_SIZE, retVal));
   FLASHMAN_UnLock(Handle);
   return retVal;
 }
@@ -909,37 +2393,101 @@ bool FLASHMAN_WriteAddress(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uin
 {
   FLASHMAN_Lock(Handle);
   bool retVal = false;
-  uint32_t page, add, offset, remaining, length, maximum, index = 0;
-  add = Address;
-  remaining = Size;
-  do
+  retVal = FLASHMAN_WriteAddressFn(Handle, Address, Data, Size, true);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_WRITE, Size, retVal));
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Write data array to an Address without waiting for the last page
+  * @note   Same as FLASHMAN_WriteAddress() but returns as soon as the last page program is started.
+  * @note   The next access to the chip waits for it, call FLASHMAN_Sync() to wait explicitly
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  Address: Start Address
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be written. (in byte)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_WriteAddressAsync(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = false;
+  retVal = FLASHMAN_WriteAddressFn(Handle, Address, Data, Size, false);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_WRITE, Size, retVal));
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Write data array to an Address and verify it
+  * @note   The CRC32 of each page is computed while the chip programs it, then the page is read back
+  *         in FLASHMAN_VERIFY_CHUNK pieces and compared by CRC, without a full-size copy in RAM.
+  * @note   A failing page is programmed again up to FLASHMAN_VERIFY_RETRY times.
+  * @note   All pages should be erased before write
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  Address: Start Address
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be written. (in byte)
+  * @param  *Crc: CRC32 of the whole range (output, can be NULL)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_WriteAddressVerified(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size, uint32_t *Crc)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = true;
+  uint32_t offset, length, crc = 0, dataCrc, readCrc;
+  FLASHMAN_STAT(uint32_t startAddress = Address);
+  uint8_t retry;
+  /* the read back has to see the programmed page, not the buffer */
+  FLASHMAN_WB(retVal = FLASHMAN_WbFlush(Handle, true));
+  while ((Size > 0) && retVal)
   {
-    page = FLASHMAN_AddressToPage(add);
-    offset = add % FLASHMAN_PAGE_SIZE;
-    maximum = FLASHMAN_PAGE_SIZE - offset;
-    if (remaining <= maximum)
+    offset = Address % FLASHMAN_PAGE_SIZE;
+    length = FLASHMAN_PAGE_SIZE - offset;
+    if (length > Size)
     {
-      length = remaining;
+      length = Size;
     }
-    else
-    {
-      length = maximum;
-    }
-    if (FLASHMAN_WriteFn(Handle, page, &Data[index], length, offset) == false)
-    {
-      break;
-    }
-    add += length;
-    index += length;
-    remaining -= length;
-    if (remaining == 0)
+    retVal = false;
+    dataCrc = 0;
+    for (retry = 0; retry <= FLASHMAN_VERIFY_RETRY; retry++)
     {
-      retVal = true;
-      break;
+      if (FLASHMAN_WriteFn(Handle, FLASHMAN_AddressToPage(Address), Data, length, offset, false) == false)
+      {
+        break;
+      }
+      if (retry == 0)
+      {
+        /* overlaps with the page program time */
+        dataCrc = FLASHMAN_Crc32(crc, Data, length);
+      }
+      readCrc = crc;
+      if (FLASHMAN_ReadCrcFn(Handle, Address, length, &readCrc) == false)
+      {
+        break;
+      }
+      if (readCrc == dataCrc)
+      {
+        retVal = true;
+        break;
+      }
+      dprintf("FLASHMAN_WriteAddressVerified() MISMATCH ADDRESS %ld RETRY %d\r\n", Address, retry);
     }
-
-  } while (remaining > 0);
-
+    crc = dataCrc;
+    Address += length;
+    Data += length;
+    Size -= length;
+  }
+  if (Crc != NULL)
+  {
+    *Crc = crc;
+  }
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_WRITE, Address - startAddress, retVal));
   FLASHMAN_UnLock(Handle);
   return retVal;
 }
@@ -961,7 +2509,8 @@ bool FLASHMAN_WritePage(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uin
 {
   FLASHMAN_Lock(Handle);
   bool retVal = false;
-  retVal = FLASHMAN_WriteFn(Handle, PageNumber, Data, Size, Offset);
+  retVal = FLASHMAN_BufferedWriteFn(Handle, PageNumber, Data, Size, Offset, true);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_WRITE, Size, retVal));
   FLASHMAN_UnLock(Handle);
   return retVal;
 }
@@ -1002,7 +2551,7 @@ bool FLASHMAN_WriteSector(FLASHMAN_HandleTypeDef *Handle, uint32_t SectorNumber,
     while (remainingBytes > 0 && pageNumber < ((SectorNumber + 1) * (FLASHMAN_SECTOR_SIZE / FLASHMAN_PAGE_SIZE)))
     {
       uint32_t bytesToWrite = (remainingBytes > FLASHMAN_PAGE_SIZE) ? FLASHMAN_PAGE_SIZE : remainingBytes;
-      if (FLASHMAN_WriteFn(Handle, pageNumber, Data + bytesWritten, bytesToWrite, pageOffset) == false)
+      if (FLASHMAN_BufferedWriteFn(Handle, pageNumber, Data + bytesWritten, bytesToWrite, pageOffset, true) == false)
       {
         retVal = false;
         break;
@@ -1012,6 +2561,7 @@ bool FLASHMAN_WriteSector(FLASHMAN_HandleTypeDef *Handle, uint32_t SectorNumber,
       pageNumber++;
       pageOffset = 0;
     }
+    FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_WRITE, bytesWritten, retVal));
   } while (0);
   FLASHMAN_UnLock(Handle);
   return retVal;
@@ -1053,7 +2603,7 @@ bool FLASHMAN_WriteBlock(FLASHMAN_HandleTypeDef *Handle, uint32_t BlockNumber, u
     while (remainingBytes > 0 && pageNumber < ((BlockNumber + 1) * (FLASHMAN_BLOCK_SIZE / FLASHMAN_PAGE_SIZE)))
     {
       uint32_t bytesToWrite = (remainingBytes > FLASHMAN_PAGE_SIZE) ? FLASHMAN_PAGE_SIZE : remainingBytes;
-      if (FLASHMAN_WriteFn(Handle, pageNumber, Data + bytesWritten, bytesToWrite, pageOffset) == false)
+      if (FLASHMAN_BufferedWriteFn(Handle, pageNumber, Data + bytesWritten, bytesToWrite, pageOffset, true) == false)
       {
         retVal = false;
         break;
@@ -1063,6 +2613,7 @@ bool FLASHMAN_WriteBlock(FLASHMAN_HandleTypeDef *Handle, uint32_t BlockNumber, u
       pageNumber++;
       pageOffset = 0;
     }
+    FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_WRITE, bytesWritten, retVal));
 
   } while (0);
 
@@ -1086,6 +2637,7 @@ bool FLASHMAN_ReadAddress(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint
   FLASHMAN_Lock(Handle);
   bool retVal = false;
   retVal = FLASHMAN_ReadFn(Handle, Address, Data, Size);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_READ, Size, retVal));
   FLASHMAN_UnLock(Handle);
   return retVal;
 }
@@ -1113,6 +2665,7 @@ bool FLASHMAN_ReadPage(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uint
     Size = maximum;
   }
   retVal = FLASHMAN_ReadFn(Handle, address, Data, Size);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_READ, Size, retVal));
   FLASHMAN_UnLock(Handle);
   return retVal;
 }
@@ -1140,6 +2693,7 @@ bool FLASHMAN_ReadSector(FLASHMAN_HandleTypeDef *Handle, uint32_t SectorNumber,
     Size = maximum;
   }
   retVal = FLASHMAN_ReadFn(Handle, address, Data, Size);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_READ, Size, retVal));
   FLASHMAN_UnLock(Handle);
   return retVal;
 }
@@ -1167,6 +2721,622 @@ bool FLASHMAN_ReadBlock(FLASHMAN_HandleTypeDef *Handle, uint32_t BlockNumber, ui
     Size = maximum;
   }
   retVal = FLASHMAN_ReadFn(Handle, address, Data, Size);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_READ, Size, retVal));
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Compare flash with data in RAM
+  * @note   The range is streamed through the FLASHMAN_READ_CHUNK sized chunks of the handle, so no
+  *         full-size copy is needed. The read stops at the first difference.
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  Address: Start Address
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be compared. (in byte)
+  * @param  *Mismatch: Offset of the first differing byte, Size if all match (output, can be NULL)
+  *
+  * @retval bool: true or false, a mismatch is not an error
+  */
+bool FLASHMAN_Compare(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, const uint8_t *Data, uint32_t Size, uint32_t *Mismatch)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = true;
+  uint32_t mismatch = 0;
+  /* compare what the chip will hold, not what it holds now */
+  FLASHMAN_WB(retVal = FLASHMAN_WbFlush(Handle, true));
+  if (retVal)
+  {
+    retVal = FLASHMAN_StreamFn(Handle, Address, Size, NULL, 0, 0, FLASHMAN_CompareChunk, (void *)Data, &mismatch);
+  }
+  if (Mismatch != NULL)
+  {
+    *Mismatch = mismatch;
+  }
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_READ, mismatch, retVal));
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Read a range chunk by chunk into caller buffers and hand each chunk to a callback
+  * @note   The whole range is one READ command. With DMA the next chunk is received while the
+  *         callback works on the current one, so the bus stays busy as long as the callback is
+  *         faster than a chunk transfer. Buffers are used in turn, during a call the last
+  *         BufferCnt - 1 chunks are still intact.
+  * @note   The callback runs with the handle locked, it must not call FLASHMAN functions on it.
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  Address: Start Address
+  * @param  Size: The length of data should be read. (in byte)
+  * @param  *Buffers: BufferCnt buffers of BufferSize bytes
+  * @param  BufferCnt: Number of buffers, at least 2
+  * @param  BufferSize: Chunk size, at most FLASHMAN_HAL_CHUNK is used
+  * @param  Callback: Called for each chunk in address order, returning false stops the read
+  * @param  *Context: Passed to Callback
+  *
+  * @retval bool: true or false, a stop from the callback is not an error
+  */
+bool FLASHMAN_ReadStream(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size, uint8_t *const *Buffers, uint32_t BufferCnt,
+                         uint32_t BufferSize, FLASHMAN_ReadCallbackTypeDef Callback, void *Context)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = false;
+  uint32_t done = 0;
+  FLASHMAN_CallbackTypeDef callback = {Callback, Context};
+  do
+  {
+    if ((Buffers == NULL) || (BufferCnt < 2) || (BufferSize == 0) || (Callback == NULL))
+    {
+      break;
+    }
+    retVal = true;
+    FLASHMAN_WB(retVal = FLASHMAN_WbFlush(Handle, true));
+    if (retVal)
+    {
+      retVal = FLASHMAN_StreamFn(Handle, Address, Size, Buffers, BufferCnt, BufferSize, FLASHMAN_CallbackChunk, &callback, &done);
+    }
+
+  } while (0);
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_READ, done, retVal));
   FLASHMAN_UnLock(Handle);
   return retVal;
 }
+
+/**
+  * @brief  CRC32, CRC32C or SHA-256 of a range
+  * @note   Streamed like FLASHMAN_Compare(), with DMA the digest of a chunk is computed while the
+  *         next one is received. CRC32 uses the FLASHMAN_CRC kernel, so FLASHMAN_Crc32Hw() on FLASHMAN_CRC_HW.
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  Address: Start Address
+  * @param  Size: The length of data. (in byte)
+  * @param  Algo: FLASHMAN_CHECKSUM_CRC32, FLASHMAN_CHECKSUM_CRC32C or FLASHMAN_CHECKSUM_SHA256
+  * @param  *Digest: Result (output), a uint32_t for the CRCs, FLASHMAN_SHA256_SIZE bytes for SHA-256
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_Checksum(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size, FLASHMAN_ChecksumTypeDef Algo, uint8_t *Digest)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = true;
+  uint32_t crc = 0, done = 0;
+  FLASHMAN_Sha256TypeDef sha;
+  FLASHMAN_WB(retVal = FLASHMAN_WbFlush(Handle, true));
+  if (retVal)
+  {
+    switch (Algo)
+    {
+    case FLASHMAN_CHECKSUM_CRC32:
+      retVal = FLASHMAN_StreamFn(Handle, Address, Size, NULL, 0, 0, FLASHMAN_Crc32Chunk, &crc, &done);
+      memcpy(Digest, &crc, sizeof(crc));
+      break;
+    case FLASHMAN_CHECKSUM_CRC32C:
+      retVal = FLASHMAN_StreamFn(Handle, Address, Size, NULL, 0, 0, FLASHMAN_Crc32cChunk, &crc, &done);
+      memcpy(Digest, &crc, sizeof(crc));
+      break;
+    case FLASHMAN_CHECKSUM_SHA256:
+      FLASHMAN_Sha256Init(&sha);
+      retVal = FLASHMAN_StreamFn(Handle, Address, Size, NULL, 0, 0, FLASHMAN_Sha256Chunk, &sha, &done);
+      FLASHMAN_Sha256Final(&sha, Digest);
+      break;
+    default:
+      retVal = false;
+      break;
+    }
+  }
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_READ, done, retVal));
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Copy a range to another address of the same chip or to another chip
+  * @note   Each destination sector is compared with the source first, one that already holds the data is
+  *         neither erased nor programmed. The others are erased right before they are programmed, with
+  *         one block erase if a whole block differs, and pages blank in the source are left erased.
+  * @note   Across two chips the next chunk is read from Src while Dst erases or programs the current
+  *         one. On one chip the reads wait for the chip instead.
+  * @note   The rest of the last destination sector is erased as well if it has to be rewritten.
+  *
+  * @param  *Src: Pointer to FLASHMAN_HandleTypeDef structure of the source chip
+  * @param  SrcAddress: Source start Address
+  * @param  *Dst: Pointer to FLASHMAN_HandleTypeDef structure of the destination chip, can be Src
+  * @param  DstAddress: Destination start Address, sector aligned. On one chip the ranges must not overlap
+  * @param  Size: The length of data. (in byte)
+  * @param  *Skipped: Bytes of destination sectors that already held the data and were left alone,
+  *                   blank source bytes in rewritten sectors are not counted (output, can be NULL)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_Copy(FLASHMAN_HandleTypeDef *Src, uint32_t SrcAddress, FLASHMAN_HandleTypeDef *Dst, uint32_t DstAddress, uint32_t Size, uint32_t *Skipped)
+{
+  /* always the same lock order, so copies in opposite directions cannot wait for each other */
+  FLASHMAN_HandleTypeDef *first = ((uintptr_t)Src < (uintptr_t)Dst) ? Src : Dst;
+  FLASHMAN_HandleTypeDef *second = (first == Src) ? Dst : Src;
+  FLASHMAN_Lock(first);
+  if (second != first)
+  {
+    FLASHMAN_Lock(second);
+  }
+  bool retVal = false, match;
+  uint32_t length, group, stale, done = 0, skipped = 0, erased;
+  do
+  {
+    if ((Src->Inited == 0) || (Dst->Inited == 0) || ((DstAddress % FLASHMAN_SECTOR_SIZE) != 0) ||
+        (SrcAddress > FLASHMAN_SectorToAddress(FLASHMAN_SECTOR_CNT(Src))) || (Size > FLASHMAN_SectorToAddress(FLASHMAN_SECTOR_CNT(Src)) - SrcAddress) ||
+        (DstAddress > FLASHMAN_SectorToAddress(FLASHMAN_SECTOR_CNT(Dst))) || (Size > FLASHMAN_SectorToAddress(FLASHMAN_SECTOR_CNT(Dst)) - DstAddress))
+    {
+      break;
+    }
+    erased = FLASHMAN_SectorToAddress(FLASHMAN_AddressToSector(Size + FLASHMAN_SECTOR_SIZE - 1));
+    if ((Src == Dst) && (Size > 0) && (SrcAddress < DstAddress + erased) && (DstAddress < SrcAddress + Size))
+    {
+      break;
+    }
+    retVal = true;
+    while (retVal && (done < Size))
+    {
+      /* sectors are compared a block at a time, a block stale all over takes one block erase */
+      group = (((DstAddress + done) % FLASHMAN_BLOCK_SIZE) == 0) && (Size - done >= FLASHMAN_BLOCK_SIZE) ? FLASHMAN_BLOCK_SIZE : FLASHMAN_SECTOR_SIZE;
+      stale = 0;
+      for (uint32_t offset = 0; retVal && (offset < group) && (done + offset < Size); offset += FLASHMAN_SECTOR_SIZE)
+      {
+        length = (Size - done - offset > FLASHMAN_SECTOR_SIZE) ? FLASHMAN_SECTOR_SIZE : Size - done - offset;
+        retVal = FLASHMAN_CopyMatch(Src, SrcAddress + done + offset, Dst, DstAddress + done + offset, length, &match);
+        if (retVal && match)
+        {
+          skipped += length;
+        }
+        else if (retVal)
+        {
+          stale |= 1UL << (offset / FLASHMAN_SECTOR_SIZE);
+        }
+      }
+      if (retVal && (group == FLASHMAN_BLOCK_SIZE) && (stale == (1UL << (FLASHMAN_BLOCK_SIZE / FLASHMAN_SECTOR_SIZE)) - 1))
+      {
+        FLASHMAN_WB(FLASHMAN_WbDrop(Dst, DstAddress + done, FLASHMAN_BLOCK_SIZE));
+        retVal = FLASHMAN_EraseFn(Dst, FLASHMAN_CMD_BLOCKERASE3ADD, FLASHMAN_CMD_BLOCKERASE4ADD, DstAddress + done, 3000, false) &&
+                 FLASHMAN_CopyProgram(Src, SrcAddress + done, Dst, DstAddress + done, FLASHMAN_BLOCK_SIZE);
+        stale = 0;
+      }
+      for (uint32_t offset = 0; retVal && (stale != 0); offset += FLASHMAN_SECTOR_SIZE, stale >>= 1)
+      {
+        if (stale & 1)
+        {
+          length = (Size - done - offset > FLASHMAN_SECTOR_SIZE) ? FLASHMAN_SECTOR_SIZE : Size - done - offset;
+          FLASHMAN_WB(FLASHMAN_WbDrop(Dst, DstAddress + done + offset, FLASHMAN_SECTOR_SIZE));
+          retVal = FLASHMAN_EraseFn(Dst, FLASHMAN_CMD_SECTORERASE3ADD, FLASHMAN_CMD_SECTORERASE4ADD, DstAddress + done + offset, 1000, false) &&
+                   FLASHMAN_CopyProgram(Src, SrcAddress + done + offset, Dst, DstAddress + done + offset, length);
+        }
+      }
+      done = (Size - done > group) ? done + group : Size;
+    }
+    retVal = retVal && FLASHMAN_WaitForReady(Dst);
+
+  } while (0);
+
+  if (Skipped != NULL)
+  {
+    *Skipped = skipped;
+  }
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Dst, FLASHMAN_STAT_WRITE, done, retVal));
+  if (second != first)
+  {
+    FLASHMAN_UnLock(second);
+  }
+  FLASHMAN_UnLock(first);
+  return retVal;
+}
+
+/**
+  * @brief  Bring a range to the content of an image in RAM, erasing and programming only what differs
+  * @note   Each sector is read and compared with the image first. A sector that holds the image is left
+  *         alone, one where the image only clears bits gets its differing pages programmed without an
+  *         erase. The others are erased, with one block erase if a whole block needs it, and the pages
+  *         of the image that are not blank are programmed.
+  * @note   The rest of the last sector is erased as well if that sector has to be erased.
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  Address: Start Address, sector aligned
+  * @param  *Image: Pointer to the image
+  * @param  Size: The length of the image. (in byte)
+  * @param  *Report: Sectors and pages touched and the time taken (output, can be NULL)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_WriteImage(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, const uint8_t *Image, uint32_t Size, FLASHMAN_ImageReportTypeDef *Report)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = false, block;
+  uint32_t length, group, erase, taken, done = 0, start = FLASHMAN_TIME_US();
+  uint32_t pages[FLASHMAN_BLOCK_SIZE / FLASHMAN_SECTOR_SIZE];
+  FLASHMAN_ImageDiffTypeDef diff;
+  FLASHMAN_ImageReportTypeDef report = {0};
+  do
+  {
+    if ((Handle->Inited == 0) || (Image == NULL) || ((Address % FLASHMAN_SECTOR_SIZE) != 0) ||
+        (Address > FLASHMAN_SectorToAddress(FLASHMAN_SECTOR_CNT(Handle))) || (Size > FLASHMAN_SectorToAddress(FLASHMAN_SECTOR_CNT(Handle)) - Address))
+    {
+      break;
+    }
+    retVal = true;
+    /* compare with what the chip will hold, the image replaces buffered bytes anyway */
+    FLASHMAN_WB(retVal = FLASHMAN_WbFlush(Handle, true));
+    while (retVal && (done < Size))
+    {
+      group = (((Address + done) % FLASHMAN_BLOCK_SIZE) == 0) && (Size - done >= FLASHMAN_BLOCK_SIZE) ? FLASHMAN_BLOCK_SIZE : FLASHMAN_SECTOR_SIZE;
+      erase = 0;
+      for (uint32_t offset = 0; retVal && (offset < group) && (done + offset < Size); offset += FLASHMAN_SECTOR_SIZE)
+      {
+        length = (Size - done - offset > FLASHMAN_SECTOR_SIZE) ? FLASHMAN_SECTOR_SIZE : Size - done - offset;
+        diff.Image = &Image[done + offset];
+        diff.Pages = 0;
+        diff.Erase = false;
+        retVal = FLASHMAN_StreamFn(Handle, Address + done + offset, length, NULL, 0, 0, FLASHMAN_ImageChunk, &diff, &taken);
+        pages[offset / FLASHMAN_SECTOR_SIZE] = diff.Pages;
+        if (diff.Erase)
+        {
+          erase |= 1UL << (offset / FLASHMAN_SECTOR_SIZE);
+        }
+        else if (diff.Pages == 0)
+        {
+          report.Unchanged++;
+        }
+        else
+        {
+          report.Cleared++;
+        }
+      }
+      block = (group == FLASHMAN_BLOCK_SIZE) && (erase == (1UL << (FLASHMAN_BLOCK_SIZE / FLASHMAN_SECTOR_SIZE)) - 1);
+      if (retVal && block)
+      {
+        retVal = FLASHMAN_EraseFn(Handle, FLASHMAN_CMD_BLOCKERASE3ADD, FLASHMAN_CMD_BLOCKERASE4ADD, Address + done, 3000, false);
+      }
+      for (uint32_t offset = 0; retVal && (offset < group) && (done + offset < Size); offset += FLASHMAN_SECTOR_SIZE)
+      {
+        length = (Size - done - offset > FLASHMAN_SECTOR_SIZE) ? FLASHMAN_SECTOR_SIZE : Size - done - offset;
+        if (erase & (1UL << (offset / FLASHMAN_SECTOR_SIZE)))
+        {
+          if (block == false)
+          {
+            retVal = FLASHMAN_EraseFn(Handle, FLASHMAN_CMD_SECTORERASE3ADD, FLASHMAN_CMD_SECTORERASE4ADD, Address + done + offset, 1000, false);
+          }
+          pages[offset / FLASHMAN_SECTOR_SIZE] = 0;
+          for (uint32_t page = 0; page < length; page += FLASHMAN_PAGE_SIZE)
+          {
+            if (FLASHMAN_Blank(&Image[done + offset + page], (length - page > FLASHMAN_PAGE_SIZE) ? FLASHMAN_PAGE_SIZE : length - page) == false)
+            {
+              pages[offset / FLASHMAN_SECTOR_SIZE] |= 1UL << (page / FLASHMAN_PAGE_SIZE);
+            }
+          }
+          report.Erased++;
+        }
+        retVal = retVal && FLASHMAN_ImageProgram(Handle, Address + done + offset, &Image[done + offset], length, pages[offset / FLASHMAN_SECTOR_SIZE], &report.Pages);
+      }
+      done = (Size - done > group) ? done + group : Size;
+    }
+    retVal = retVal && FLASHMAN_WaitForReady(Handle);
+
+  } while (0);
+
+  report.ElapsedUs = FLASHMAN_TIME_US() - start;
+  if (Report != NULL)
+  {
+    *Report = report;
+  }
+  FLASHMAN_STAT(FLASHMAN_StatsApi(Handle, FLASHMAN_STAT_WRITE, done, retVal));
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Check the chip for a running program or erase
+  * @note   Polls the status register only if an async call is still pending
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  *
+  * @retval bool: true if the chip is still busy
+  */
+bool FLASHMAN_IsBusy(FLASHMAN_HandleTypeDef *Handle)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = false;
+  if (Handle->Busy)
+  {
+    FLASHMAN_STAT(Handle->Stats.BusyPolls++);
+    if ((FLASHMAN_ReadReg1(Handle) & FLASHMAN_STATUS1_BUSY) == 0)
+    {
+      FLASHMAN_STAT(FLASHMAN_StatsBusyDone(Handle));
+      FLASHMAN_TRC(FLASHMAN_TraceBusy(Handle, true));
+      Handle->Busy = 0;
+    }
+  }
+  retVal = Handle->Busy;
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Wait for a pending async program or erase
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_Sync(FLASHMAN_HandleTypeDef *Handle)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = true;
+  FLASHMAN_WB(retVal = FLASHMAN_WbFlush(Handle, false));
+  retVal = FLASHMAN_WaitForReady(Handle) && retVal;
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+#if FLASHMAN_WRITEBACK == FLASHMAN_WRITEBACK_ENABLE
+/**
+  * @brief  Program the write-back buffer now
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_Flush(FLASHMAN_HandleTypeDef *Handle)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = false;
+  retVal = FLASHMAN_WbFlush(Handle, true);
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+
+/**
+  * @brief  Program the write-back buffer once it is older than FLASHMAN_WRITEBACK_MS
+  * @note   Call it periodically, e.g. from the idle loop or a timer task
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_WriteBackProcess(FLASHMAN_HandleTypeDef *Handle)
+{
+  FLASHMAN_Lock(Handle);
+  bool retVal = true;
+  if ((Handle->WbPage != FLASHMAN_WRITEBACK_NONE) && (HAL_GetTick() - Handle->WbTick >= FLASHMAN_WRITEBACK_MS))
+  {
+    retVal = FLASHMAN_WbFlush(Handle, true);
+  }
+  FLASHMAN_UnLock(Handle);
+  return retVal;
+}
+#endif
+
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+/**
+  * @brief  Copy the performance counters of a handle
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  *Stats: Pointer to FLASHMAN_StatsTypeDef structure (output)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_GetStats(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_StatsTypeDef *Stats)
+{
+  if ((Handle == NULL) || (Stats == NULL))
+  {
+    return false;
+  }
+  FLASHMAN_Lock(Handle);
+  memcpy(Stats, &Handle->Stats, sizeof(FLASHMAN_StatsTypeDef));
+  FLASHMAN_UnLock(Handle);
+  return true;
+}
+
+/**
+  * @brief  Clear the performance counters of a handle
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  */
+void FLASHMAN_ResetStats(FLASHMAN_HandleTypeDef *Handle)
+{
+  FLASHMAN_Lock(Handle);
+  memset(&Handle->Stats, 0, sizeof(FLASHMAN_StatsTypeDef));
+  FLASHMAN_UnLock(Handle);
+}
+#endif
+
+#if FLASHMAN_TRACE == FLASHMAN_TRACE_ENABLE
+/**
+  * @brief  Copy the transaction trace of a handle
+  * @note   The copy is a self-describing dump, write it out as is and decode it with Host/SPI_Flash_Trace.c
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  * @param  *Trace: Pointer to FLASHMAN_TraceTypeDef structure (output)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_GetTrace(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_TraceTypeDef *Trace)
+{
+  if ((Handle == NULL) || (Trace == NULL))
+  {
+    return false;
+  }
+  FLASHMAN_Lock(Handle);
+  memcpy(Trace, &Handle->Trace, sizeof(FLASHMAN_TraceTypeDef));
+  FLASHMAN_UnLock(Handle);
+  return true;
+}
+
+/**
+  * @brief  Clear the transaction trace of a handle
+  *
+  * @param  *Handle: Pointer to FLASHMAN_HandleTypeDef structure
+  */
+void FLASHMAN_ResetTrace(FLASHMAN_HandleTypeDef *Handle)
+{
+  FLASHMAN_Lock(Handle);
+  FLASHMAN_TraceInit(&Handle->Trace);
+  FLASHMAN_UnLock(Handle);
+}
+#endif
+
+/**
+  * @brief  Update a CRC32 (IEEE 802.3, reflected) with a data array
+  * @note   Start with Crc = 0, feed the result back in to continue over several calls
+  * @note   The kernel is chosen with FLASHMAN_CRC
+  *
+  * @param  Crc: Previous CRC value
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data. (in byte)
+  *
+  * @retval uint32_t: Updated CRC value
+  */
+uint32_t FLASHMAN_Crc32(uint32_t Crc, const uint8_t *Data, uint32_t Size)
+{
+#if FLASHMAN_CRC == FLASHMAN_CRC_HW
+  return FLASHMAN_Crc32Hw(Crc, Data, Size);
+#else
+  Crc = ~Crc;
+#if FLASHMAN_CRC == FLASHMAN_CRC_SLICE8
+  while (Size >= 8)
+  {
+    uint32_t lo = Crc ^ ((uint32_t)Data[0] | ((uint32_t)Data[1] << 8) | ((uint32_t)Data[2] << 16) | ((uint32_t)Data[3] << 24));
+    uint32_t hi = (uint32_t)Data[4] | ((uint32_t)Data[5] << 8) | ((uint32_t)Data[6] << 16) | ((uint32_t)Data[7] << 24);
+    Crc = FLASHMAN_CrcTable[7][lo & 0xFF] ^ FLASHMAN_CrcTable[6][(lo >> 8) & 0xFF] ^
+          FLASHMAN_CrcTable[5][(lo >> 16) & 0xFF] ^ FLASHMAN_CrcTable[4][lo >> 24] ^
+          FLASHMAN_CrcTable[3][hi & 0xFF] ^ FLASHMAN_CrcTable[2][(hi >> 8) & 0xFF] ^
+          FLASHMAN_CrcTable[1][(hi >> 16) & 0xFF] ^ FLASHMAN_CrcTable[0][hi >> 24];
+    Data += 8;
+    Size -= 8;
+  }
+#endif
+  while (Size--)
+  {
+    Crc = (Crc >> 8) ^ FLASHMAN_CrcTable[0][(Crc ^ *Data++) & 0xFF];
+  }
+  return ~Crc;
+#endif
+}
+
+/**
+  * @brief  Update a CRC32C (Castagnoli, reflected) with a data array
+  * @note   Start with Crc = 0, feed the result back in to continue over several calls
+  *
+  * @param  Crc: Previous CRC value
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data. (in byte)
+  *
+  * @retval uint32_t: Updated CRC value
+  */
+uint32_t FLASHMAN_Crc32c(uint32_t Crc, const uint8_t *Data, uint32_t Size)
+{
+  Crc = ~Crc;
+  while (Size--)
+  {
+    Crc = (Crc >> 8) ^ FLASHMAN_Crc32cTable[(Crc ^ *Data++) & 0xFF];
+  }
+  return ~Crc;
+}
+
+/**
+  * @brief  Start a SHA-256
+  *
+  * @param  *Sha: Pointer to FLASHMAN_Sha256TypeDef structure
+  */
+void FLASHMAN_Sha256Init(FLASHMAN_Sha256TypeDef *Sha)
+{
+  static const uint32_t init[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+  memcpy(Sha->State, init, sizeof(init));
+  Sha->Length = 0;
+  Sha->Fill = 0;
+}
+
+/**
+  * @brief  Add data to a SHA-256
+  *
+  * @param  *Sha: Pointer to FLASHMAN_Sha256TypeDef structure
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data. (in byte)
+  */
+void FLASHMAN_Sha256Update(FLASHMAN_Sha256TypeDef *Sha, const uint8_t *Data, uint32_t Size)
+{
+  uint32_t length;
+  Sha->Length += Size;
+  while (Size > 0)
+  {
+    if ((Sha->Fill == 0) && (Size >= sizeof(Sha->Block)))
+    {
+      FLASHMAN_Sha256Block(Sha, Data);
+      Data += sizeof(Sha->Block);
+      Size -= sizeof(Sha->Block);
+      continue;
+    }
+    length = sizeof(Sha->Block) - Sha->Fill;
+    if (length > Size)
+    {
+      length = Size;
+    }
+    memcpy(&Sha->Block[Sha->Fill], Data, length);
+    Sha->Fill += length;
+    Data += length;
+    Size -= length;
+    if (Sha->Fill == sizeof(Sha->Block))
+    {
+      FLASHMAN_Sha256Block(Sha, Sha->Block);
+      Sha->Fill = 0;
+    }
+  }
+}
+
+/**
+  * @brief  Finish a SHA-256
+  *
+  * @param  *Sha: Pointer to FLASHMAN_Sha256TypeDef structure
+  * @param  *Digest: FLASHMAN_SHA256_SIZE bytes (output)
+  */
+void FLASHMAN_Sha256Final(FLASHMAN_Sha256TypeDef *Sha, uint8_t *Digest)
+{
+  uint64_t bits = Sha->Length * 8;
+  Sha->Block[Sha->Fill++] = 0x80;
+  if (Sha->Fill > sizeof(Sha->Block) - 8)
+  {
+    memset(&Sha->Block[Sha->Fill], 0, sizeof(Sha->Block) - Sha->Fill);
+    FLASHMAN_Sha256Block(Sha, Sha->Block);
+    Sha->Fill = 0;
+  }
+  memset(&Sha->Block[Sha->Fill], 0, sizeof(Sha->Block) - 8 - Sha->Fill);
+  for (int i = 0; i < 8; i++)
+  {
+    Sha->Block[sizeof(Sha->Block) - 1 - i] = (uint8_t)(bits >> (i * 8));
+  }
+  FLASHMAN_Sha256Block(Sha, Sha->Block);
+  for (int i = 0; i < 8; i++)
+  {
+    Digest[i * 4] = (uint8_t)(Sha->State[i] >> 24);
+    Digest[i * 4 + 1] = (uint8_t)(Sha->State[i] >> 16);
+    Digest[i * 4 + 2] = (uint8_t)(Sha->State[i] >> 8);
+    Digest[i * 4 + 3] = (uint8_t)Sha->State[i];
+  }
+}
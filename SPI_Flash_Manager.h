@@ -9,7 +9,6 @@ extern "C"
 
 #include <stdbool.h>
 #include <string.h>
-#include "spi.h"
 
 #define FLASHMAN_DEBUG_DISABLE                    0
 #define FLASHMAN_DEBUG_MIN                        1
@@ -17,33 +16,152 @@ extern "C"
 
 #define FLASHMAN_PLATFORM_HAL                     0
 #define FLASHMAN_PLATFORM_HAL_DMA                 1
+#define FLASHMAN_PLATFORM_LINUX_SPIDEV            2
 
 #define FLASHMAN_RTOS_DISABLE                     0
 #define FLASHMAN_RTOS_CMSIS_V1                    1
 #define FLASHMAN_RTOS_CMSIS_V2                    2
 #define FLASHMAN_RTOS_THREADX                     3
 
+#define FLASHMAN_FS_DISABLE                       0
+#define FLASHMAN_FS_LITTLEFS                      1
+#define FLASHMAN_FS_FATFS                         2
+
+#define FLASHMAN_CRC_TABLE                        0
+#define FLASHMAN_CRC_SLICE8                       1
+#define FLASHMAN_CRC_HW                           2
+
+#define FLASHMAN_STATS_DISABLE                    0
+#define FLASHMAN_STATS_ENABLE                     1
+
+#define FLASHMAN_TRACE_DISABLE                    0
+#define FLASHMAN_TRACE_ENABLE                     1
+
+#define FLASHMAN_XFER_SPLIT                       0
+#define FLASHMAN_XFER_SINGLE                      1
 
+#define FLASHMAN_WRITEBACK_DISABLE                0
+#define FLASHMAN_WRITEBACK_ENABLE                 1
+
+#define FLASHMAN_CALIBRATE_DISABLE                0
+#define FLASHMAN_CALIBRATE_ENABLE                 1
+
+/* edit here, or override from the compiler command line (host builds) */
+#ifndef FLASHMAN_DEBUG
 #define FLASHMAN_DEBUG      FLASHMAN_DEBUG_DISABLE
+#endif
+#ifndef FLASHMAN_PLATFORM
 #define FLASHMAN_PLATFORM      FLASHMAN_PLATFORM_HAL
+#endif
+#ifndef FLASHMAN_RTOS
 #define FLASHMAN_RTOS      FLASHMAN_RTOS_DISABLE
+#endif
+#ifndef FLASHMAN_FS
+#define FLASHMAN_FS      FLASHMAN_FS_DISABLE
+#endif
+#ifndef FLASHMAN_CRC
+#define FLASHMAN_CRC      FLASHMAN_CRC_TABLE
+#endif
+#ifndef FLASHMAN_STATS
+#define FLASHMAN_STATS      FLASHMAN_STATS_ENABLE
+#endif
+#ifndef FLASHMAN_TRACE
+#define FLASHMAN_TRACE      FLASHMAN_TRACE_DISABLE
+#endif
+#ifndef FLASHMAN_XFER
+#define FLASHMAN_XFER      FLASHMAN_XFER_SINGLE
+#endif
+#ifndef FLASHMAN_WRITEBACK
+#define FLASHMAN_WRITEBACK      FLASHMAN_WRITEBACK_DISABLE
+#endif
+#ifndef FLASHMAN_CALIBRATE
+#define FLASHMAN_CALIBRATE      FLASHMAN_CALIBRATE_DISABLE
+#endif
+
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+#include "SPI_Flash_Manager_Spidev.h"
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_ENABLE
+#error "FLASHMAN_CALIBRATE_ENABLE needs an STM32 HAL platform, set the speed in FLASHMAN_SpidevOpen()"
+#endif
+#else
+#include "spi.h"
+typedef SPI_HandleTypeDef FLASHMAN_SpiTypeDef;
+typedef GPIO_TypeDef      FLASHMAN_GpioTypeDef;
+#endif
+
+/* single-part builds: number of 64 KB blocks of the only supported part (256 for 128 Mbit), 0 detects it
+   at runtime. Address width and bounds become constants, FLASHMAN_Init() fails on any other part */
+#ifndef FLASHMAN_FIXED_BLOCK_CNT
+#define FLASHMAN_FIXED_BLOCK_CNT                0
+#endif
+
+/* largest single HAL call, HAL transfer sizes are 16 bit */
+#ifndef FLASHMAN_HAL_CHUNK
+#define FLASHMAN_HAL_CHUNK                      0x8000
+#endif
+#ifndef FLASHMAN_VERIFY_CHUNK
+#define FLASHMAN_VERIFY_CHUNK                   32
+#endif
+#ifndef FLASHMAN_VERIFY_RETRY
+#define FLASHMAN_VERIFY_RETRY                   2
+#endif
+/* streamed reads (FLASHMAN_Compare(), FLASHMAN_Checksum(), FLASHMAN_Copy(), FLASHMAN_WriteImage()) go through two chunks of this size in the handle, at most FLASHMAN_HAL_CHUNK */
+#ifndef FLASHMAN_READ_CHUNK
+#define FLASHMAN_READ_CHUNK                     256
+#endif
+
+/* microsecond time stamp for statistics, e.g. the DWT cycle counter divided down on Cortex-M */
+#ifndef FLASHMAN_TIME_US
+#define FLASHMAN_TIME_US()                      (HAL_GetTick() * 1000)
+#endif
+#define FLASHMAN_STATS_BUCKETS                  24
+
+/* trace ring size in records, a dump is sizeof(FLASHMAN_TraceTypeDef) bytes */
+#ifndef FLASHMAN_TRACE_SIZE
+#define FLASHMAN_TRACE_SIZE                     64
+#endif
+#define FLASHMAN_TRACE_MAGIC                    0x52544D46
+
+/* a partly written page is kept at most this long (ms), checked by FLASHMAN_WriteBackProcess() and the next write */
+#ifndef FLASHMAN_WRITEBACK_MS
+#define FLASHMAN_WRITEBACK_MS                   100
+#endif
+#define FLASHMAN_WRITEBACK_NONE                 0xFFFFFFFF
+
+/* clock calibration in FLASHMAN_Init(): the CubeMX prescaler is the slowest setting tried. Faster ones
+   must pass every round, the result is then slowed down by MARGIN prescaler steps (one step halves SCK).
+   READ frames are checked against FLASHMAN_READ_CHUNK bytes at ADDRESS, which should not be blank */
+#ifndef FLASHMAN_CALIBRATE_ROUNDS
+#define FLASHMAN_CALIBRATE_ROUNDS               8
+#endif
+#ifndef FLASHMAN_CALIBRATE_MARGIN
+#define FLASHMAN_CALIBRATE_MARGIN               1
+#endif
+#ifndef FLASHMAN_CALIBRATE_ADDRESS
+#define FLASHMAN_CALIBRATE_ADDRESS              0
+#endif
 
 
 #define FLASHMAN_PAGE_SIZE                      0x100
 #define FLASHMAN_SECTOR_SIZE                    0x1000
 #define FLASHMAN_BLOCK_SIZE                     0x10000
+#define FLASHMAN_HEADER_MAX                     5
 
-#define FLASHMAN_PageToSector(PageNumber)      ((PageNumber * FLASHMAN_PAGE_SIZE) / FLASHMAN_SECTOR_SIZE)
-#define FLASHMAN_PageToBlock(PageNumber)       ((PageNumber * FLASHMAN_PAGE_SIZE) / FLASHMAN_BLOCK_SIZE)
-#define FLASHMAN_SectorToBlock(SectorNumber)   ((SectorNumber * FLASHMAN_SECTOR_SIZE) / FLASHMAN_BLOCK_SIZE)
-#define FLASHMAN_SectorToPage(SectorNumber)    ((SectorNumber * FLASHMAN_SECTOR_SIZE) / FLASHMAN_PAGE_SIZE)
-#define FLASHMAN_BlockToPage(BlockNumber)      ((BlockNumber * FLASHMAN_BLOCK_SIZE) / FLASHMAN_PAGE_SIZE)
-#define FLASHMAN_PageToAddress(PageNumber)     (PageNumber * FLASHMAN_PAGE_SIZE)
-#define FLASHMAN_SectorToAddress(SectorNumber) (SectorNumber * FLASHMAN_SECTOR_SIZE)
-#define FLASHMAN_BlockToAddress(BlockNumber)   (BlockNumber * FLASHMAN_BLOCK_SIZE)
-#define FLASHMAN_AddressToPage(Address)        (Address / FLASHMAN_PAGE_SIZE)
-#define FLASHMAN_AddressToSector(Address)      (Address / FLASHMAN_SECTOR_SIZE)
-#define FLASHMAN_AddressToBlock(Address)       (Address / FLASHMAN_BLOCK_SIZE)
+#define FLASHMAN_PAGE_SHIFT                     8
+#define FLASHMAN_SECTOR_SHIFT                   12
+#define FLASHMAN_BLOCK_SHIFT                    16
+
+#define FLASHMAN_PageToSector(PageNumber)      ((uint32_t)(PageNumber) >> (FLASHMAN_SECTOR_SHIFT - FLASHMAN_PAGE_SHIFT))
+#define FLASHMAN_PageToBlock(PageNumber)       ((uint32_t)(PageNumber) >> (FLASHMAN_BLOCK_SHIFT - FLASHMAN_PAGE_SHIFT))
+#define FLASHMAN_SectorToBlock(SectorNumber)   ((uint32_t)(SectorNumber) >> (FLASHMAN_BLOCK_SHIFT - FLASHMAN_SECTOR_SHIFT))
+#define FLASHMAN_SectorToPage(SectorNumber)    ((uint32_t)(SectorNumber) << (FLASHMAN_SECTOR_SHIFT - FLASHMAN_PAGE_SHIFT))
+#define FLASHMAN_BlockToPage(BlockNumber)      ((uint32_t)(BlockNumber) << (FLASHMAN_BLOCK_SHIFT - FLASHMAN_PAGE_SHIFT))
+#define FLASHMAN_PageToAddress(PageNumber)     ((uint32_t)(PageNumber) << FLASHMAN_PAGE_SHIFT)
+#define FLASHMAN_SectorToAddress(SectorNumber) ((uint32_t)(SectorNumber) << FLASHMAN_SECTOR_SHIFT)
+#define FLASHMAN_BlockToAddress(BlockNumber)   ((uint32_t)(BlockNumber) << FLASHMAN_BLOCK_SHIFT)
+#define FLASHMAN_AddressToPage(Address)        ((uint32_t)(Address) >> FLASHMAN_PAGE_SHIFT)
+#define FLASHMAN_AddressToSector(Address)      ((uint32_t)(Address) >> FLASHMAN_SECTOR_SHIFT)
+#define FLASHMAN_AddressToBlock(Address)       ((uint32_t)(Address) >> FLASHMAN_BLOCK_SHIFT)
 
 #define FLASHMAN_DUMMY_BYTE 0xA5
 
@@ -146,38 +264,234 @@ typedef enum
 
 } FLASHMAN_SizeTypeDef;
 
+typedef enum
+{
+  FLASHMAN_STAT_READ = 0,
+  FLASHMAN_STAT_WRITE,
+  FLASHMAN_STAT_ERASE_SECTOR,
+  FLASHMAN_STAT_ERASE_BLOCK,
+  FLASHMAN_STAT_ERASE_CHIP,
+  FLASHMAN_STAT_API_CNT,
+
+} FLASHMAN_StatApiTypeDef;
+
+typedef enum
+{
+  FLASHMAN_STAT_OP_NONE = 0,
+  FLASHMAN_STAT_OP_PROGRAM,
+  FLASHMAN_STAT_OP_ERASE,
+
+} FLASHMAN_StatOpTypeDef;
+
+/* Hist[i] counts latencies of [2^(i-1), 2^i) us, the last bucket takes everything longer */
+typedef struct
+{
+  uint32_t               Ops[FLASHMAN_STAT_API_CNT];
+  uint32_t               Errors[FLASHMAN_STAT_API_CNT];
+  uint64_t               Bytes[FLASHMAN_STAT_API_CNT];
+  uint32_t               PagePrograms;
+  uint32_t               BusyPolls;
+  uint32_t               BusyTimeouts;
+  uint32_t               LockWaits;
+  uint32_t               LockWaitUs;
+  uint32_t               ReadHist[FLASHMAN_STATS_BUCKETS];
+  uint32_t               ProgramHist[FLASHMAN_STATS_BUCKETS];
+  uint32_t               EraseHist[FLASHMAN_STATS_BUCKETS];
+
+} FLASHMAN_StatsTypeDef;
+
+typedef enum
+{
+  FLASHMAN_TRACE_OK = 0,
+  FLASHMAN_TRACE_ERROR,
+  FLASHMAN_TRACE_TIMEOUT,
+  FLASHMAN_TRACE_PENDING,
+
+} FLASHMAN_TraceResultTypeDef;
+
+typedef enum
+{
+  FLASHMAN_CHECKSUM_CRC32 = 0,
+  FLASHMAN_CHECKSUM_CRC32C,
+  FLASHMAN_CHECKSUM_SHA256,
+
+} FLASHMAN_ChecksumTypeDef;
+
+/* the probed part, FLASHMAN_InitWarm() starts from it instead of probing again */
+#define FLASHMAN_DESCRIPTOR_MAGIC               0x464D4431
+
 typedef struct
 {
-  SPI_HandleTypeDef      *hspi;
-  GPIO_TypeDef           *gpio;
+  uint32_t               Magic;
+  uint8_t                MANUF;
+  uint8_t                MemType;
+  uint8_t                Size;
+  uint8_t                Reserved;
+  uint32_t               BlockCnt;
+  uint32_t               ReadPrescaler;    /* FLASHMAN_CALIBRATE_ENABLE builds, 0 otherwise */
+  uint32_t               CmdPrescaler;
+  uint32_t               Crc;              /* FLASHMAN_Crc32() of the fields above */
+
+} FLASHMAN_DescriptorTypeDef;
+
+/* what FLASHMAN_WriteImage() did, sectors are counted once each */
+typedef struct
+{
+  uint32_t               Unchanged;        /* sectors that already held the image */
+  uint32_t               Cleared;          /* sectors programmed without an erase */
+  uint32_t               Erased;           /* sectors erased and programmed */
+  uint32_t               Pages;            /* page programs */
+  uint32_t               ElapsedUs;        /* in FLASHMAN_TIME_US() */
+
+} FLASHMAN_ImageReportTypeDef;
+
+#define FLASHMAN_SHA256_SIZE                    32
+
+typedef struct
+{
+  uint32_t               State[8];
+  uint64_t               Length;
+  uint32_t               Fill;
+  uint8_t                Block[64];
+
+} FLASHMAN_Sha256TypeDef;
+
+/* called for each chunk of FLASHMAN_ReadStream() in address order, return false to stop the read */
+typedef bool (*FLASHMAN_ReadCallbackTypeDef)(void *Context, const uint8_t *Data, uint32_t Offset, uint32_t Size);
+
+/* one CS frame of a read, program or erase, times in FLASHMAN_TIME_US() */
+typedef struct
+{
+  uint32_t               CsLow;
+  uint32_t               CsHigh;
+  uint32_t               Address;
+  uint32_t               Length;
+  uint32_t               BusyUs;           /* CS high until the poll that saw the chip ready */
+  uint8_t                Cmd;
+  uint8_t                Result;
+  uint16_t               Reserved;
+
+} FLASHMAN_TraceRecordTypeDef;
+
+/* newest record is Record[(Head - 1) % Size], decoded on the host by Host/SPI_Flash_Trace.c */
+typedef struct
+{
+  uint32_t               Magic;
+  uint16_t               RecordSize;
+  uint16_t               Size;
+  uint32_t               Head;
+  uint32_t               Pending;
+  FLASHMAN_TraceRecordTypeDef Record[FLASHMAN_TRACE_SIZE];
+
+} FLASHMAN_TraceTypeDef;
+
+typedef struct
+{
+  FLASHMAN_SpiTypeDef    *hspi;
+  FLASHMAN_GpioTypeDef   *gpio;
   FLASHMAN_MANUFTypeDef MANUF;
   FLASHMAN_SizeTypeDef       Size;
   uint8_t                Inited;
   uint8_t                MemType;
   uint8_t                Lock;
-  uint8_t                Reserved;
+  uint8_t                Busy;
   uint32_t               Pin;
   uint32_t               PageCnt;
   uint32_t               SectorCnt;
   uint32_t               BlockCnt;
+  uint32_t               BusyTimeout;
+#if FLASHMAN_CALIBRATE == FLASHMAN_CALIBRATE_ENABLE
+  /* SPI_BAUDRATEPRESCALER_x of READ frames and of all other frames, found by FLASHMAN_Init() */
+  uint32_t               ReadPrescaler;
+  uint32_t               CmdPrescaler;
+#endif
+#if FLASHMAN_XFER == FLASHMAN_XFER_SINGLE
+  /* opcode, address and payload of one frame, also the in-place rx buffer of reads up to a page */
+  uint8_t                Xfer[FLASHMAN_HEADER_MAX + FLASHMAN_PAGE_SIZE];
+#endif
+  /* one chunk is processed while the next one is received */
+  uint8_t                Chunk[2][FLASHMAN_READ_CHUNK];
+#if FLASHMAN_PLATFORM == FLASHMAN_PLATFORM_LINUX_SPIDEV
+  /* transfers of the next SPI_IOC_MESSAGE, short tx data is copied as the caller's buffer can be gone by then */
+  struct spi_ioc_transfer Msg[FLASHMAN_SPIDEV_XFERS];
+  uint32_t               MsgCnt;
+  uint32_t               MsgBytes;
+  uint8_t                MsgTx[FLASHMAN_SPIDEV_XFERS][FLASHMAN_HEADER_MAX];
+  uint8_t                MsgHeld;          /* the last message left CS asserted */
+#endif
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+  uint32_t               BusyStart;
+  FLASHMAN_StatOpTypeDef BusyOp;
+  FLASHMAN_StatsTypeDef  Stats;
+#endif
+#if FLASHMAN_TRACE == FLASHMAN_TRACE_ENABLE
+  FLASHMAN_TraceTypeDef  Trace;
+#endif
+#if FLASHMAN_WRITEBACK == FLASHMAN_WRITEBACK_ENABLE
+  /* partial page writes gathered here, bytes WbLo..WbHi-1 of page WbPage are valid */
+  uint32_t               WbPage;
+  uint32_t               WbTick;
+  uint16_t               WbLo;
+  uint16_t               WbHi;
+  uint8_t                WbData[FLASHMAN_PAGE_SIZE];
+#endif
 
 } FLASHMAN_HandleTypeDef;
 
-bool FLASHMAN_Init(FLASHMAN_HandleTypeDef *Handle, SPI_HandleTypeDef *hspi, GPIO_TypeDef *gpio, uint16_t Pin);
+bool FLASHMAN_Init(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_SpiTypeDef *hspi, FLASHMAN_GpioTypeDef *gpio, uint16_t Pin);
+bool FLASHMAN_InitWarm(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_SpiTypeDef *hspi, FLASHMAN_GpioTypeDef *gpio, uint16_t Pin,
+                       const FLASHMAN_DescriptorTypeDef *Descriptor);
+bool FLASHMAN_GetDescriptor(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_DescriptorTypeDef *Descriptor);
 
 bool FLASHMAN_EraseChip(FLASHMAN_HandleTypeDef *Handle);
 bool FLASHMAN_EraseSector(FLASHMAN_HandleTypeDef *Handle, uint32_t Sector);
 bool FLASHMAN_EraseBlock(FLASHMAN_HandleTypeDef *Handle, uint32_t Block);
+bool FLASHMAN_EraseSectorAsync(FLASHMAN_HandleTypeDef *Handle, uint32_t Sector);
+bool FLASHMAN_EraseBlockAsync(FLASHMAN_HandleTypeDef *Handle, uint32_t Block);
 
 bool FLASHMAN_WriteAddress(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size);
 bool FLASHMAN_WritePage(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uint8_t *Data, uint32_t Size, uint32_t Offset);
 bool FLASHMAN_WriteSector(FLASHMAN_HandleTypeDef *Handle, uint32_t SectorNumber, uint8_t *Data, uint32_t Size, uint32_t Offset);
 bool FLASHMAN_WriteBlock(FLASHMAN_HandleTypeDef *Handle, uint32_t BlockNumber, uint8_t *Data, uint32_t Size, uint32_t Offset);
+bool FLASHMAN_WriteAddressAsync(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size);
+bool FLASHMAN_WriteAddressVerified(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size, uint32_t *Crc);
 
 bool FLASHMAN_ReadAddress(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint8_t *Data, uint32_t Size);
 bool FLASHMAN_ReadPage(FLASHMAN_HandleTypeDef *Handle, uint32_t PageNumber, uint8_t *Data, uint32_t Size, uint32_t Offset);
 bool FLASHMAN_ReadSector(FLASHMAN_HandleTypeDef *Handle, uint32_t SectorNumber, uint8_t *Data, uint32_t Size, uint32_t Offset);
 bool FLASHMAN_ReadBlock(FLASHMAN_HandleTypeDef *Handle, uint32_t BlockNumber, uint8_t *Data, uint32_t Size, uint32_t Offset);
+bool FLASHMAN_Compare(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, const uint8_t *Data, uint32_t Size, uint32_t *Mismatch);
+bool FLASHMAN_ReadStream(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size, uint8_t *const *Buffers, uint32_t BufferCnt,
+                         uint32_t BufferSize, FLASHMAN_ReadCallbackTypeDef Callback, void *Context);
+bool FLASHMAN_Checksum(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t Size, FLASHMAN_ChecksumTypeDef Algo, uint8_t *Digest);
+bool FLASHMAN_Copy(FLASHMAN_HandleTypeDef *Src, uint32_t SrcAddress, FLASHMAN_HandleTypeDef *Dst, uint32_t DstAddress, uint32_t Size, uint32_t *Skipped);
+bool FLASHMAN_WriteImage(FLASHMAN_HandleTypeDef *Handle, uint32_t Address, const uint8_t *Image, uint32_t Size, FLASHMAN_ImageReportTypeDef *Report);
+
+bool FLASHMAN_IsBusy(FLASHMAN_HandleTypeDef *Handle);
+bool FLASHMAN_Sync(FLASHMAN_HandleTypeDef *Handle);
+#if FLASHMAN_WRITEBACK == FLASHMAN_WRITEBACK_ENABLE
+bool FLASHMAN_Flush(FLASHMAN_HandleTypeDef *Handle);
+bool FLASHMAN_WriteBackProcess(FLASHMAN_HandleTypeDef *Handle);
+#endif
+
+#if FLASHMAN_STATS == FLASHMAN_STATS_ENABLE
+bool FLASHMAN_GetStats(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_StatsTypeDef *Stats);
+void FLASHMAN_ResetStats(FLASHMAN_HandleTypeDef *Handle);
+#endif
+#if FLASHMAN_TRACE == FLASHMAN_TRACE_ENABLE
+bool FLASHMAN_GetTrace(FLASHMAN_HandleTypeDef *Handle, FLASHMAN_TraceTypeDef *Trace);
+void FLASHMAN_ResetTrace(FLASHMAN_HandleTypeDef *Handle);
+#endif
+
+uint32_t FLASHMAN_Crc32(uint32_t Crc, const uint8_t *Data, uint32_t Size);
+uint32_t FLASHMAN_Crc32c(uint32_t Crc, const uint8_t *Data, uint32_t Size);
+void FLASHMAN_Sha256Init(FLASHMAN_Sha256TypeDef *Sha);
+void FLASHMAN_Sha256Update(FLASHMAN_Sha256TypeDef *Sha, const uint8_t *Data, uint32_t Size);
+void FLASHMAN_Sha256Final(FLASHMAN_Sha256TypeDef *Sha, uint8_t *Digest);
+#if FLASHMAN_CRC == FLASHMAN_CRC_HW
+/* provided by the application, same contract as FLASHMAN_Crc32() */
+uint32_t FLASHMAN_Crc32Hw(uint32_t Crc, const uint8_t *Data, uint32_t Size);
+#endif
 
 #ifdef __cplusplus
 }
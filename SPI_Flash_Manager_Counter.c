@@ -0,0 +1,243 @@
+#include "SPI_Flash_Manager_Counter.h"
+
+/* bits cleared by one program, the first byte may be partly cleared already */
+#define FLASHMAN_COUNTER_CHUNK                  16
+
+static uint32_t FLASHMAN_CounterZeros(uint32_t Word);
+static bool     FLASHMAN_CounterHeader(FLASHMAN_CounterTypeDef *Counter, uint32_t Index, uint32_t *Base);
+static bool     FLASHMAN_CounterScan(FLASHMAN_CounterTypeDef *Counter);
+static bool     FLASHMAN_CounterSwitch(FLASHMAN_CounterTypeDef *Counter);
+
+static uint32_t FLASHMAN_CounterZeros(uint32_t Word)
+{
+  uint32_t zeros = 32;
+  while (Word != 0)
+  {
+    Word &= Word - 1;
+    zeros--;
+  }
+  return zeros;
+}
+
+/* true if sector Index of the counter has a valid header */
+static bool FLASHMAN_CounterHeader(FLASHMAN_CounterTypeDef *Counter, uint32_t Index, uint32_t *Base)
+{
+  uint32_t header[3];
+  Counter->Reads++;
+  if (FLASHMAN_ReadAddress(Counter->Handle, FLASHMAN_SectorToAddress(Counter->Sector + Index), (uint8_t *)header, sizeof(header)) == false)
+  {
+    return false;
+  }
+  *Base = header[1];
+  return (header[0] == FLASHMAN_COUNTER_MAGIC) && (header[1] == ~header[2]);
+}
+
+/* bits are cleared in order, so a page is full if its last word is, and the first word that is not
+   full holds the position */
+static bool FLASHMAN_CounterScan(FLASHMAN_CounterTypeDef *Counter)
+{
+  uint32_t address = FLASHMAN_SectorToAddress(Counter->Sector + Counter->Active);
+  uint32_t words[FLASHMAN_PAGE_SIZE / 4];
+  uint32_t lo = 0, hi = FLASHMAN_SECTOR_SIZE / FLASHMAN_PAGE_SIZE, mid, start, cnt, i;
+
+  while (lo < hi)
+  {
+    mid = (lo + hi) / 2;
+    Counter->Reads++;
+    if (FLASHMAN_ReadAddress(Counter->Handle, address + (mid + 1) * FLASHMAN_PAGE_SIZE - 4, (uint8_t *)words, 4) == false)
+    {
+      return false;
+    }
+    if (words[0] == 0)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  if (lo == FLASHMAN_SECTOR_SIZE / FLASHMAN_PAGE_SIZE)
+  {
+    Counter->Used = FLASHMAN_COUNTER_BITS;
+    return true;
+  }
+  start = (lo == 0) ? FLASHMAN_COUNTER_HEADER : lo * FLASHMAN_PAGE_SIZE;
+  cnt = ((lo + 1) * FLASHMAN_PAGE_SIZE - start) / 4;
+  Counter->Reads++;
+  if (FLASHMAN_ReadAddress(Counter->Handle, address + start, (uint8_t *)words, cnt * 4) == false)
+  {
+    return false;
+  }
+  for (i = 0; (i < cnt - 1) && (words[i] == 0); i++)
+  {
+  }
+  Counter->Used = (start - FLASHMAN_COUNTER_HEADER) * 8 + i * 32 + FLASHMAN_CounterZeros(words[i]);
+  return true;
+}
+
+/* continue in the other sector, the full one is erased after the next bit is programmed */
+static bool FLASHMAN_CounterSwitch(FLASHMAN_CounterTypeDef *Counter)
+{
+  uint32_t spare = Counter->Sector + (Counter->Active ^ 1);
+  uint32_t header[3] = {FLASHMAN_COUNTER_MAGIC, Counter->Value, ~Counter->Value};
+  if (Counter->SpareErased == false)
+  {
+    if (FLASHMAN_EraseSector(Counter->Handle, spare) == false)
+    {
+      return false;
+    }
+    Counter->Erases++;
+  }
+  Counter->SpareErased = false;
+  Counter->Programs++;
+  if (FLASHMAN_WriteAddress(Counter->Handle, FLASHMAN_SectorToAddress(spare), (uint8_t *)header, sizeof(header)) == false)
+  {
+    return false;
+  }
+  Counter->Active ^= 1;
+  Counter->Base = Counter->Value;
+  Counter->Used = 0;
+  return true;
+}
+
+/**
+  * @brief  Find the value of a counter, or start one at 0
+  * @note   Reads both sector headers and searches the active sector. If neither sector has a valid
+  *         header, both are erased and the counter starts at 0.
+  *
+  * @param  *Counter: Pointer to FLASHMAN_CounterTypeDef structure
+  * @param  *Handle: Pointer to an initialized FLASHMAN_HandleTypeDef structure
+  * @param  Sector: First of the two sectors of the counter
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_CounterOpen(FLASHMAN_CounterTypeDef *Counter, FLASHMAN_HandleTypeDef *Handle, uint32_t Sector)
+{
+  bool retVal = false, valid[2];
+  uint32_t base[2];
+  do
+  {
+    if ((Counter == NULL) || (Handle == NULL) || (Handle->Inited == 0) || (Sector + 1 >= Handle->SectorCnt))
+    {
+      break;
+    }
+    memset(Counter, 0, sizeof(FLASHMAN_CounterTypeDef));
+    Counter->Handle = Handle;
+    Counter->Sector = Sector;
+    valid[0] = FLASHMAN_CounterHeader(Counter, 0, &base[0]);
+    valid[1] = FLASHMAN_CounterHeader(Counter, 1, &base[1]);
+    if ((valid[0] == false) && (valid[1] == false))
+    {
+      /* new counter */
+      uint32_t header[3] = {FLASHMAN_COUNTER_MAGIC, 0, 0xFFFFFFFF};
+      Counter->Erases += 2;
+      Counter->Programs++;
+      if ((FLASHMAN_EraseSector(Handle, Sector) == false) || (FLASHMAN_EraseSector(Handle, Sector + 1) == false) ||
+          (FLASHMAN_WriteAddress(Handle, FLASHMAN_SectorToAddress(Sector), (uint8_t *)header, sizeof(header)) == false))
+      {
+        break;
+      }
+      Counter->SpareErased = true;
+      retVal = true;
+      break;
+    }
+    /* a reset between the header of the new sector and the erase of the old one leaves both */
+    Counter->Active = (valid[1] && ((valid[0] == false) || (base[1] > base[0]))) ? 1 : 0;
+    Counter->Base = base[Counter->Active];
+    if (FLASHMAN_CounterScan(Counter) == false)
+    {
+      break;
+    }
+    Counter->Value = Counter->Base + Counter->Used;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Add to a counter
+  * @note   Clears the next Amount bits, up to FLASHMAN_COUNTER_CHUNK bytes per program, and returns
+  *         once the last program is started. Crossing into the other sector programs its header, the
+  *         erase of the full one is started at the end and runs while the application does.
+  * @note   FLASHMAN_Sync() waits for the bits. With FLASHMAN_WRITEBACK_ENABLE they are in flash after
+  *         the next flush, like any write.
+  *
+  * @param  *Counter: Pointer to an open FLASHMAN_CounterTypeDef structure
+  * @param  Amount: Added to Value
+  *
+  * @retval bool: true or false, Value holds what reached the chip
+  */
+bool FLASHMAN_CounterAdd(FLASHMAN_CounterTypeDef *Counter, uint32_t Amount)
+{
+  bool retVal = false;
+  uint8_t data[FLASHMAN_COUNTER_CHUNK];
+  uint32_t take, first, last, end, cleared;
+  bool switched = false;
+  do
+  {
+    if ((Counter == NULL) || (Counter->Handle == NULL) || (Amount > 0xFFFFFFFF - Counter->Value))
+    {
+      break;
+    }
+    while (Amount > 0)
+    {
+      if (Counter->Used == FLASHMAN_COUNTER_BITS)
+      {
+        if (FLASHMAN_CounterSwitch(Counter) == false)
+        {
+          break;
+        }
+        switched = true;
+      }
+      take = FLASHMAN_COUNTER_CHUNK * 8 - Counter->Used % 8;
+      take = (take < FLASHMAN_COUNTER_BITS - Counter->Used) ? take : FLASHMAN_COUNTER_BITS - Counter->Used;
+      take = (take < Amount) ? take : Amount;
+      first = Counter->Used / 8;
+      end = Counter->Used + take;
+      last = (end - 1) / 8;
+      for (uint32_t i = first; i <= last; i++)
+      {
+        cleared = end - i * 8;
+        data[i - first] = (cleared >= 8) ? 0x00 : (uint8_t)(0xFF << cleared);
+      }
+      Counter->Programs++;
+      if (FLASHMAN_WriteAddressAsync(Counter->Handle, FLASHMAN_SectorToAddress(Counter->Sector + Counter->Active) + FLASHMAN_COUNTER_HEADER + first,
+                                     data, last - first + 1) == false)
+      {
+        break;
+      }
+      Counter->Used = end;
+      Counter->Value += take;
+      Amount -= take;
+    }
+    if ((Amount == 0) && switched)
+    {
+      if (FLASHMAN_EraseSectorAsync(Counter->Handle, Counter->Sector + (Counter->Active ^ 1)) == false)
+      {
+        break;
+      }
+      Counter->Erases++;
+      Counter->SpareErased = true;
+    }
+    retVal = (Amount == 0);
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Add one to a counter
+  * @note   See FLASHMAN_CounterAdd()
+  *
+  * @param  *Counter: Pointer to an open FLASHMAN_CounterTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_CounterIncrement(FLASHMAN_CounterTypeDef *Counter)
+{
+  return FLASHMAN_CounterAdd(Counter, 1);
+}
@@ -0,0 +1,51 @@
+#ifndef _FLASHMANAGER_COUNTER_H_
+#define _FLASHMANAGER_COUNTER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+
+#include "SPI_Flash_Manager.h"
+
+#define FLASHMAN_COUNTER_MAGIC                  0x434E5452
+/* sector header: magic, base value, inverted base value, reserved */
+#define FLASHMAN_COUNTER_HEADER                 16
+/* increments a sector holds, one bit each */
+#define FLASHMAN_COUNTER_BITS                   ((FLASHMAN_SECTOR_SIZE - FLASHMAN_COUNTER_HEADER) * 8)
+
+/*
+ * Monotonic counter in two sectors, for boot counts and sequence numbers. Each increment programs
+ * the next bit of the active sector from 1 to 0, so it costs a one byte program and no erase. The
+ * value is the base in the sector header plus the cleared bits. A full sector goes over to the
+ * other one with a new header and the old one is erased in the background, once every
+ * FLASHMAN_COUNTER_BITS increments.
+ * FLASHMAN_CounterOpen() finds the position with a binary search over the pages and a word scan of
+ * one page, after that Value is kept in RAM and nothing is read back. A reset during an update
+ * leaves a value between the old and the new one. The counter is not locked, use it from one task.
+ */
+typedef struct
+{
+  FLASHMAN_HandleTypeDef *Handle;
+  uint32_t               Sector;           /* first of the two sectors */
+  uint32_t               Value;            /* current value, read only */
+  uint32_t               Active;           /* 0 or 1, sector in use */
+  uint32_t               Base;             /* value at the start of the active sector */
+  uint32_t               Used;             /* bits cleared in the active sector */
+  bool                   SpareErased;      /* the other sector is known erased */
+  /* counters */
+  uint32_t               Programs;
+  uint32_t               Erases;
+  uint32_t               Reads;            /* read frames of the last open */
+
+} FLASHMAN_CounterTypeDef;
+
+bool FLASHMAN_CounterOpen(FLASHMAN_CounterTypeDef *Counter, FLASHMAN_HandleTypeDef *Handle, uint32_t Sector);
+bool FLASHMAN_CounterAdd(FLASHMAN_CounterTypeDef *Counter, uint32_t Amount);
+bool FLASHMAN_CounterIncrement(FLASHMAN_CounterTypeDef *Counter);
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHMANAGER_COUNTER_H_
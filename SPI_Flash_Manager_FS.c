@@ -0,0 +1,279 @@
+#include "SPI_Flash_Manager_FS.h"
+
+#if FLASHMAN_FS == FLASHMAN_FS_LITTLEFS
+
+static int FLASHMAN_LfsRead(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size);
+static int FLASHMAN_LfsProg(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size);
+static int FLASHMAN_LfsErase(const struct lfs_config *c, lfs_block_t block);
+static int FLASHMAN_LfsSync(const struct lfs_config *c);
+
+static int FLASHMAN_LfsRead(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size)
+{
+  FLASHMAN_LfsTypeDef *lfs = (FLASHMAN_LfsTypeDef *)c->context;
+  uint32_t address = FLASHMAN_SectorToAddress(lfs->FirstSector + block) + off;
+  if (FLASHMAN_ReadAddress(lfs->Handle, address, (uint8_t *)buffer, size) == false)
+  {
+    return LFS_ERR_IO;
+  }
+  return LFS_ERR_OK;
+}
+
+static int FLASHMAN_LfsProg(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size)
+{
+  FLASHMAN_LfsTypeDef *lfs = (FLASHMAN_LfsTypeDef *)c->context;
+  uint32_t address = FLASHMAN_SectorToAddress(lfs->FirstSector + block) + off;
+  /* the last page is left programming, the next call or sync waits for it */
+  if (FLASHMAN_WriteAddressAsync(lfs->Handle, address, (uint8_t *)buffer, size) == false)
+  {
+    return LFS_ERR_IO;
+  }
+  return LFS_ERR_OK;
+}
+
+static int FLASHMAN_LfsErase(const struct lfs_config *c, lfs_block_t block)
+{
+  FLASHMAN_LfsTypeDef *lfs = (FLASHMAN_LfsTypeDef *)c->context;
+  if (FLASHMAN_EraseSectorAsync(lfs->Handle, lfs->FirstSector + block) == false)
+  {
+    return LFS_ERR_IO;
+  }
+  return LFS_ERR_OK;
+}
+
+static int FLASHMAN_LfsSync(const struct lfs_config *c)
+{
+  FLASHMAN_LfsTypeDef *lfs = (FLASHMAN_LfsTypeDef *)c->context;
+  if (FLASHMAN_Sync(lfs->Handle) == false)
+  {
+    return LFS_ERR_IO;
+  }
+  return LFS_ERR_OK;
+}
+
+/**
+  * @brief  Fill a littlefs configuration for a range of sectors.
+  * @note   littlefs blocks are mapped to flash sectors, read/prog caches are one page.
+  * @note   Use Lfs->Config with lfs_format() and lfs_mount(), Lfs must stay valid while mounted
+  *
+  * @param  *Lfs: Pointer to FLASHMAN_LfsTypeDef structure
+  * @param  *Handle: Pointer to an initialized FLASHMAN_HandleTypeDef structure
+  * @param  FirstSector: First sector of the file system
+  * @param  SectorCnt: Number of sectors, 0 for the rest of the chip
+  * @param  BlockCycles: littlefs wear leveling cycles, -1 to disable
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_LfsConfig(FLASHMAN_LfsTypeDef *Lfs, FLASHMAN_HandleTypeDef *Handle, uint32_t FirstSector, uint32_t SectorCnt, int32_t BlockCycles)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Lfs == NULL) || (Handle == NULL) || (Handle->Inited == 0) || (FirstSector >= Handle->SectorCnt))
+    {
+      break;
+    }
+    if (SectorCnt == 0)
+    {
+      SectorCnt = Handle->SectorCnt - FirstSector;
+    }
+    if (FirstSector + SectorCnt > Handle->SectorCnt)
+    {
+      break;
+    }
+    memset(Lfs, 0, sizeof(FLASHMAN_LfsTypeDef));
+    Lfs->Handle = Handle;
+    Lfs->FirstSector = FirstSector;
+    Lfs->Config.context = Lfs;
+    Lfs->Config.read = FLASHMAN_LfsRead;
+    Lfs->Config.prog = FLASHMAN_LfsProg;
+    Lfs->Config.erase = FLASHMAN_LfsErase;
+    Lfs->Config.sync = FLASHMAN_LfsSync;
+    Lfs->Config.read_size = 16;
+    Lfs->Config.prog_size = 16;
+    Lfs->Config.block_size = FLASHMAN_SECTOR_SIZE;
+    Lfs->Config.block_count = SectorCnt;
+    Lfs->Config.block_cycles = BlockCycles;
+    Lfs->Config.cache_size = FLASHMAN_PAGE_SIZE;
+    Lfs->Config.lookahead_size = FLASHMAN_FS_LOOKAHEAD_SIZE;
+    Lfs->Config.read_buffer = Lfs->ReadBuffer;
+    Lfs->Config.prog_buffer = Lfs->ProgBuffer;
+    Lfs->Config.lookahead_buffer = Lfs->LookaheadBuffer;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+#elif FLASHMAN_FS == FLASHMAN_FS_FATFS
+
+/* one FatFS sector is one flash sector, so FF_MIN_SS and FF_MAX_SS must both be 4096 */
+#if defined(FF_MAX_SS) && (FF_MAX_SS != FLASHMAN_SECTOR_SIZE)
+#error "FLASHMAN FatFS adapter needs FF_MAX_SS == FLASHMAN_SECTOR_SIZE"
+#endif
+
+typedef struct
+{
+  FLASHMAN_HandleTypeDef *Handle;
+  uint32_t               FirstSector;
+  uint32_t               SectorCnt;
+  DSTATUS                Status;
+
+} FLASHMAN_DiskTypeDef;
+
+static FLASHMAN_DiskTypeDef FLASHMAN_Disk[FLASHMAN_FS_DRIVES];
+
+/**
+  * @brief  Attach a range of sectors to a FatFS drive number.
+  * @note   Call the FLASHMAN_Disk*() functions from the matching entries of diskio.c
+  *
+  * @param  Drive: Physical drive number
+  * @param  *Handle: Pointer to an initialized FLASHMAN_HandleTypeDef structure
+  * @param  FirstSector: First sector of the volume
+  * @param  SectorCnt: Number of sectors, 0 for the rest of the chip
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_DiskAttach(BYTE Drive, FLASHMAN_HandleTypeDef *Handle, uint32_t FirstSector, uint32_t SectorCnt)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Drive >= FLASHMAN_FS_DRIVES) || (Handle == NULL) || (Handle->Inited == 0) || (FirstSector >= Handle->SectorCnt))
+    {
+      break;
+    }
+    if (SectorCnt == 0)
+    {
+      SectorCnt = Handle->SectorCnt - FirstSector;
+    }
+    if (FirstSector + SectorCnt > Handle->SectorCnt)
+    {
+      break;
+    }
+    FLASHMAN_Disk[Drive].Handle = Handle;
+    FLASHMAN_Disk[Drive].FirstSector = FirstSector;
+    FLASHMAN_Disk[Drive].SectorCnt = SectorCnt;
+    FLASHMAN_Disk[Drive].Status = STA_NOINIT;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+DSTATUS FLASHMAN_DiskInitialize(BYTE Drive)
+{
+  if ((Drive >= FLASHMAN_FS_DRIVES) || (FLASHMAN_Disk[Drive].Handle == NULL))
+  {
+    return STA_NOINIT;
+  }
+  FLASHMAN_Disk[Drive].Status = 0;
+  return FLASHMAN_Disk[Drive].Status;
+}
+
+DSTATUS FLASHMAN_DiskStatus(BYTE Drive)
+{
+  if (Drive >= FLASHMAN_FS_DRIVES)
+  {
+    return STA_NOINIT;
+  }
+  return FLASHMAN_Disk[Drive].Status;
+}
+
+DRESULT FLASHMAN_DiskRead(BYTE Drive, BYTE *Buff, DWORD Sector, UINT Count)
+{
+  FLASHMAN_DiskTypeDef *disk;
+  if ((Drive >= FLASHMAN_FS_DRIVES) || (FLASHMAN_Disk[Drive].Status & STA_NOINIT))
+  {
+    return RES_NOTRDY;
+  }
+  disk = &FLASHMAN_Disk[Drive];
+  if ((Count == 0) || (Sector + Count > disk->SectorCnt))
+  {
+    return RES_PARERR;
+  }
+  if (FLASHMAN_ReadAddress(disk->Handle, FLASHMAN_SectorToAddress(disk->FirstSector + Sector), Buff, Count * FLASHMAN_SECTOR_SIZE) == false)
+  {
+    return RES_ERROR;
+  }
+  return RES_OK;
+}
+
+DRESULT FLASHMAN_DiskWrite(BYTE Drive, const BYTE *Buff, DWORD Sector, UINT Count)
+{
+  FLASHMAN_DiskTypeDef *disk;
+  if ((Drive >= FLASHMAN_FS_DRIVES) || (FLASHMAN_Disk[Drive].Status & STA_NOINIT))
+  {
+    return RES_NOTRDY;
+  }
+  disk = &FLASHMAN_Disk[Drive];
+  if ((Count == 0) || (Sector + Count > disk->SectorCnt))
+  {
+    return RES_PARERR;
+  }
+  for (UINT i = 0; i < Count; i++)
+  {
+    uint32_t sector = disk->FirstSector + Sector + i;
+    /* the program waits for the erase, the last page is left to CTRL_SYNC */
+    if (FLASHMAN_EraseSectorAsync(disk->Handle, sector) == false)
+    {
+      return RES_ERROR;
+    }
+    if (FLASHMAN_WriteAddressAsync(disk->Handle, FLASHMAN_SectorToAddress(sector), (uint8_t *)&Buff[i * FLASHMAN_SECTOR_SIZE], FLASHMAN_SECTOR_SIZE) == false)
+    {
+      return RES_ERROR;
+    }
+  }
+  return RES_OK;
+}
+
+DRESULT FLASHMAN_DiskIoctl(BYTE Drive, BYTE Cmd, void *Buff)
+{
+  FLASHMAN_DiskTypeDef *disk;
+  DRESULT retVal = RES_PARERR;
+  if ((Drive >= FLASHMAN_FS_DRIVES) || (FLASHMAN_Disk[Drive].Status & STA_NOINIT))
+  {
+    return RES_NOTRDY;
+  }
+  disk = &FLASHMAN_Disk[Drive];
+  switch (Cmd)
+  {
+  case CTRL_SYNC:
+    retVal = (FLASHMAN_Sync(disk->Handle)) ? RES_OK : RES_ERROR;
+    break;
+  case GET_SECTOR_COUNT:
+    *(DWORD *)Buff = disk->SectorCnt;
+    retVal = RES_OK;
+    break;
+  case GET_SECTOR_SIZE:
+    *(WORD *)Buff = FLASHMAN_SECTOR_SIZE;
+    retVal = RES_OK;
+    break;
+  case GET_BLOCK_SIZE:
+    *(DWORD *)Buff = 1;
+    retVal = RES_OK;
+    break;
+#ifdef CTRL_TRIM
+  case CTRL_TRIM:
+  {
+    DWORD *range = (DWORD *)Buff;
+    retVal = RES_OK;
+    for (DWORD s = range[0]; (s <= range[1]) && (s < disk->SectorCnt); s++)
+    {
+      if (FLASHMAN_EraseSectorAsync(disk->Handle, disk->FirstSector + s) == false)
+      {
+        retVal = RES_ERROR;
+        break;
+      }
+    }
+    break;
+  }
+#endif
+  default:
+    break;
+  }
+  return retVal;
+}
+
+#endif
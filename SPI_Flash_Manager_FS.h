@@ -0,0 +1,51 @@
+#ifndef _FLASHMANAGER_FS_H_
+#define _FLASHMANAGER_FS_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+
+#include "SPI_Flash_Manager.h"
+
+#if FLASHMAN_FS == FLASHMAN_FS_LITTLEFS
+#include "lfs.h"
+#elif FLASHMAN_FS == FLASHMAN_FS_FATFS
+#include "ff.h"
+#include "diskio.h"
+#endif
+
+#define FLASHMAN_FS_LOOKAHEAD_SIZE              16
+#define FLASHMAN_FS_DRIVES                      1
+
+#if FLASHMAN_FS == FLASHMAN_FS_LITTLEFS
+
+typedef struct
+{
+  struct lfs_config      Config;
+  FLASHMAN_HandleTypeDef *Handle;
+  uint32_t               FirstSector;
+  uint8_t                ReadBuffer[FLASHMAN_PAGE_SIZE];
+  uint8_t                ProgBuffer[FLASHMAN_PAGE_SIZE];
+  uint32_t               LookaheadBuffer[FLASHMAN_FS_LOOKAHEAD_SIZE / 4];
+
+} FLASHMAN_LfsTypeDef;
+
+bool FLASHMAN_LfsConfig(FLASHMAN_LfsTypeDef *Lfs, FLASHMAN_HandleTypeDef *Handle, uint32_t FirstSector, uint32_t SectorCnt, int32_t BlockCycles);
+
+#elif FLASHMAN_FS == FLASHMAN_FS_FATFS
+
+bool    FLASHMAN_DiskAttach(BYTE Drive, FLASHMAN_HandleTypeDef *Handle, uint32_t FirstSector, uint32_t SectorCnt);
+DSTATUS FLASHMAN_DiskInitialize(BYTE Drive);
+DSTATUS FLASHMAN_DiskStatus(BYTE Drive);
+DRESULT FLASHMAN_DiskRead(BYTE Drive, BYTE *Buff, DWORD Sector, UINT Count);
+DRESULT FLASHMAN_DiskWrite(BYTE Drive, const BYTE *Buff, DWORD Sector, UINT Count);
+DRESULT FLASHMAN_DiskIoctl(BYTE Drive, BYTE Cmd, void *Buff);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHMANAGER_FS_H_
@@ -0,0 +1,552 @@
+#include "SPI_Flash_Manager_Lz.h"
+
+static uint32_t FLASHMAN_LzPutLen(uint8_t *Dst, uint32_t Out, uint32_t Cap, uint32_t Len);
+static uint32_t FLASHMAN_LzPutSeq(uint8_t *Dst, uint32_t Out, uint32_t Cap, const uint8_t *Lit, uint32_t LitLen, uint32_t Offset, uint32_t MatchLen);
+static uint32_t FLASHMAN_LzEncode(uint16_t *Hash, const uint8_t *Src, uint32_t Len, uint8_t *Dst, uint32_t Cap);
+static bool     FLASHMAN_LzDecode(FLASHMAN_LzTypeDef *Region, uint32_t Raw);
+static bool     FLASHMAN_LzGet(FLASHMAN_LzTypeDef *Region, uint8_t *Dst, uint32_t Len);
+static bool     FLASHMAN_LzGetLen(FLASHMAN_LzTypeDef *Region, uint32_t *Len);
+static bool     FLASHMAN_LzStore(FLASHMAN_LzTypeDef *Region);
+static bool     FLASHMAN_LzLoad(FLASHMAN_LzTypeDef *Region, uint32_t Chunk);
+static bool     FLASHMAN_LzMount(FLASHMAN_LzTypeDef *Region);
+
+static uint32_t FLASHMAN_LzPutLen(uint8_t *Dst, uint32_t Out, uint32_t Cap, uint32_t Len)
+{
+  while ((Len >= 255) && (Out < Cap))
+  {
+    Dst[Out++] = 255;
+    Len -= 255;
+  }
+  if (Out < Cap)
+  {
+    Dst[Out++] = (uint8_t)Len;
+  }
+  return Out;
+}
+
+/* one sequence: token, literals, offset and match length. Returns the new output size, Cap + 1 on overflow */
+static uint32_t FLASHMAN_LzPutSeq(uint8_t *Dst, uint32_t Out, uint32_t Cap, const uint8_t *Lit, uint32_t LitLen, uint32_t Offset, uint32_t MatchLen)
+{
+  uint32_t m = (Offset != 0) ? MatchLen - 4 : 0;
+  if (Out >= Cap)
+  {
+    return Cap + 1;
+  }
+  Dst[Out++] = (uint8_t)(((LitLen < 15) ? LitLen : 15) << 4) | (uint8_t)((m < 15) ? m : 15);
+  if (LitLen >= 15)
+  {
+    Out = FLASHMAN_LzPutLen(Dst, Out, Cap, LitLen - 15);
+  }
+  if (Out + LitLen > Cap)
+  {
+    return Cap + 1;
+  }
+  memcpy(&Dst[Out], Lit, LitLen);
+  Out += LitLen;
+  if (Offset != 0)
+  {
+    if (Out + 2 > Cap)
+    {
+      return Cap + 1;
+    }
+    Dst[Out++] = (uint8_t)Offset;
+    Dst[Out++] = (uint8_t)(Offset >> 8);
+    if (m >= 15)
+    {
+      Out = FLASHMAN_LzPutLen(Dst, Out, Cap, m - 15);
+    }
+  }
+  return (Out > Cap) ? Cap + 1 : Out;
+}
+
+/* greedy LZ77 with a single entry hash table, returns 0 if the result does not fit into Cap */
+static uint32_t FLASHMAN_LzEncode(uint16_t *Hash, const uint8_t *Src, uint32_t Len, uint8_t *Dst, uint32_t Cap)
+{
+  uint32_t i = 0, anchor = 0, out = 0, v, h, cand, len;
+  memset(Hash, 0xFF, FLASHMAN_LZ_HASH * sizeof(uint16_t));
+  while (i + 4 <= Len)
+  {
+    memcpy(&v, &Src[i], 4);
+    h = (uint32_t)(v * 2654435761U) >> (32 - FLASHMAN_LZ_HASH_BITS);
+    cand = Hash[h];
+    Hash[h] = (uint16_t)i;
+    if ((cand == 0xFFFF) || (memcmp(&Src[cand], &Src[i], 4) != 0))
+    {
+      i++;
+      continue;
+    }
+    len = 4;
+    while ((i + len < Len) && (Src[cand + len] == Src[i + len]))
+    {
+      len++;
+    }
+    out = FLASHMAN_LzPutSeq(Dst, out, Cap, &Src[anchor], i - anchor, i - cand, len);
+    if (out > Cap)
+    {
+      return 0;
+    }
+    i += len;
+    anchor = i;
+  }
+  out = FLASHMAN_LzPutSeq(Dst, out, Cap, &Src[anchor], Len - anchor, 0, 0);
+  return (out > Cap) ? 0 : out;
+}
+
+/* next Len bytes of the compressed stream, read from flash FLASHMAN_LZ_INPUT bytes at a time */
+static bool FLASHMAN_LzGet(FLASHMAN_LzTypeDef *Region, uint8_t *Dst, uint32_t Len)
+{
+  uint32_t n;
+  while (Len > 0)
+  {
+    if (Region->InPos == Region->InLen)
+    {
+      n = (Region->InLeft < FLASHMAN_LZ_INPUT) ? Region->InLeft : FLASHMAN_LZ_INPUT;
+      if ((n == 0) || (FLASHMAN_ReadAddress(Region->Handle, Region->InAddr, Region->In, n) == false))
+      {
+        return false;
+      }
+      Region->InAddr += n;
+      Region->InLeft -= n;
+      Region->InPos = 0;
+      Region->InLen = n;
+    }
+    n = Region->InLen - Region->InPos;
+    if (n > Len)
+    {
+      n = Len;
+    }
+    memcpy(Dst, &Region->In[Region->InPos], n);
+    Region->InPos += n;
+    Dst += n;
+    Len -= n;
+  }
+  return true;
+}
+
+static bool FLASHMAN_LzGetLen(FLASHMAN_LzTypeDef *Region, uint32_t *Len)
+{
+  uint8_t b;
+  do
+  {
+    if (FLASHMAN_LzGet(Region, &b, 1) == false)
+    {
+      return false;
+    }
+    *Len += b;
+  } while (b == 255);
+  return true;
+}
+
+static bool FLASHMAN_LzDecode(FLASHMAN_LzTypeDef *Region, uint32_t Raw)
+{
+  uint8_t token, offset[2];
+  uint32_t out = 0, lit, match, distance;
+  while (out < Raw)
+  {
+    if (FLASHMAN_LzGet(Region, &token, 1) == false)
+    {
+      return false;
+    }
+    lit = token >> 4;
+    if ((lit == 15) && (FLASHMAN_LzGetLen(Region, &lit) == false))
+    {
+      return false;
+    }
+    if ((lit > Raw - out) || (FLASHMAN_LzGet(Region, &Region->Cache[out], lit) == false))
+    {
+      return false;
+    }
+    out += lit;
+    if (out == Raw)
+    {
+      break;
+    }
+    if (FLASHMAN_LzGet(Region, offset, 2) == false)
+    {
+      return false;
+    }
+    distance = offset[0] | ((uint32_t)offset[1] << 8);
+    match = (token & 15) + 4;
+    if (((token & 15) == 15) && (FLASHMAN_LzGetLen(Region, &match) == false))
+    {
+      return false;
+    }
+    if ((distance == 0) || (distance > out) || (match > Raw - out))
+    {
+      return false;
+    }
+    /* byte by byte, the match may overlap its own output */
+    for (; match > 0; match--, out++)
+    {
+      Region->Cache[out] = Region->Cache[out - distance];
+    }
+  }
+  return true;
+}
+
+/* compress Raw into Cache and program it with its index entry, erasing data sectors on the way */
+static bool FLASHMAN_LzStore(FLASHMAN_LzTypeDef *Region)
+{
+  FLASHMAN_LzEntryTypeDef entry;
+  uint8_t *src = Region->Cache;
+  uint32_t size;
+  if ((Region->ChunkCnt >= Region->ChunkMax) || (Region->Fill == 0))
+  {
+    return false;
+  }
+  Region->Cached = FLASHMAN_LZ_NONE;
+  size = FLASHMAN_LzEncode(Region->Hash, Region->Raw, Region->Fill, Region->Cache, Region->Fill - 1);
+  if (size == 0)
+  {
+    src = Region->Raw;
+    size = Region->Fill;
+  }
+  if (size > Region->End - Region->Pos)
+  {
+    return false;
+  }
+  while (Region->Erased < Region->Pos + size)
+  {
+    if (FLASHMAN_EraseSector(Region->Handle, FLASHMAN_AddressToSector(Region->Erased)) == false)
+    {
+      return false;
+    }
+    Region->Erased += FLASHMAN_SECTOR_SIZE;
+  }
+  entry.Offset = Region->Pos - Region->Data;
+  entry.Size = (uint16_t)size;
+  entry.Raw = (uint16_t)Region->Fill;
+  /* data first, the index entry commits the chunk */
+  if ((FLASHMAN_WriteAddress(Region->Handle, Region->Pos, src, size) == false) ||
+      (FLASHMAN_WriteAddress(Region->Handle, Region->Base + Region->ChunkCnt * sizeof(entry), (uint8_t *)&entry, sizeof(entry)) == false))
+  {
+    return false;
+  }
+  Region->ChunkCnt++;
+  Region->Pos += size;
+  Region->Stored += size;
+  Region->Sealed = (Region->Fill < FLASHMAN_LZ_CHUNK) ? 1 : 0;
+  Region->Fill = 0;
+  return true;
+}
+
+static bool FLASHMAN_LzLoad(FLASHMAN_LzTypeDef *Region, uint32_t Chunk)
+{
+  FLASHMAN_LzEntryTypeDef entry;
+  bool retVal = false;
+  do
+  {
+    if (Region->Cached == Chunk)
+    {
+      retVal = true;
+      break;
+    }
+    Region->Cached = FLASHMAN_LZ_NONE;
+    if ((FLASHMAN_ReadAddress(Region->Handle, Region->Base + Chunk * sizeof(entry), (uint8_t *)&entry, sizeof(entry)) == false) ||
+        (entry.Raw > FLASHMAN_LZ_CHUNK) || (entry.Size > entry.Raw))
+    {
+      break;
+    }
+    if (entry.Size == entry.Raw)
+    {
+      if (FLASHMAN_ReadAddress(Region->Handle, Region->Data + entry.Offset, Region->Cache, entry.Raw) == false)
+      {
+        break;
+      }
+    }
+    else
+    {
+      Region->InAddr = Region->Data + entry.Offset;
+      Region->InLeft = entry.Size;
+      Region->InPos = 0;
+      Region->InLen = 0;
+      if (FLASHMAN_LzDecode(Region, entry.Raw) == false)
+      {
+        break;
+      }
+    }
+    Region->Cached = Chunk;
+    Region->CachedRaw = entry.Raw;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/* rebuild the state from the index, then check the rest of the current sector is still blank */
+static bool FLASHMAN_LzMount(FLASHMAN_LzTypeDef *Region)
+{
+  FLASHMAN_LzEntryTypeDef *entry = (FLASHMAN_LzEntryTypeDef *)Region->Cache;
+  uint32_t batch = FLASHMAN_LZ_CHUNK / sizeof(FLASHMAN_LzEntryTypeDef), n, end = 0;
+  bool done = false;
+  Region->ChunkCnt = 0;
+  Region->Size = 0;
+  Region->Sealed = 0;
+  while ((done == false) && (Region->ChunkCnt < Region->ChunkMax))
+  {
+    n = Region->ChunkMax - Region->ChunkCnt;
+    if (n > batch)
+    {
+      n = batch;
+    }
+    if (FLASHMAN_ReadAddress(Region->Handle, Region->Base + Region->ChunkCnt * sizeof(*entry), (uint8_t *)entry, n * sizeof(*entry)) == false)
+    {
+      return false;
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+      /* an entry cut by power loss does not chain, the index ends before it */
+      if ((Region->Sealed != 0) || (entry[i].Offset == FLASHMAN_LZ_NONE) || (entry[i].Offset < end) ||
+          (entry[i].Raw > FLASHMAN_LZ_CHUNK) || (entry[i].Size > entry[i].Raw) || (entry[i].Size == 0) ||
+          (entry[i].Offset + entry[i].Size > Region->End - Region->Data))
+      {
+        done = true;
+        break;
+      }
+      end = entry[i].Offset + entry[i].Size;
+      Region->Stored += entry[i].Size;
+      Region->Size += entry[i].Raw;
+      Region->Sealed = (entry[i].Raw < FLASHMAN_LZ_CHUNK) ? 1 : 0;
+      Region->ChunkCnt++;
+    }
+  }
+  Region->Pos = Region->Data + end;
+  Region->Erased = FLASHMAN_SectorToAddress(FLASHMAN_AddressToSector(Region->Pos + FLASHMAN_SECTOR_SIZE - 1));
+  /* an append cut by power loss may have programmed data behind the last chunk */
+  for (uint32_t address = Region->Pos; address < Region->Erased; address += n)
+  {
+    n = Region->Erased - address;
+    if (n > FLASHMAN_LZ_CHUNK)
+    {
+      n = FLASHMAN_LZ_CHUNK;
+    }
+    if (FLASHMAN_ReadAddress(Region->Handle, address, Region->Cache, n) == false)
+    {
+      return false;
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+      if (Region->Cache[i] != 0xFF)
+      {
+        Region->Pos = Region->Erased;
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+  * @brief  Mount a compressed region, an unformatted one reads as empty after FLASHMAN_LzFormat()
+  * @note   The first sectors hold the chunk index, sized for FLASHMAN_LZ_RATIO, the rest holds data.
+  *
+  * @param  *Region: Pointer to FLASHMAN_LzTypeDef structure
+  * @param  *Handle: Pointer to an initialized FLASHMAN_HandleTypeDef structure
+  * @param  FirstSector: First sector of the region
+  * @param  SectorCnt: Number of sectors
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_LzInit(FLASHMAN_LzTypeDef *Region, FLASHMAN_HandleTypeDef *Handle, uint32_t FirstSector, uint32_t SectorCnt)
+{
+  bool retVal = false;
+  uint32_t chunks, indexSectors;
+  do
+  {
+    if ((Region == NULL) || (Handle == NULL) || (Handle->Inited == 0) || (SectorCnt < 2) ||
+        (FirstSector >= Handle->SectorCnt) || (SectorCnt > Handle->SectorCnt - FirstSector))
+    {
+      break;
+    }
+    chunks = (uint32_t)(((uint64_t)FLASHMAN_SectorToAddress(SectorCnt) * FLASHMAN_LZ_RATIO) / FLASHMAN_LZ_CHUNK);
+    indexSectors = (chunks * sizeof(FLASHMAN_LzEntryTypeDef) + FLASHMAN_SECTOR_SIZE - 1) / FLASHMAN_SECTOR_SIZE;
+    if (indexSectors >= SectorCnt)
+    {
+      indexSectors = 1;
+    }
+    memset(Region, 0, sizeof(FLASHMAN_LzTypeDef));
+    Region->Handle = Handle;
+    Region->Base = FLASHMAN_SectorToAddress(FirstSector);
+    Region->Data = FLASHMAN_SectorToAddress(FirstSector + indexSectors);
+    Region->End = FLASHMAN_SectorToAddress(FirstSector + SectorCnt);
+    Region->ChunkMax = (FLASHMAN_SectorToAddress(indexSectors) / sizeof(FLASHMAN_LzEntryTypeDef));
+    Region->Cached = FLASHMAN_LZ_NONE;
+    retVal = FLASHMAN_LzMount(Region);
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Empty the region
+  * @note   Only the index is erased here, data sectors are erased as appends reach them.
+  *
+  * @param  *Region: Pointer to FLASHMAN_LzTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_LzFormat(FLASHMAN_LzTypeDef *Region)
+{
+  bool retVal = false;
+  uint32_t address;
+  do
+  {
+    if ((Region == NULL) || (Region->Handle == NULL))
+    {
+      break;
+    }
+    address = Region->Base;
+    while ((address < Region->Data) && FLASHMAN_EraseSector(Region->Handle, FLASHMAN_AddressToSector(address)))
+    {
+      address += FLASHMAN_SECTOR_SIZE;
+    }
+    if (address < Region->Data)
+    {
+      break;
+    }
+    Region->ChunkCnt = 0;
+    Region->Pos = Region->Data;
+    Region->Erased = Region->Data;
+    Region->Size = 0;
+    Region->Stored = 0;
+    Region->Fill = 0;
+    Region->Cached = FLASHMAN_LZ_NONE;
+    Region->Sealed = 0;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Append data to the region
+  * @note   Data is kept in RAM until a chunk is full, FLASHMAN_LzClose() stores the rest.
+  *
+  * @param  *Region: Pointer to FLASHMAN_LzTypeDef structure
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be written. (in byte)
+  *
+  * @retval bool: true or false, false also when the region or its index is full
+  */
+bool FLASHMAN_LzAppend(FLASHMAN_LzTypeDef *Region, const uint8_t *Data, uint32_t Size)
+{
+  bool retVal = false;
+  uint32_t n;
+  do
+  {
+    if ((Region == NULL) || (Region->Handle == NULL) || (Region->Sealed != 0))
+    {
+      break;
+    }
+    while (Size > 0)
+    {
+      n = FLASHMAN_LZ_CHUNK - Region->Fill;
+      if (n > Size)
+      {
+        n = Size;
+      }
+      memcpy(&Region->Raw[Region->Fill], Data, n);
+      Region->Fill += n;
+      Region->Size += n;
+      Data += n;
+      Size -= n;
+      if ((Region->Fill == FLASHMAN_LZ_CHUNK) && (FLASHMAN_LzStore(Region) == false))
+      {
+        break;
+      }
+    }
+    retVal = (Size == 0);
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Store the partly filled chunk
+  * @note   The region is read only afterwards, until FLASHMAN_LzFormat()
+  *
+  * @param  *Region: Pointer to FLASHMAN_LzTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_LzClose(FLASHMAN_LzTypeDef *Region)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Region == NULL) || (Region->Handle == NULL))
+    {
+      break;
+    }
+    if ((Region->Fill > 0) && (FLASHMAN_LzStore(Region) == false))
+    {
+      break;
+    }
+    Region->Sealed = 1;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Read uncompressed data from the region
+  * @note   Only the chunks covering the range are read and decompressed, the last one stays cached.
+  *
+  * @param  *Region: Pointer to FLASHMAN_LzTypeDef structure
+  * @param  Offset: Uncompressed offset
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be read. (in byte)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_LzRead(FLASHMAN_LzTypeDef *Region, uint32_t Offset, uint8_t *Data, uint32_t Size)
+{
+  bool retVal = false;
+  uint32_t chunk, offset, n;
+  const uint8_t *src;
+  do
+  {
+    if ((Region == NULL) || (Region->Handle == NULL) || (Offset > Region->Size) || (Size > Region->Size - Offset))
+    {
+      break;
+    }
+    while (Size > 0)
+    {
+      chunk = Offset / FLASHMAN_LZ_CHUNK;
+      offset = Offset % FLASHMAN_LZ_CHUNK;
+      if (chunk == Region->ChunkCnt)
+      {
+        /* not stored yet */
+        src = Region->Raw;
+        n = Region->Fill - offset;
+      }
+      else
+      {
+        if (FLASHMAN_LzLoad(Region, chunk) == false)
+        {
+          break;
+        }
+        src = Region->Cache;
+        n = Region->CachedRaw - offset;
+      }
+      if (n > Size)
+      {
+        n = Size;
+      }
+      memcpy(Data, &src[offset], n);
+      Offset += n;
+      Data += n;
+      Size -= n;
+    }
+    retVal = (Size == 0);
+
+  } while (0);
+
+  return retVal;
+}
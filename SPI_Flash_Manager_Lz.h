@@ -0,0 +1,73 @@
+#ifndef _FLASHMANAGER_LZ_H_
+#define _FLASHMANAGER_LZ_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+
+#include "SPI_Flash_Manager.h"
+
+/* uncompressed chunk size, the unit of random access. RAM use is about 2 chunks + 2 * FLASHMAN_LZ_HASH */
+#ifndef FLASHMAN_LZ_CHUNK
+#define FLASHMAN_LZ_CHUNK                       2048
+#endif
+#define FLASHMAN_LZ_HASH_BITS                   10
+#define FLASHMAN_LZ_HASH                        (1 << FLASHMAN_LZ_HASH_BITS)
+#define FLASHMAN_LZ_INPUT                       64
+/* the chunk index is sized for this compression ratio, a region fills up earlier on better ratios */
+#define FLASHMAN_LZ_RATIO                       4
+#define FLASHMAN_LZ_NONE                        0xFFFFFFFF
+
+/* index entry, one per chunk in the first sectors of the region. Offset 0xFFFFFFFF ends the index */
+typedef struct
+{
+  uint32_t               Offset;           /* from the first data byte */
+  uint16_t               Size;             /* stored bytes, equal to Raw for a chunk stored uncompressed */
+  uint16_t               Raw;              /* uncompressed bytes, less than FLASHMAN_LZ_CHUNK only for the last chunk */
+
+} FLASHMAN_LzEntryTypeDef;
+
+/*
+ * Append-only compressed region: data is cut into FLASHMAN_LZ_CHUNK chunks, each compressed on its
+ * own (LZ77, LZ4 style sequences) and packed back to back behind the index. Data sectors are erased
+ * when the write position reaches them, so program and erase time scale with the compressed size.
+ */
+typedef struct
+{
+  FLASHMAN_HandleTypeDef *Handle;
+  uint32_t               Base;             /* index address */
+  uint32_t               Data;             /* first data address */
+  uint32_t               End;
+  uint32_t               ChunkMax;
+  uint32_t               ChunkCnt;
+  uint32_t               Pos;              /* next free data address */
+  uint32_t               Erased;           /* data is erased from Pos up to here */
+  uint32_t               Size;             /* uncompressed bytes, including Fill */
+  uint32_t               Stored;           /* flash bytes used by the chunks */
+  uint32_t               Fill;
+  uint32_t               Cached;           /* chunk in Cache */
+  uint32_t               CachedRaw;
+  uint8_t                Sealed;           /* a short chunk was stored, no more appends */
+  uint32_t               InAddr;
+  uint32_t               InLeft;
+  uint32_t               InPos;
+  uint32_t               InLen;
+  uint16_t               Hash[FLASHMAN_LZ_HASH];
+  uint8_t                Raw[FLASHMAN_LZ_CHUNK];
+  uint8_t                Cache[FLASHMAN_LZ_CHUNK];
+  uint8_t                In[FLASHMAN_LZ_INPUT];
+
+} FLASHMAN_LzTypeDef;
+
+bool FLASHMAN_LzInit(FLASHMAN_LzTypeDef *Region, FLASHMAN_HandleTypeDef *Handle, uint32_t FirstSector, uint32_t SectorCnt);
+bool FLASHMAN_LzFormat(FLASHMAN_LzTypeDef *Region);
+bool FLASHMAN_LzAppend(FLASHMAN_LzTypeDef *Region, const uint8_t *Data, uint32_t Size);
+bool FLASHMAN_LzClose(FLASHMAN_LzTypeDef *Region);
+bool FLASHMAN_LzRead(FLASHMAN_LzTypeDef *Region, uint32_t Offset, uint8_t *Data, uint32_t Size);
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHMANAGER_LZ_H_
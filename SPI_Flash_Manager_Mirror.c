@@ -0,0 +1,294 @@
+#include "SPI_Flash_Manager_Mirror.h"
+
+static bool    FLASHMAN_MirrorErase(FLASHMAN_HandleTypeDef *Handle, uint8_t Kind, uint32_t Number);
+static uint8_t FLASHMAN_MirrorPick(FLASHMAN_MirrorTypeDef *Mirror);
+
+static bool FLASHMAN_MirrorErase(FLASHMAN_HandleTypeDef *Handle, uint8_t Kind, uint32_t Number)
+{
+  if (Kind == FLASHMAN_MIRROR_ERASE_BLOCK)
+  {
+    return FLASHMAN_EraseBlockAsync(Handle, Number);
+  }
+  return FLASHMAN_EraseSectorAsync(Handle, Number);
+}
+
+/* the member that can answer now, alternating while both are idle */
+static uint8_t FLASHMAN_MirrorPick(FLASHMAN_MirrorTypeDef *Mirror)
+{
+  uint8_t first = Mirror->Next;
+  Mirror->Next ^= 1;
+  FLASHMAN_MirrorProcess(Mirror);
+  if (FLASHMAN_IsBusy(Mirror->Member[first]) && (FLASHMAN_IsBusy(Mirror->Member[first ^ 1]) == false))
+  {
+    return first ^ 1;
+  }
+  return first;
+}
+
+/**
+  * @brief  Combine two chips into a mirrored (RAID-1) device.
+  * @note   Both handles must be initialized, the smaller chip sets the size.
+  *
+  * @param  *Mirror: Pointer to FLASHMAN_MirrorTypeDef structure
+  * @param  *Primary: Pointer to the first FLASHMAN_HandleTypeDef structure
+  * @param  *Secondary: Pointer to the second FLASHMAN_HandleTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_MirrorInit(FLASHMAN_MirrorTypeDef *Mirror, FLASHMAN_HandleTypeDef *Primary, FLASHMAN_HandleTypeDef *Secondary)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Mirror == NULL) || (Primary == NULL) || (Secondary == NULL) || (Primary == Secondary))
+    {
+      break;
+    }
+    if ((Primary->Inited == 0) || (Secondary->Inited == 0))
+    {
+      break;
+    }
+    memset(Mirror, 0, sizeof(FLASHMAN_MirrorTypeDef));
+    Mirror->Member[0] = Primary;
+    Mirror->Member[1] = Secondary;
+    Mirror->SectorCnt = (Primary->SectorCnt < Secondary->SectorCnt) ? Primary->SectorCnt : Secondary->SectorCnt;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Write both copies
+  * @note   Every page is sent to both members as an async program, so the two chips program in parallel.
+  * @note   A staggered erase still running is completed first. The range should be erased before write
+  *
+  * @param  *Mirror: Pointer to FLASHMAN_MirrorTypeDef structure
+  * @param  Address: Start address
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be written. (in byte)
+  * @param  *Crc: CRC32 of Data for FLASHMAN_MirrorReadVerified(), can be NULL
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_MirrorWrite(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Address, uint8_t *Data, uint32_t Size, uint32_t *Crc)
+{
+  bool retVal = false;
+  uint32_t length, crc = 0;
+  do
+  {
+    if ((Mirror == NULL) || (Address >= FLASHMAN_SectorToAddress(Mirror->SectorCnt)) ||
+        (Size > FLASHMAN_SectorToAddress(Mirror->SectorCnt) - Address))
+    {
+      break;
+    }
+    if (FLASHMAN_MirrorSync(Mirror) == false)
+    {
+      break;
+    }
+    while (Size > 0)
+    {
+      length = FLASHMAN_PAGE_SIZE - (Address % FLASHMAN_PAGE_SIZE);
+      if (length > Size)
+      {
+        length = Size;
+      }
+      if ((FLASHMAN_WriteAddressAsync(Mirror->Member[0], Address, Data, length) == false) ||
+          (FLASHMAN_WriteAddressAsync(Mirror->Member[1], Address, Data, length) == false))
+      {
+        break;
+      }
+      /* the CPU part runs while both chips program */
+      crc = FLASHMAN_Crc32(crc, Data, length);
+      Address += length;
+      Data += length;
+      Size -= length;
+    }
+    retVal = FLASHMAN_MirrorSync(Mirror) && (Size == 0);
+    if (Crc != NULL)
+    {
+      *Crc = crc;
+    }
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Read from whichever copy is not busy
+  * @note   While one member programs or erases the read goes to the other one, so reads do not
+  *         wait for a running erase. A failed transfer is retried on the other copy.
+  *
+  * @param  *Mirror: Pointer to FLASHMAN_MirrorTypeDef structure
+  * @param  Address: Start address
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be read. (in byte)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_MirrorRead(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Address, uint8_t *Data, uint32_t Size)
+{
+  bool retVal = false;
+  uint8_t member;
+  if (Mirror != NULL)
+  {
+    member = FLASHMAN_MirrorPick(Mirror);
+    retVal = FLASHMAN_ReadAddress(Mirror->Member[member], Address, Data, Size) ||
+             FLASHMAN_ReadAddress(Mirror->Member[member ^ 1], Address, Data, Size);
+  }
+  return retVal;
+}
+
+/**
+  * @brief  Read from whichever copy is not busy and check it against a CRC32
+  * @note   On a mismatch the data is read again from the other copy.
+  *
+  * @param  *Mirror: Pointer to FLASHMAN_MirrorTypeDef structure
+  * @param  Address: Start address
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be read. (in byte)
+  * @param  Crc: Expected CRC32, e.g. from FLASHMAN_MirrorWrite()
+  *
+  * @retval bool: true if one of the copies matched
+  */
+bool FLASHMAN_MirrorReadVerified(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Address, uint8_t *Data, uint32_t Size, uint32_t Crc)
+{
+  bool retVal = false;
+  uint8_t member;
+  do
+  {
+    if (Mirror == NULL)
+    {
+      break;
+    }
+    member = FLASHMAN_MirrorPick(Mirror);
+    if (FLASHMAN_ReadAddress(Mirror->Member[member], Address, Data, Size) && (FLASHMAN_Crc32(0, Data, Size) == Crc))
+    {
+      retVal = true;
+      break;
+    }
+    Mirror->Fallbacks++;
+    if (FLASHMAN_ReadAddress(Mirror->Member[member ^ 1], Address, Data, Size) && (FLASHMAN_Crc32(0, Data, Size) == Crc))
+    {
+      retVal = true;
+    }
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Erase a sector on both copies, one after the other
+  * @note   Returns once the first member is erasing, the second one is started by
+  *         FLASHMAN_MirrorProcess(), the next read or FLASHMAN_MirrorSync().
+  *
+  * @param  *Mirror: Pointer to FLASHMAN_MirrorTypeDef structure
+  * @param  Sector: Sector number
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_MirrorEraseSector(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Sector)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Mirror == NULL) || (Sector >= Mirror->SectorCnt) || (FLASHMAN_MirrorSync(Mirror) == false))
+    {
+      break;
+    }
+    if (FLASHMAN_MirrorErase(Mirror->Member[0], FLASHMAN_MIRROR_ERASE_SECTOR, Sector) == false)
+    {
+      break;
+    }
+    Mirror->PendingErase = FLASHMAN_MIRROR_ERASE_SECTOR;
+    Mirror->PendingNumber = Sector;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Erase a block on both copies, one after the other
+  * @note   Returns once the first member is erasing, see FLASHMAN_MirrorEraseSector()
+  *
+  * @param  *Mirror: Pointer to FLASHMAN_MirrorTypeDef structure
+  * @param  Block: Block number
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_MirrorEraseBlock(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Block)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Mirror == NULL) || (Block >= FLASHMAN_SectorToBlock(Mirror->SectorCnt)) || (FLASHMAN_MirrorSync(Mirror) == false))
+    {
+      break;
+    }
+    if (FLASHMAN_MirrorErase(Mirror->Member[0], FLASHMAN_MIRROR_ERASE_BLOCK, Block) == false)
+    {
+      break;
+    }
+    Mirror->PendingErase = FLASHMAN_MIRROR_ERASE_BLOCK;
+    Mirror->PendingNumber = Block;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Start the second half of a staggered erase once the first member finished
+  * @note   Call it from the idle loop to keep erases moving without reads
+  *
+  * @param  *Mirror: Pointer to FLASHMAN_MirrorTypeDef structure
+  */
+void FLASHMAN_MirrorProcess(FLASHMAN_MirrorTypeDef *Mirror)
+{
+  if ((Mirror != NULL) && (Mirror->PendingErase != FLASHMAN_MIRROR_ERASE_NONE) && (FLASHMAN_IsBusy(Mirror->Member[0]) == false))
+  {
+    /* on failure it stays pending and FLASHMAN_MirrorSync() reports it */
+    if (FLASHMAN_MirrorErase(Mirror->Member[1], Mirror->PendingErase, Mirror->PendingNumber))
+    {
+      Mirror->PendingErase = FLASHMAN_MIRROR_ERASE_NONE;
+    }
+  }
+}
+
+/**
+  * @brief  Finish pending programs and erases on both copies
+  *
+  * @param  *Mirror: Pointer to FLASHMAN_MirrorTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_MirrorSync(FLASHMAN_MirrorTypeDef *Mirror)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Mirror == NULL) || (FLASHMAN_Sync(Mirror->Member[0]) == false))
+    {
+      break;
+    }
+    if (Mirror->PendingErase != FLASHMAN_MIRROR_ERASE_NONE)
+    {
+      if (FLASHMAN_MirrorErase(Mirror->Member[1], Mirror->PendingErase, Mirror->PendingNumber) == false)
+      {
+        Mirror->PendingErase = FLASHMAN_MIRROR_ERASE_NONE;
+        break;
+      }
+      Mirror->PendingErase = FLASHMAN_MIRROR_ERASE_NONE;
+    }
+    retVal = FLASHMAN_Sync(Mirror->Member[1]);
+
+  } while (0);
+
+  return retVal;
+}
@@ -0,0 +1,43 @@
+#ifndef _FLASHMANAGER_MIRROR_H_
+#define _FLASHMANAGER_MIRROR_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+
+#include "SPI_Flash_Manager.h"
+
+#define FLASHMAN_MIRROR_ERASE_NONE              0
+#define FLASHMAN_MIRROR_ERASE_SECTOR            1
+#define FLASHMAN_MIRROR_ERASE_BLOCK             2
+
+/*
+ * Two chips holding the same data at the same addresses. Erases are staggered, the second member
+ * starts once the first one finished, so one copy is always readable.
+ */
+typedef struct
+{
+  FLASHMAN_HandleTypeDef *Member[2];
+  uint32_t               SectorCnt;
+  uint8_t                Next;
+  uint8_t                PendingErase;     /* erase still to start on Member[1] */
+  uint32_t               PendingNumber;
+  uint32_t               Fallbacks;        /* verified reads served by the other copy */
+
+} FLASHMAN_MirrorTypeDef;
+
+bool FLASHMAN_MirrorInit(FLASHMAN_MirrorTypeDef *Mirror, FLASHMAN_HandleTypeDef *Primary, FLASHMAN_HandleTypeDef *Secondary);
+bool FLASHMAN_MirrorWrite(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Address, uint8_t *Data, uint32_t Size, uint32_t *Crc);
+bool FLASHMAN_MirrorRead(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Address, uint8_t *Data, uint32_t Size);
+bool FLASHMAN_MirrorReadVerified(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Address, uint8_t *Data, uint32_t Size, uint32_t Crc);
+bool FLASHMAN_MirrorEraseSector(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Sector);
+bool FLASHMAN_MirrorEraseBlock(FLASHMAN_MirrorTypeDef *Mirror, uint32_t Block);
+void FLASHMAN_MirrorProcess(FLASHMAN_MirrorTypeDef *Mirror);
+bool FLASHMAN_MirrorSync(FLASHMAN_MirrorTypeDef *Mirror);
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHMANAGER_MIRROR_H_
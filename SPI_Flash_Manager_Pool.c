@@ -0,0 +1,174 @@
+#include "SPI_Flash_Manager_Pool.h"
+
+static bool FLASHMAN_PoolErase(FLASHMAN_PoolTypeDef *Pool);
+static void FLASHMAN_PoolErased(FLASHMAN_PoolTypeDef *Pool);
+
+/* start erasing the oldest released sector, the chip must be idle */
+static bool FLASHMAN_PoolErase(FLASHMAN_PoolTypeDef *Pool)
+{
+  uint32_t sector = Pool->Free[Pool->FreeHead];
+  if (FLASHMAN_EraseSectorAsync(Pool->Handle, sector) == false)
+  {
+    return false;
+  }
+  Pool->FreeHead = (Pool->FreeHead + 1) % FLASHMAN_POOL_SECTORS;
+  Pool->FreeCnt--;
+  Pool->Erasing = sector;
+  Pool->Erases++;
+  return true;
+}
+
+static void FLASHMAN_PoolErased(FLASHMAN_PoolTypeDef *Pool)
+{
+  Pool->Ready[(Pool->ReadyHead + Pool->ReadyCnt) % FLASHMAN_POOL_SECTORS] = Pool->Erasing;
+  Pool->ReadyCnt++;
+  Pool->Erasing = FLASHMAN_POOL_NONE;
+}
+
+/**
+  * @brief  Start an empty pool
+  * @note   Nothing is known to be erased after a reset, release the free sectors again.
+  *
+  * @param  *Pool: Pointer to FLASHMAN_PoolTypeDef structure
+  * @param  *Handle: Pointer to an initialized FLASHMAN_HandleTypeDef structure
+  * @param  Target: Erased sectors to keep ready, at most FLASHMAN_POOL_SECTORS
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_PoolInit(FLASHMAN_PoolTypeDef *Pool, FLASHMAN_HandleTypeDef *Handle, uint32_t Target)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Pool == NULL) || (Handle == NULL) || (Handle->Inited == 0) || (Target > FLASHMAN_POOL_SECTORS))
+    {
+      break;
+    }
+    memset(Pool, 0, sizeof(FLASHMAN_PoolTypeDef));
+    Pool->Handle = Handle;
+    Pool->Target = Target;
+    Pool->Erasing = FLASHMAN_POOL_NONE;
+    Pool->LowWater = FLASHMAN_POOL_SECTORS;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Hand a sector that is no longer used to the pool
+  * @note   The sector is erased later by FLASHMAN_PoolProcess(), a sector must not be released twice.
+  *
+  * @param  *Pool: Pointer to FLASHMAN_PoolTypeDef structure
+  * @param  Sector: Selected Sector
+  *
+  * @retval bool: true or false if the pool is full
+  */
+bool FLASHMAN_PoolRelease(FLASHMAN_PoolTypeDef *Pool, uint32_t Sector)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Pool == NULL) || (Pool->Handle == NULL) || (Sector >= Pool->Handle->SectorCnt) ||
+        (Pool->ReadyCnt + Pool->FreeCnt + ((Pool->Erasing != FLASHMAN_POOL_NONE) ? 1 : 0) >= FLASHMAN_POOL_SECTORS))
+    {
+      break;
+    }
+    Pool->Free[(Pool->FreeHead + Pool->FreeCnt) % FLASHMAN_POOL_SECTORS] = Sector;
+    Pool->FreeCnt++;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Erase ahead of demand, without waiting
+  * @note   Call it from the idle loop or a low priority task. A new erase is started only while the chip
+  *         is idle and fewer than Target sectors are ready.
+  *
+  * @param  *Pool: Pointer to FLASHMAN_PoolTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_PoolProcess(FLASHMAN_PoolTypeDef *Pool)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Pool == NULL) || (Pool->Handle == NULL))
+    {
+      break;
+    }
+    retVal = true;
+    if (FLASHMAN_IsBusy(Pool->Handle))
+    {
+      break;
+    }
+    if (Pool->Erasing != FLASHMAN_POOL_NONE)
+    {
+      FLASHMAN_PoolErased(Pool);
+    }
+    if ((Pool->ReadyCnt < Pool->Target) && (Pool->FreeCnt > 0))
+    {
+      retVal = FLASHMAN_PoolErase(Pool);
+    }
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Take an erased sector
+  * @note   Returns at once if one is ready. Otherwise waits for the running erase, or erases a released
+  *         sector, and counts the take as starved.
+  *
+  * @param  *Pool: Pointer to FLASHMAN_PoolTypeDef structure
+  * @param  *Sector: The erased sector (output)
+  *
+  * @retval bool: true or false if the pool has no free sector
+  */
+bool FLASHMAN_PoolTake(FLASHMAN_PoolTypeDef *Pool, uint32_t *Sector)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Pool == NULL) || (Pool->Handle == NULL) || (Sector == NULL))
+    {
+      break;
+    }
+    Pool->Takes++;
+    if (Pool->ReadyCnt < Pool->LowWater)
+    {
+      Pool->LowWater = Pool->ReadyCnt;
+    }
+    if (Pool->ReadyCnt == 0)
+    {
+      if ((Pool->Erasing == FLASHMAN_POOL_NONE) && (Pool->FreeCnt == 0))
+      {
+        Pool->Empty++;
+        break;
+      }
+      Pool->Starved++;
+      if ((Pool->Erasing == FLASHMAN_POOL_NONE) && (FLASHMAN_PoolErase(Pool) == false))
+      {
+        break;
+      }
+      if (FLASHMAN_Sync(Pool->Handle) == false)
+      {
+        break;
+      }
+      FLASHMAN_PoolErased(Pool);
+    }
+    *Sector = Pool->Ready[Pool->ReadyHead];
+    Pool->ReadyHead = (Pool->ReadyHead + 1) % FLASHMAN_POOL_SECTORS;
+    Pool->ReadyCnt--;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
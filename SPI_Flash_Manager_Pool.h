@@ -0,0 +1,54 @@
+#ifndef _FLASHMANAGER_POOL_H_
+#define _FLASHMANAGER_POOL_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+
+#include "SPI_Flash_Manager.h"
+
+/* free sectors a pool can hold, erased or not */
+#ifndef FLASHMAN_POOL_SECTORS
+#define FLASHMAN_POOL_SECTORS                   32
+#endif
+
+#define FLASHMAN_POOL_NONE                      0xFFFFFFFF
+
+/*
+ * Pre-erased sectors for writers that need a fresh one. Free sectors are handed to the pool with
+ * FLASHMAN_PoolRelease(), FLASHMAN_PoolProcess() from the idle loop erases them one at a time while
+ * fewer than Target are ready, and FLASHMAN_PoolTake() gives out an erased sector without touching
+ * the chip. A take that finds none ready waits for the erase instead and counts as starved.
+ * The pool is not locked, use it from one task.
+ */
+typedef struct
+{
+  FLASHMAN_HandleTypeDef *Handle;
+  uint32_t               Target;           /* erased sectors to keep ready, can be changed at any time */
+  uint32_t               Ready[FLASHMAN_POOL_SECTORS];
+  uint32_t               ReadyHead;
+  uint32_t               ReadyCnt;
+  uint32_t               Free[FLASHMAN_POOL_SECTORS];  /* released, not erased yet */
+  uint32_t               FreeHead;
+  uint32_t               FreeCnt;
+  uint32_t               Erasing;          /* sector with an erase running, FLASHMAN_POOL_NONE if none */
+  /* counters */
+  uint32_t               Takes;
+  uint32_t               Starved;          /* takes that waited for an erase */
+  uint32_t               Empty;            /* takes that found no free sector at all */
+  uint32_t               LowWater;         /* fewest sectors ready at a take */
+  uint32_t               Erases;
+
+} FLASHMAN_PoolTypeDef;
+
+bool FLASHMAN_PoolInit(FLASHMAN_PoolTypeDef *Pool, FLASHMAN_HandleTypeDef *Handle, uint32_t Target);
+bool FLASHMAN_PoolRelease(FLASHMAN_PoolTypeDef *Pool, uint32_t Sector);
+bool FLASHMAN_PoolProcess(FLASHMAN_PoolTypeDef *Pool);
+bool FLASHMAN_PoolTake(FLASHMAN_PoolTypeDef *Pool, uint32_t *Sector);
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHMANAGER_POOL_H_
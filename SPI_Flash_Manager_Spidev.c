@@ -0,0 +1,99 @@
+#include "SPI_Flash_Manager.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t FLASHMAN_SpidevNs(void);
+
+static uint64_t FLASHMAN_SpidevNs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+  * @brief  Open and set up a spidev device
+  *
+  * @param  *Spi: Pointer to FLASHMAN_SpidevTypeDef structure
+  * @param  *Path: Device, e.g. "/dev/spidev0.0"
+  * @param  SpeedHz: SCK
+  * @param  Mode: SPI_MODE_0 or SPI_MODE_3
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_SpidevOpen(FLASHMAN_SpidevTypeDef *Spi, const char *Path, uint32_t SpeedHz, uint8_t Mode)
+{
+  bool retVal = false;
+  uint8_t bits = 8;
+  do
+  {
+    if ((Spi == NULL) || (Path == NULL))
+    {
+      break;
+    }
+    memset(Spi, 0, sizeof(FLASHMAN_SpidevTypeDef));
+    Spi->Fd = open(Path, O_RDWR);
+    if (Spi->Fd < 0)
+    {
+      break;
+    }
+    if ((ioctl(Spi->Fd, SPI_IOC_WR_MODE, &Mode) < 0) || (ioctl(Spi->Fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+        (ioctl(Spi->Fd, SPI_IOC_WR_MAX_SPEED_HZ, &SpeedHz) < 0))
+    {
+      close(Spi->Fd);
+      Spi->Fd = -1;
+      break;
+    }
+    Spi->SpeedHz = SpeedHz;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+void FLASHMAN_SpidevClose(FLASHMAN_SpidevTypeDef *Spi)
+{
+  if ((Spi != NULL) && (Spi->Fd >= 0))
+  {
+    close(Spi->Fd);
+    Spi->Fd = -1;
+  }
+}
+
+/**
+  * @brief  Run transfers as one SPI_IOC_MESSAGE, the only system call of a driver operation
+  *
+  * @param  *Spi: Pointer to an opened FLASHMAN_SpidevTypeDef structure
+  * @param  *Xfer: Transfers, cs_change as in linux/spi/spidev.h
+  * @param  Cnt: Number of transfers
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_SpidevMessage(FLASHMAN_SpidevTypeDef *Spi, struct spi_ioc_transfer *Xfer, uint32_t Cnt)
+{
+  Spi->Messages++;
+  return ioctl(Spi->Fd, SPI_IOC_MESSAGE(Cnt), Xfer) >= 0;
+}
+
+uint32_t FLASHMAN_SpidevTimeUs(void)
+{
+  return (uint32_t)(FLASHMAN_SpidevNs() / 1000);
+}
+
+uint32_t HAL_GetTick(void)
+{
+  return (uint32_t)(FLASHMAN_SpidevNs() / 1000000);
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+  struct timespec ts = {Delay / 1000, (long)(Delay % 1000) * 1000000L};
+  while ((nanosleep(&ts, &ts) != 0) && (errno == EINTR))
+  {
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef _FLASHMANAGER_SPIDEV_H_
+#define _FLASHMANAGER_SPIDEV_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+/*
+ * Linux port of SPI_Flash_Manager on a spidev device (FLASHMAN_PLATFORM_LINUX_SPIDEV), included by
+ * SPI_Flash_Manager.h. The kernel drives CS, so FLASHMAN_Init() takes no GPIO:
+ *
+ *   FLASHMAN_SpidevTypeDef spi;
+ *   FLASHMAN_SpidevOpen(&spi, "/dev/spidev0.0", 20000000, SPI_MODE_0);
+ *   FLASHMAN_Init(&flash, &spi, NULL, 0);
+ *
+ * The driver gathers the frames of an operation and sends them as one SPI_IOC_MESSAGE, e.g. write
+ * enable + page program, or the header and data of a read. HAL_GetTick() and HAL_Delay() are
+ * provided on CLOCK_MONOTONIC. Host/SPI_Flash_Spidev.c implements the same functions on the
+ * emulator for host tests.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <linux/spi/spidev.h>
+
+/* transfers per SPI_IOC_MESSAGE */
+#ifndef FLASHMAN_SPIDEV_XFERS
+#define FLASHMAN_SPIDEV_XFERS                   8
+#endif
+/* bytes per SPI_IOC_MESSAGE, the bufsiz parameter of the spidev module. Longer reads take one message
+   per FLASHMAN_SPIDEV_BUFSIZ, CS stays asserted in between */
+#ifndef FLASHMAN_SPIDEV_BUFSIZ
+#define FLASHMAN_SPIDEV_BUFSIZ                  4096
+#endif
+
+/* each chunk of a streamed or verified read is a message of its own, so they are larger than on an MCU */
+#ifndef FLASHMAN_READ_CHUNK
+#define FLASHMAN_READ_CHUNK                     (FLASHMAN_SPIDEV_BUFSIZ / 2)
+#endif
+#ifndef FLASHMAN_VERIFY_CHUNK
+#define FLASHMAN_VERIFY_CHUNK                   256
+#endif
+
+#ifndef FLASHMAN_TIME_US
+#define FLASHMAN_TIME_US()                      FLASHMAN_SpidevTimeUs()
+#endif
+
+typedef struct
+{
+  int                    Fd;
+  uint32_t               SpeedHz;
+  uint64_t               Messages;         /* SPI_IOC_MESSAGE calls */
+
+} FLASHMAN_SpidevTypeDef;
+
+typedef FLASHMAN_SpidevTypeDef FLASHMAN_SpiTypeDef;
+typedef void                   FLASHMAN_GpioTypeDef;
+
+bool     FLASHMAN_SpidevOpen(FLASHMAN_SpidevTypeDef *Spi, const char *Path, uint32_t SpeedHz, uint8_t Mode);
+void     FLASHMAN_SpidevClose(FLASHMAN_SpidevTypeDef *Spi);
+bool     FLASHMAN_SpidevMessage(FLASHMAN_SpidevTypeDef *Spi, struct spi_ioc_transfer *Xfer, uint32_t Cnt);
+uint32_t FLASHMAN_SpidevTimeUs(void);
+uint32_t HAL_GetTick(void);
+void     HAL_Delay(uint32_t Delay);
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHMANAGER_SPIDEV_H_
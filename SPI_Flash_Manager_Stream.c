@@ -0,0 +1,216 @@
+#include "SPI_Flash_Manager_Stream.h"
+
+static bool FLASHMAN_StreamStep(FLASHMAN_StreamTypeDef *Stream, bool *Idle);
+
+/* one async operation: the oldest full page if its sector is erased, otherwise the next erase */
+static bool FLASHMAN_StreamStep(FLASHMAN_StreamTypeDef *Stream, bool *Idle)
+{
+  bool retVal = true;
+  *Idle = false;
+  if ((Stream->Count > 0) && (Stream->Pos < Stream->Erased))
+  {
+    retVal = FLASHMAN_WriteAddressAsync(Stream->Handle, Stream->Pos, Stream->Page[Stream->Tail], FLASHMAN_PAGE_SIZE);
+    Stream->Pos += FLASHMAN_PAGE_SIZE;
+    Stream->Tail = (Stream->Tail + 1) % FLASHMAN_STREAM_PAGES;
+    Stream->Count--;
+  }
+  /* keep at least a sector erased ahead of the data */
+  else if ((Stream->Erased < Stream->End) && ((Stream->Count > 0) || (Stream->Erased - Stream->Pos < FLASHMAN_SECTOR_SIZE)))
+  {
+#if FLASHMAN_STREAM_ERASE == FLASHMAN_STREAM_ERASE_BLOCK
+    if (((Stream->Erased % FLASHMAN_BLOCK_SIZE) == 0) && (Stream->End - Stream->Erased >= FLASHMAN_BLOCK_SIZE))
+    {
+      retVal = FLASHMAN_EraseBlockAsync(Stream->Handle, FLASHMAN_AddressToBlock(Stream->Erased));
+      Stream->Erased += FLASHMAN_BLOCK_SIZE;
+    }
+    else
+#endif
+    {
+      retVal = FLASHMAN_EraseSectorAsync(Stream->Handle, FLASHMAN_AddressToSector(Stream->Erased));
+      Stream->Erased += FLASHMAN_SECTOR_SIZE;
+    }
+  }
+  else
+  {
+    *Idle = true;
+  }
+  if (retVal == false)
+  {
+    Stream->Open = 0;
+  }
+  return retVal;
+}
+
+/**
+  * @brief  Start writing an image
+  * @note   The first sector is erased right away, async.
+  *
+  * @param  *Stream: Pointer to FLASHMAN_StreamTypeDef structure
+  * @param  *Handle: Pointer to an initialized FLASHMAN_HandleTypeDef structure
+  * @param  Address: Start address, sector aligned
+  * @param  MaxSize: Room for the image, erases never go beyond it (rounded up to sectors)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StreamOpen(FLASHMAN_StreamTypeDef *Stream, FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t MaxSize)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Stream == NULL) || (Handle == NULL) || (Handle->Inited == 0) || ((Address % FLASHMAN_SECTOR_SIZE) != 0) || (MaxSize == 0))
+    {
+      break;
+    }
+    MaxSize = FLASHMAN_SectorToAddress(FLASHMAN_AddressToSector(MaxSize + FLASHMAN_SECTOR_SIZE - 1));
+    if ((Address >= FLASHMAN_SectorToAddress(Handle->SectorCnt)) || (MaxSize > FLASHMAN_SectorToAddress(Handle->SectorCnt) - Address))
+    {
+      break;
+    }
+    memset(Stream, 0, sizeof(FLASHMAN_StreamTypeDef));
+    Stream->Handle = Handle;
+    Stream->Start = Address;
+    Stream->End = Address + MaxSize;
+    Stream->Pos = Address;
+    Stream->Erased = Address;
+    Stream->Open = 1;
+    retVal = FLASHMAN_StreamProcess(Stream);
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Add the next piece of the image, any size
+  * @note   Returns without waiting for the chip unless the page ring is full.
+  *
+  * @param  *Stream: Pointer to FLASHMAN_StreamTypeDef structure
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data. (in byte)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StreamAppend(FLASHMAN_StreamTypeDef *Stream, const uint8_t *Data, uint32_t Size)
+{
+  bool retVal = false, idle, stalled = false;
+  uint32_t n;
+  do
+  {
+    if ((Stream == NULL) || (Stream->Open == 0) || (Size > Stream->End - Stream->Start - Stream->Written))
+    {
+      break;
+    }
+    while (Size > 0)
+    {
+      if (Stream->Count == FLASHMAN_STREAM_PAGES)
+      {
+        /* the step waits for the running operation */
+        stalled = true;
+        if (FLASHMAN_StreamStep(Stream, &idle) == false)
+        {
+          break;
+        }
+        continue;
+      }
+      n = FLASHMAN_PAGE_SIZE - Stream->Fill;
+      if (n > Size)
+      {
+        n = Size;
+      }
+      memcpy(&Stream->Page[(Stream->Tail + Stream->Count) % FLASHMAN_STREAM_PAGES][Stream->Fill], Data, n);
+      Stream->Fill += n;
+      Stream->Written += n;
+      Data += n;
+      Size -= n;
+      if (Stream->Fill == FLASHMAN_PAGE_SIZE)
+      {
+        Stream->Count++;
+        Stream->Fill = 0;
+      }
+    }
+    if (stalled)
+    {
+      Stream->Stalls++;
+    }
+    retVal = (Size == 0) && FLASHMAN_StreamProcess(Stream);
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Start whatever the chip can do now, without waiting
+  * @note   Called by FLASHMAN_StreamAppend(), call it from the idle loop too so erases go on between pieces
+  *
+  * @param  *Stream: Pointer to FLASHMAN_StreamTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StreamProcess(FLASHMAN_StreamTypeDef *Stream)
+{
+  bool retVal = false, idle = false;
+  do
+  {
+    if ((Stream == NULL) || (Stream->Open == 0))
+    {
+      break;
+    }
+    retVal = true;
+    while (retVal && (idle == false) && (FLASHMAN_IsBusy(Stream->Handle) == false))
+    {
+      retVal = FLASHMAN_StreamStep(Stream, &idle);
+    }
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Program the rest of the image and wait for the chip
+  * @note   The last page is padded with 0xFF, so the rest of it stays erased.
+  *
+  * @param  *Stream: Pointer to FLASHMAN_StreamTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StreamFinish(FLASHMAN_StreamTypeDef *Stream)
+{
+  bool retVal = false, idle = false;
+  do
+  {
+    if ((Stream == NULL) || (Stream->Open == 0))
+    {
+      break;
+    }
+    if (Stream->Fill > 0)
+    {
+      /* the partial page goes out as the last one of the ring */
+      while ((Stream->Count == FLASHMAN_STREAM_PAGES) && (Stream->Open != 0))
+      {
+        FLASHMAN_StreamStep(Stream, &idle);
+      }
+      if (Stream->Open == 0)
+      {
+        break;
+      }
+      memset(&Stream->Page[(Stream->Tail + Stream->Count) % FLASHMAN_STREAM_PAGES][Stream->Fill], 0xFF, FLASHMAN_PAGE_SIZE - Stream->Fill);
+      Stream->Count++;
+      Stream->Fill = 0;
+    }
+    while ((Stream->Count > 0) && (Stream->Open != 0))
+    {
+      FLASHMAN_StreamStep(Stream, &idle);
+    }
+    if (Stream->Open == 0)
+    {
+      break;
+    }
+    Stream->Open = 0;
+    retVal = FLASHMAN_Sync(Stream->Handle);
+
+  } while (0);
+
+  return retVal;
+}
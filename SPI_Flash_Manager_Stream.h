@@ -0,0 +1,54 @@
+#ifndef _FLASHMANAGER_STREAM_H_
+#define _FLASHMANAGER_STREAM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+
+#include "SPI_Flash_Manager.h"
+
+#define FLASHMAN_STREAM_ERASE_SECTOR            0
+#define FLASHMAN_STREAM_ERASE_BLOCK             1
+
+/* page ring, it has to hold the data arriving during one erase */
+#ifndef FLASHMAN_STREAM_PAGES
+#define FLASHMAN_STREAM_PAGES                   16
+#endif
+/* block erases are faster per byte but need a ring about 3 times larger, edit here or override from the compiler command line */
+#ifndef FLASHMAN_STREAM_ERASE
+#define FLASHMAN_STREAM_ERASE                   FLASHMAN_STREAM_ERASE_SECTOR
+#endif
+
+/*
+ * Sequential writer for images arriving in pieces. Full pages wait in a ring and are programmed
+ * async, the next sector/block is erased ahead while data keeps arriving, so FLASHMAN_StreamAppend()
+ * only blocks when the ring is full.
+ */
+typedef struct
+{
+  FLASHMAN_HandleTypeDef *Handle;
+  uint32_t               Start;
+  uint32_t               End;
+  uint32_t               Pos;              /* flash address of the oldest page in the ring */
+  uint32_t               Erased;           /* erased up to here */
+  uint32_t               Written;          /* bytes appended */
+  uint32_t               Tail;
+  uint32_t               Count;            /* full pages in the ring */
+  uint32_t               Fill;             /* bytes in the page after them */
+  uint32_t               Stalls;           /* appends that waited for the chip */
+  uint8_t                Open;
+  uint8_t                Page[FLASHMAN_STREAM_PAGES][FLASHMAN_PAGE_SIZE];
+
+} FLASHMAN_StreamTypeDef;
+
+bool FLASHMAN_StreamOpen(FLASHMAN_StreamTypeDef *Stream, FLASHMAN_HandleTypeDef *Handle, uint32_t Address, uint32_t MaxSize);
+bool FLASHMAN_StreamAppend(FLASHMAN_StreamTypeDef *Stream, const uint8_t *Data, uint32_t Size);
+bool FLASHMAN_StreamProcess(FLASHMAN_StreamTypeDef *Stream);
+bool FLASHMAN_StreamFinish(FLASHMAN_StreamTypeDef *Stream);
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHMANAGER_STREAM_H_
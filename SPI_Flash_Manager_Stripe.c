@@ -0,0 +1,257 @@
+#include "SPI_Flash_Manager_Stripe.h"
+
+static FLASHMAN_HandleTypeDef *FLASHMAN_StripeMap(FLASHMAN_StripeTypeDef *Stripe, uint32_t Address, uint32_t *MemberAddress);
+static bool FLASHMAN_StripeRange(FLASHMAN_StripeTypeDef *Stripe, uint32_t Address, uint32_t Size);
+
+static FLASHMAN_HandleTypeDef *FLASHMAN_StripeMap(FLASHMAN_StripeTypeDef *Stripe, uint32_t Address, uint32_t *MemberAddress)
+{
+  uint32_t stripe = Address >> Stripe->Shift;
+  *MemberAddress = ((stripe / Stripe->MemberCnt) << Stripe->Shift) | (Address & (Stripe->StripeSize - 1));
+  return Stripe->Member[stripe % Stripe->MemberCnt];
+}
+
+static bool FLASHMAN_StripeRange(FLASHMAN_StripeTypeDef *Stripe, uint32_t Address, uint32_t Size)
+{
+  return (Stripe != NULL) && (Stripe->MemberCnt != 0) && (Address < Stripe->Size) && (Size <= Stripe->Size - Address);
+}
+
+/**
+  * @brief  Combine several chips into one striped (RAID-0) address space.
+  * @note   Members may share a SPI bus or sit on separate ones, they must be initialized.
+  * @note   The stripe size is a power of two from FLASHMAN_PAGE_SIZE to FLASHMAN_SECTOR_SIZE,
+  *         a page keeps every member programming during sequential writes.
+  *
+  * @param  *Stripe: Pointer to FLASHMAN_StripeTypeDef structure
+  * @param  **Members: Array of MemberCnt pointers to initialized FLASHMAN_HandleTypeDef structures
+  * @param  MemberCnt: Number of members, 2 to FLASHMAN_STRIPE_MEMBERS
+  * @param  StripeSize: Stripe size in bytes
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StripeInit(FLASHMAN_StripeTypeDef *Stripe, FLASHMAN_HandleTypeDef **Members, uint8_t MemberCnt, uint32_t StripeSize)
+{
+  bool retVal = false;
+  do
+  {
+    if ((Stripe == NULL) || (Members == NULL) || (MemberCnt < 2) || (MemberCnt > FLASHMAN_STRIPE_MEMBERS))
+    {
+      break;
+    }
+    if ((StripeSize < FLASHMAN_PAGE_SIZE) || (StripeSize > FLASHMAN_SECTOR_SIZE) || ((StripeSize & (StripeSize - 1)) != 0))
+    {
+      break;
+    }
+    memset(Stripe, 0, sizeof(FLASHMAN_StripeTypeDef));
+    Stripe->SectorCnt = 0xFFFFFFFF;
+    for (uint8_t i = 0; i < MemberCnt; i++)
+    {
+      if ((Members[i] == NULL) || (Members[i]->Inited == 0))
+      {
+        Stripe->SectorCnt = 0;
+        break;
+      }
+      Stripe->Member[i] = Members[i];
+      if (Members[i]->SectorCnt < Stripe->SectorCnt)
+      {
+        Stripe->SectorCnt = Members[i]->SectorCnt;
+      }
+    }
+    if (Stripe->SectorCnt == 0)
+    {
+      break;
+    }
+    while ((1UL << Stripe->Shift) < StripeSize)
+    {
+      Stripe->Shift++;
+    }
+    Stripe->StripeSize = StripeSize;
+    Stripe->BlockCnt = FLASHMAN_SectorToBlock(Stripe->SectorCnt);
+    Stripe->Size = FLASHMAN_SectorToAddress(Stripe->SectorCnt) * MemberCnt;
+    Stripe->MemberCnt = MemberCnt;
+    retVal = true;
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Read from the striped address space
+  *
+  * @param  *Stripe: Pointer to FLASHMAN_StripeTypeDef structure
+  * @param  Address: Start address
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be read. (in byte)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StripeRead(FLASHMAN_StripeTypeDef *Stripe, uint32_t Address, uint8_t *Data, uint32_t Size)
+{
+  FLASHMAN_HandleTypeDef *member;
+  uint32_t memberAddress, length;
+  bool retVal = false;
+  do
+  {
+    if (FLASHMAN_StripeRange(Stripe, Address, Size) == false)
+    {
+      break;
+    }
+    while (Size > 0)
+    {
+      length = Stripe->StripeSize - (Address & (Stripe->StripeSize - 1));
+      if (length > Size)
+      {
+        length = Size;
+      }
+      member = FLASHMAN_StripeMap(Stripe, Address, &memberAddress);
+      if (FLASHMAN_ReadAddress(member, memberAddress, Data, length) == false)
+      {
+        break;
+      }
+      Address += length;
+      Data += length;
+      Size -= length;
+    }
+    retVal = (Size == 0);
+
+  } while (0);
+
+  return retVal;
+}
+
+/**
+  * @brief  Write to the striped address space
+  * @note   Pages go out round robin over the members as async programs, so while one member
+  *         programs the next page is sent to another. Returns after every member finished.
+  * @note   The range should be erased before write
+  *
+  * @param  *Stripe: Pointer to FLASHMAN_StripeTypeDef structure
+  * @param  Address: Start address
+  * @param  *Data: Pointer to Data
+  * @param  Size: The length of data should be written. (in byte)
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StripeWrite(FLASHMAN_StripeTypeDef *Stripe, uint32_t Address, uint8_t *Data, uint32_t Size)
+{
+  FLASHMAN_HandleTypeDef *member;
+  uint32_t cursor[FLASHMAN_STRIPE_MEMBERS], end, first, stripe, memberAddress, length;
+  bool retVal = true, pending = true;
+  if (FLASHMAN_StripeRange(Stripe, Address, Size) == false)
+  {
+    return false;
+  }
+  end = Address + Size;
+  /* next byte of the range that lives on each member */
+  first = Address >> Stripe->Shift;
+  for (uint8_t i = 0; i < Stripe->MemberCnt; i++)
+  {
+    stripe = first + ((i + Stripe->MemberCnt - (first % Stripe->MemberCnt)) % Stripe->MemberCnt);
+    cursor[i] = (stripe == first) ? Address : (stripe << Stripe->Shift);
+  }
+  while (pending && retVal)
+  {
+    pending = false;
+    for (uint8_t i = 0; (i < Stripe->MemberCnt) && retVal; i++)
+    {
+      if (cursor[i] >= end)
+      {
+        continue;
+      }
+      length = FLASHMAN_PAGE_SIZE - (cursor[i] % FLASHMAN_PAGE_SIZE);
+      if (length > end - cursor[i])
+      {
+        length = end - cursor[i];
+      }
+      member = FLASHMAN_StripeMap(Stripe, cursor[i], &memberAddress);
+      retVal = FLASHMAN_WriteAddressAsync(member, memberAddress, &Data[cursor[i] - Address], length);
+      cursor[i] += length;
+      if ((cursor[i] & (Stripe->StripeSize - 1)) == 0)
+      {
+        cursor[i] += (uint32_t)(Stripe->MemberCnt - 1) << Stripe->Shift;
+      }
+      pending = true;
+    }
+  }
+  if (FLASHMAN_StripeSync(Stripe) == false)
+  {
+    retVal = false;
+  }
+  return retVal;
+}
+
+/**
+  * @brief  Erase a stripe sector, the same sector on all members in parallel
+  *
+  * @param  *Stripe: Pointer to FLASHMAN_StripeTypeDef structure
+  * @param  Sector: Stripe sector number, FLASHMAN_SECTOR_SIZE * MemberCnt bytes each
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StripeEraseSector(FLASHMAN_StripeTypeDef *Stripe, uint32_t Sector)
+{
+  bool retVal = true;
+  if ((Stripe == NULL) || (Sector >= Stripe->SectorCnt))
+  {
+    return false;
+  }
+  for (uint8_t i = 0; (i < Stripe->MemberCnt) && retVal; i++)
+  {
+    retVal = FLASHMAN_EraseSectorAsync(Stripe->Member[i], Sector);
+  }
+  if (FLASHMAN_StripeSync(Stripe) == false)
+  {
+    retVal = false;
+  }
+  return retVal;
+}
+
+/**
+  * @brief  Erase a stripe block, the same block on all members in parallel
+  *
+  * @param  *Stripe: Pointer to FLASHMAN_StripeTypeDef structure
+  * @param  Block: Stripe block number, FLASHMAN_BLOCK_SIZE * MemberCnt bytes each
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StripeEraseBlock(FLASHMAN_StripeTypeDef *Stripe, uint32_t Block)
+{
+  bool retVal = true;
+  if ((Stripe == NULL) || (Block >= Stripe->BlockCnt))
+  {
+    return false;
+  }
+  for (uint8_t i = 0; (i < Stripe->MemberCnt) && retVal; i++)
+  {
+    retVal = FLASHMAN_EraseBlockAsync(Stripe->Member[i], Block);
+  }
+  if (FLASHMAN_StripeSync(Stripe) == false)
+  {
+    retVal = false;
+  }
+  return retVal;
+}
+
+/**
+  * @brief  Wait for pending programs and erases on all members
+  *
+  * @param  *Stripe: Pointer to FLASHMAN_StripeTypeDef structure
+  *
+  * @retval bool: true or false
+  */
+bool FLASHMAN_StripeSync(FLASHMAN_StripeTypeDef *Stripe)
+{
+  bool retVal = true;
+  if (Stripe == NULL)
+  {
+    return false;
+  }
+  for (uint8_t i = 0; i < Stripe->MemberCnt; i++)
+  {
+    if (FLASHMAN_Sync(Stripe->Member[i]) == false)
+    {
+      retVal = false;
+    }
+  }
+  return retVal;
+}
@@ -0,0 +1,40 @@
+#ifndef _FLASHMANAGER_STRIPE_H_
+#define _FLASHMANAGER_STRIPE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  //  __cplusplus
+
+
+#include "SPI_Flash_Manager.h"
+
+#define FLASHMAN_STRIPE_MEMBERS                 4
+
+/*
+ * Stripe k of the virtual address space lives on member (k % MemberCnt) at member stripe (k / MemberCnt).
+ * A stripe sector/block is the same sector/block number on every member, so it is MemberCnt times larger.
+ */
+typedef struct
+{
+  FLASHMAN_HandleTypeDef *Member[FLASHMAN_STRIPE_MEMBERS];
+  uint8_t                MemberCnt;
+  uint8_t                Shift;
+  uint32_t               StripeSize;
+  uint32_t               SectorCnt;
+  uint32_t               BlockCnt;
+  uint32_t               Size;
+
+} FLASHMAN_StripeTypeDef;
+
+bool FLASHMAN_StripeInit(FLASHMAN_StripeTypeDef *Stripe, FLASHMAN_HandleTypeDef **Members, uint8_t MemberCnt, uint32_t StripeSize);
+bool FLASHMAN_StripeRead(FLASHMAN_StripeTypeDef *Stripe, uint32_t Address, uint8_t *Data, uint32_t Size);
+bool FLASHMAN_StripeWrite(FLASHMAN_StripeTypeDef *Stripe, uint32_t Address, uint8_t *Data, uint32_t Size);
+bool FLASHMAN_StripeEraseSector(FLASHMAN_StripeTypeDef *Stripe, uint32_t Sector);
+bool FLASHMAN_StripeEraseBlock(FLASHMAN_StripeTypeDef *Stripe, uint32_t Block);
+bool FLASHMAN_StripeSync(FLASHMAN_StripeTypeDef *Stripe);
+
+#ifdef __cplusplus
+}
+#endif  //  __cplusplus
+#endif  //  _FLASHMANAGER_STRIPE_H_